@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "AllocationCheck.h"
+
+#include <ostream>
+
+bool CheckSteadyStateAllocations(const HeadlessRunOptions& options, uint64_t warmupTicks, uint64_t checkedTicks,
+    AllocationCheckResult* result)
+{
+    ScenarioDescription scenario;
+    if (!options.scenario.empty() && ScenarioGenerator::GetPreset(options.scenario, &scenario))
+    {
+        for (const auto& team : scenario.teams)
+        {
+            if (team.churnPerUpdate > 0)
+                return false;
+        }
+    }
+
+    // Metric samples allocate as they are stored, and are not part of the world's update.
+    auto runOptions = options;
+    runOptions.metricsSampleInterval = 0;
+
+    HeadlessRunner runner(runOptions);
+    for (uint64_t tick = 0; tick < warmupTicks; ++tick)
+    {
+        runner.Step();
+    }
+
+    *result = AllocationCheckResult();
+    result->warmupTicks = warmupTicks;
+    result->checkedTicks = checkedTicks;
+
+    auto phasesBefore = AllocationTracker::GetPhaseAllocations();
+    for (uint64_t tick = 0; tick < checkedTicks; ++tick)
+    {
+        auto allocations = AllocationTracker::GetAllocationCount();
+        runner.Step();
+        allocations = AllocationTracker::GetAllocationCount() - allocations;
+
+        if (allocations > 0)
+        {
+            if (result->allocatingTicks++ == 0)
+            {
+                result->firstAllocatingTick = runner.GetTicks();
+            }
+            result->allocations += allocations;
+        }
+    }
+
+    // Phases keep their order as new ones are added, so the earlier list lines up with the start of this one.
+    result->phases = AllocationTracker::GetPhaseAllocations();
+    for (size_t i = 0; i < phasesBefore.size() && i < result->phases.size(); ++i)
+    {
+        result->phases[i].allocations -= phasesBefore[i].allocations;
+    }
+
+    return true;
+}
+
+void WriteAllocationCheckResult(std::wostream& output, const AllocationCheckResult& result)
+{
+    output << L"warmup ticks: " << result.warmupTicks << L"\n"
+        << L"checked ticks: " << result.checkedTicks << L"\n"
+        << L"allocations: " << result.allocations << L"\n"
+        << L"allocating ticks: " << result.allocatingTicks << L"\n";
+
+    if (!result.Passed())
+    {
+        output << L"first allocating tick: " << result.firstAllocatingTick << L"\n";
+        for (const auto& phase : result.phases)
+        {
+            if (phase.allocations > 0)
+            {
+                output << L"  " << phase.phase << L": " << phase.allocations << L"\n";
+            }
+        }
+    }
+
+    output << (result.Passed() ? L"passed" : L"FAILED") << std::endl;
+}
@@ -0,0 +1,35 @@
+//
+// AllocationCheck.h - checks that World::Update stops allocating once a fixed population settles
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "HeadlessRunner.h"
+
+struct AllocationCheckResult
+{
+    uint64_t    warmupTicks;
+    uint64_t    checkedTicks;
+    uint64_t    allocations;            // made on any thread during the checked ticks
+    uint64_t    allocatingTicks;        // checked ticks that allocated at all
+    uint64_t    firstAllocatingTick;    // 0 if none
+    std::vector<AllocationTracker::PhaseAllocations> phases; // allocations during the checked ticks, by phase
+
+    bool Passed() const { return allocations == 0; }
+};
+
+// Runs the headless scenario (no agents are added or removed) for warmupTicks, while the world's containers
+// grow to their working size, then for checkedTicks more, counting every heap allocation made during those
+// updates. The check passes only if there were none: in steady state an update reuses what it has, so it
+// never takes the allocator's locks, which worlds sharing a process would otherwise contend on. Returns false,
+// without running anything, for a scenario preset with churn, which spawns agents (and so allocates) every
+// update.
+bool CheckSteadyStateAllocations(const HeadlessRunOptions& options, uint64_t warmupTicks, uint64_t checkedTicks,
+    AllocationCheckResult* result);
+
+// Write a check's result as "name: value" lines, with the phases that allocated.
+void WriteAllocationCheckResult(std::wostream& output, const AllocationCheckResult& result);
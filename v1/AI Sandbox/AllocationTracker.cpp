@@ -0,0 +1,257 @@
+#include "pch.h"
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+// Per-thread counters in a fixed table, since registering a thread must not allocate. Threads beyond the
+// table share its last slot.
+const size_t MaxThreads = 256;
+
+struct alignas(64) ThreadCounters
+{
+    std::atomic<uint64_t>   allocations;
+    std::atomic<uint64_t>   frees;
+    std::atomic<uint64_t>   attributed; // made by other threads on this one's behalf
+};
+
+ThreadCounters          Counters[MaxThreads];
+std::atomic<size_t>     NextThreadSlot(0);
+thread_local size_t     ThreadSlot = MaxThreads;
+thread_local size_t     AttributedSlot = MaxThreads; // the thread allocations are also counted for, if any
+
+// Phases, by first use. A name is published after its slot is claimed, so readers skip slots still being
+// filled in.
+const size_t NoPhase = ~size_t(0);
+const size_t MaxPhases = 64;
+
+std::atomic<const char*>    PhaseNames[MaxPhases];
+std::atomic<uint64_t>       PhaseAllocationCounts[MaxPhases];
+std::atomic<size_t>         PhaseCount(0);
+thread_local size_t         ThreadPhase = NoPhase;
+
+size_t FindPhase(const char* name)
+{
+    auto count = std::min(PhaseCount.load(std::memory_order_acquire), MaxPhases);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto phaseName = PhaseNames[i].load(std::memory_order_acquire);
+        if (phaseName && (phaseName == name || strcmp(phaseName, name) == 0))
+            return i;
+    }
+    return NoPhase;
+}
+
+size_t GetPhase(const char* name)
+{
+    auto phase = FindPhase(name);
+    if (phase != NoPhase)
+        return phase;
+
+    // Two threads entering a new phase at once may both add it; the later slot then goes unused.
+    phase = PhaseCount.fetch_add(1, std::memory_order_acq_rel);
+    if (phase >= MaxPhases)
+        return NoPhase;
+
+    PhaseNames[phase].store(name, std::memory_order_release);
+    return phase;
+}
+
+ThreadCounters& GetThreadCounters()
+{
+    if (ThreadSlot == MaxThreads)
+    {
+        ThreadSlot = std::min(NextThreadSlot.fetch_add(1, std::memory_order_relaxed), MaxThreads - 1);
+    }
+    return Counters[ThreadSlot];
+}
+
+// Only the owning thread writes its slot (but for the shared last one), so a relaxed load and store will do
+// where a locked add is not needed.
+void Increment(std::atomic<uint64_t>& counter)
+{
+    if (ThreadSlot == MaxThreads - 1)
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void* Allocate(size_t size)
+{
+    Increment(GetThreadCounters().allocations);
+    if (AttributedSlot != MaxThreads)
+    {
+        Counters[AttributedSlot].attributed.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (ThreadPhase != NoPhase)
+    {
+        PhaseAllocationCounts[ThreadPhase].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (;;)
+    {
+        auto memory = malloc(size ? size : 1);
+        if (memory)
+            return memory;
+
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void Free(void* memory)
+{
+    if (memory)
+    {
+        Increment(GetThreadCounters().frees);
+        free(memory);
+    }
+}
+}
+
+uint64_t AllocationTracker::GetAllocationCount()
+{
+    uint64_t count = 0;
+    for (const auto& counters : Counters)
+    {
+        count += counters.allocations.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+uint64_t AllocationTracker::GetThreadAllocationCount()
+{
+    const auto& counters = GetThreadCounters();
+    return counters.allocations.load(std::memory_order_relaxed) + counters.attributed.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationTracker::GetFreeCount()
+{
+    uint64_t count = 0;
+    for (const auto& counters : Counters)
+    {
+        count += counters.frees.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+AllocationTracker::Scope::Scope(const char* phase) :
+    m_previous(ThreadPhase)
+{
+    ThreadPhase = GetPhase(phase);
+}
+
+AllocationTracker::Scope::~Scope()
+{
+    ThreadPhase = m_previous;
+}
+
+AllocationTracker::Attribution AllocationTracker::GetAttribution()
+{
+    GetThreadCounters();
+    return { ThreadPhase, AttributedSlot != MaxThreads ? AttributedSlot : ThreadSlot };
+}
+
+AllocationTracker::AttributionScope::AttributionScope(const Attribution& attribution) :
+    m_previous({ ThreadPhase, AttributedSlot })
+{
+    GetThreadCounters();
+    ThreadPhase = attribution.phase;
+    AttributedSlot = attribution.thread != ThreadSlot ? attribution.thread : MaxThreads;
+}
+
+AllocationTracker::AttributionScope::~AttributionScope()
+{
+    ThreadPhase = m_previous.phase;
+    AttributedSlot = m_previous.thread;
+}
+
+std::vector<AllocationTracker::PhaseAllocations> AllocationTracker::GetPhaseAllocations()
+{
+    std::vector<PhaseAllocations> phases;
+    auto count = std::min(PhaseCount.load(std::memory_order_acquire), MaxPhases);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto name = PhaseNames[i].load(std::memory_order_acquire);
+        if (name)
+        {
+            phases.push_back({ name, PhaseAllocationCounts[i].load(std::memory_order_relaxed) });
+        }
+    }
+    return phases;
+}
+
+// Replacements for the global allocation functions
+void* operator new(size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return Allocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return Allocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept
+{
+    Free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    Free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    Free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    Free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    Free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    Free(memory);
+}
@@ -0,0 +1,69 @@
+//
+// AllocationTracker.h - counts heap allocations made through the global operator new
+//
+
+#pragma once
+
+// AllocationTracker.cpp replaces the global operator new and delete. Every thread counts into its own
+// slot, so counting adds no contention between threads.
+namespace AllocationTracker
+{
+// Allocations (and frees) made so far by every thread.
+uint64_t GetAllocationCount();
+uint64_t GetFreeCount();
+
+// Allocations made so far by the calling thread, and by other threads on its behalf (see AttributionScope).
+uint64_t GetThreadAllocationCount();
+
+// Attributes the calling thread's allocations to a named phase while in scope. Scopes nest; an allocation
+// counts toward the innermost phase only. Phases are looked up by name (which must outlive the process,
+// like a string literal) in a fixed table, so a scope never allocates itself.
+class Scope
+{
+public:
+    explicit Scope(const char* phase);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    size_t  m_previous;
+};
+
+// Where the calling thread's allocations are attributed: its phase, and the thread they are also counted for.
+struct Attribution
+{
+    size_t  phase;
+    size_t  thread;
+};
+
+Attribution GetAttribution();
+
+// Attributes the calling thread's allocations as another thread's (from its GetAttribution) while in scope:
+// they count toward that thread's phase and its GetThreadAllocationCount, as well as toward the calling
+// thread's own count. Thread pool workers use this while running a job, so work split across threads is
+// counted as the submitting thread's.
+class AttributionScope
+{
+public:
+    explicit AttributionScope(const Attribution& attribution);
+    ~AttributionScope();
+
+    AttributionScope(const AttributionScope&) = delete;
+    AttributionScope& operator=(const AttributionScope&) = delete;
+
+private:
+    Attribution m_previous;
+};
+
+struct PhaseAllocations
+{
+    const char* phase;
+    uint64_t    allocations;
+};
+
+// Allocations made so far in every phase seen, in the order the phases were first entered. Allocations made
+// outside any scope (or in phases beyond the table) are not included.
+std::vector<PhaseAllocations> GetPhaseAllocations();
+}
@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "Benchmark.h"
+
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+void Benchmark::WriteTable(std::wostream& output, const Result* results, size_t count)
+{
+    output << std::left << std::setw(48) << L"Benchmark" << std::right
+        << std::setw(14) << L"ns/item" << std::setw(18) << L"items/s" << std::setw(14) << L"iterations"
+        << std::setw(14) << L"allocs/iter" << L"\n";
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& result = results[i];
+        output << std::left << std::setw(48) << std::wstring(result.name.begin(), result.name.end()) << std::right
+            << std::fixed << std::setprecision(3) << std::setw(14) << result.NanosecondsPerItem()
+            << std::setprecision(0) << std::setw(18) << result.ItemsPerSecond()
+            << std::setw(14) << result.iterations
+            << std::setprecision(1) << std::setw(14) << result.AllocationsPerIteration() << L"\n";
+    }
+}
+
+void Benchmark::WriteJson(std::ostream& output, const char* suite, const Result* results, size_t count)
+{
+    output << "{\n  \"context\": {\n";
+    output << "    \"suite\": \"" << suite << "\",\n";
+    output << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#if defined(FIXED_POINT_SIMULATION)
+    output << "    \"fixed_point_simulation\": true\n";
+#else
+    output << "    \"fixed_point_simulation\": false\n";
+#endif
+    output << "  },\n  \"benchmarks\": [";
+
+    output << std::setprecision(9);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& result = results[i];
+        auto time = result.NanosecondsPerIteration();
+        output << (i == 0 ? "\n" : ",\n");
+        output << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+            << ", \"real_time\": " << time << ", \"cpu_time\": " << time << ", \"time_unit\": \"ns\""
+            << ", \"items_per_second\": " << result.ItemsPerSecond()
+            << ", \"allocations_per_iteration\": " << result.AllocationsPerIteration() << "}";
+    }
+    output << "\n  ]\n}\n";
+}
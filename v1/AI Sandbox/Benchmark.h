@@ -0,0 +1,64 @@
+//
+// Benchmark.h - a minimal timing harness for microbenchmarks
+//
+
+#pragma once
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+#include "AllocationTracker.h"
+
+namespace Benchmark
+{
+struct Result
+{
+    std::string name;
+    uint64_t    iterations;     // calls made to the benchmarked function
+    uint64_t    items;          // items processed across all calls
+    double      seconds;        // wall time across all calls
+    uint64_t    allocations;    // heap allocations across all calls, on any thread
+
+    double NanosecondsPerItem() const { return items ? seconds * 1e9 / double(items) : 0.0; }
+    double NanosecondsPerIteration() const { return iterations ? seconds * 1e9 / double(iterations) : 0.0; }
+    double ItemsPerSecond() const { return seconds > 0.0 ? double(items) / seconds : 0.0; }
+    double AllocationsPerIteration() const { return iterations ? double(allocations) / double(iterations) : 0.0; }
+};
+
+// Call func() repeatedly, doubling the batch of calls until one batch takes at least minSeconds.
+// Each call is expected to process itemsPerCall items.
+template<typename TFunc>
+Result Measure(const char* name, uint64_t itemsPerCall, const TFunc& func, double minSeconds = 0.2)
+{
+    using Clock = std::chrono::steady_clock;
+
+    func(); // warm caches and lazily built tables
+
+    uint64_t calls = 1;
+    for (;;)
+    {
+        auto allocations = AllocationTracker::GetAllocationCount();
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < calls; ++i)
+        {
+            func();
+        }
+        auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        allocations = AllocationTracker::GetAllocationCount() - allocations;
+
+        if (seconds >= minSeconds || calls >= (uint64_t(1) << 40))
+        {
+            return Result{ name, calls, calls * itemsPerCall, seconds, allocations };
+        }
+        calls *= 2;
+    }
+}
+
+// Write results as an aligned text table.
+void WriteTable(std::wostream& output, const Result* results, size_t count);
+
+// Write results as JSON in the layout of Google Benchmark's --benchmark_format=json (times in nanoseconds
+// per iteration), so existing tools can compare runs. suite names the set of benchmarks in the context.
+void WriteJson(std::ostream& output, const char* suite, const Result* results, size_t count);
+}
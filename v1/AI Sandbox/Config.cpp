@@ -1,16 +1,36 @@
 #include "pch.h"
 #include "Config.h"
 
-bool Config::LoadConfigFile()
-{
-    // TODO : load configuration from file, creating the file using default values if needed
-    return false;
-}
+#include <cfloat>
+#include <climits>
+#include <cstring>
+
+#include "DebugGeometry.h"
 
 namespace Config
 {
 // General
-int ConfigVersion = 1;
+int ConfigVersion = 1; // configuration files must have this version
+
+// Game loop
+float Game_ConfigPollInterval = 1.f; // seconds between checks of Config.txt in the local folder for changes (0 for none)
+int Game_DebugCategories = 7; // DebugCategory flags drawn while debug info is shown (1 velocity, 2 acceleration, 4 targets, 8 sensors)
+bool Game_InterpolateRendering = true; // draw objects blended between the last two updates (a frame later, but smooth at any update rate)
+float Game_MaxCatchUpSeconds = 0.05f; // wall time one frame may spend catching up on missed updates
+int Game_MaxCatchUpUpdates = 4; // updates one frame may run to catch up
+int Game_MetricsSampleInterval = 60; // updates between metric samples, written to Metrics.csv and Metrics.json in the local folder at exit (0 for none)
+bool Game_RecordInput = false; // write every update's input to InputRecording.bin in the local folder, for --replay
+bool Game_SimulationThread = true; // run the simulation on its own thread, independent of rendering and vsync
+float Game_UpdateRate = 60.f; // fixed simulation updates per second, read at startup
+
+// Collision resolution
+float ContactSolver_BaumgarteFactor = 0.2f; // fraction of remaining penetration corrected per update
+int ContactSolver_MaxIterations = 8;
+bool ContactSolver_ParallelSolve = true;
+float ContactSolver_PenetrationSlop = 0.05f; // meters
+float ContactSolver_ResidualTolerance = 0.001f; // Newton-seconds
+float ContactSolver_RestitutionThreshold = 1.f; // meters per second
+bool ContactSolver_WarmStarting = true;
 
 // Behavior Modules
 char BehaviorModule_DefaultPriorityLevel = 5;
@@ -24,10 +44,91 @@ float GameObject_DefaultMass = 5.f; // kilograms
 float GameObject_DefaultMaxAcceleration = 100.f; // meters per second per second
 float GameObject_DefaultMaxAngularVelocity = 6.f; // radians per second
 float GameObject_DefaultMaxSpeed = 300.f; // meters per second
+float GameObject_DefaultRadius = 4.f; // used until a texture provides the object's size
 const wchar_t* GameObject_DefaultTextureFile = L"Assets\\DefaultGameObject.png";
 
 // World attributes
+float World_ActivationRadius = 1024.f; // meters around each player and the view in which chunks are fully simulated
+float World_ChunkSize = 256.f; // meters
+int World_DormantUpdateInterval = 10; // updates between aggregate updates of dormant chunks
 float World_FrictionCoefficient = 0.5f;
 float World_Gravity = 9.8f; // meters per second per second
+float World_Height = 19200.f; // meters
 float World_ScaleMetersPerPixel = 0.1f; // world scale for displaying sprites
+float World_ViewCullMargin = 64.f; // meters around the view within which objects are still drawn (sprites and debug info reach past their positions)
+float World_Width = 25600.f; // meters
+}
+
+namespace
+{
+using Config::Setting;
+using Config::SettingType;
+
+#define CONFIG_SETTING(type, name, minimum, maximum) { #name, SettingType::type, &Config::name, minimum, maximum }
+
+// No upper limit but the type's.
+const double Unbounded = FLT_MAX;
+
+// Meters. The chunk grid has at most (MaxWorldExtent / 1 meter) columns and rows.
+const double MaxWorldExtent = 1000000.0;
+
+// Everything above but ConfigVersion (checked separately) and the texture file (not a setting of the simulation).
+// Ranges keep the game defined (no division by zero, a chunk grid that fits), not necessarily sensible.
+const Setting Settings[] =
+{
+    CONFIG_SETTING(Float, Game_ConfigPollInterval, 0, 3600),
+    CONFIG_SETTING(Int, Game_DebugCategories, 0, DebugCategory_All),
+    CONFIG_SETTING(Bool, Game_InterpolateRendering, 0, 1),
+    CONFIG_SETTING(Float, Game_MaxCatchUpSeconds, 0, 1),
+    CONFIG_SETTING(Int, Game_MaxCatchUpUpdates, 1, 1000),
+    CONFIG_SETTING(Int, Game_MetricsSampleInterval, 0, INT_MAX),
+    CONFIG_SETTING(Bool, Game_RecordInput, 0, 1),
+    CONFIG_SETTING(Bool, Game_SimulationThread, 0, 1),
+    CONFIG_SETTING(Float, Game_UpdateRate, 1, 1000),
+    CONFIG_SETTING(Float, ContactSolver_BaumgarteFactor, 0, 1),
+    CONFIG_SETTING(Int, ContactSolver_MaxIterations, 0, 1000),
+    CONFIG_SETTING(Bool, ContactSolver_ParallelSolve, 0, 1),
+    CONFIG_SETTING(Float, ContactSolver_PenetrationSlop, 0, Unbounded),
+    CONFIG_SETTING(Float, ContactSolver_ResidualTolerance, 0, Unbounded),
+    CONFIG_SETTING(Float, ContactSolver_RestitutionThreshold, 0, Unbounded),
+    CONFIG_SETTING(Bool, ContactSolver_WarmStarting, 0, 1),
+    CONFIG_SETTING(Char, BehaviorModule_DefaultPriorityLevel, CHAR_MIN, CHAR_MAX),
+    CONFIG_SETTING(Float, Follow_DefaultDistance, 0, Unbounded),
+    CONFIG_SETTING(Char, PlayerInput_DefaultPriorityLevel, CHAR_MIN, CHAR_MAX),
+    CONFIG_SETTING(Float, GameObject_DefaultCoefficientFriction, 0, Unbounded),
+    CONFIG_SETTING(Float, GameObject_DefaultCoefficientRestitution, 0, Unbounded),
+    CONFIG_SETTING(Float, GameObject_DefaultMass, 0.001, Unbounded),
+    CONFIG_SETTING(Float, GameObject_DefaultMaxAcceleration, 0, Unbounded),
+    CONFIG_SETTING(Float, GameObject_DefaultMaxAngularVelocity, 0, Unbounded),
+    CONFIG_SETTING(Float, GameObject_DefaultMaxSpeed, 0, Unbounded),
+    CONFIG_SETTING(Float, GameObject_DefaultRadius, 0.001, Unbounded),
+    CONFIG_SETTING(Float, World_ActivationRadius, 0, Unbounded),
+    CONFIG_SETTING(Float, World_ChunkSize, 1, MaxWorldExtent),
+    CONFIG_SETTING(Int, World_DormantUpdateInterval, 1, INT_MAX),
+    CONFIG_SETTING(Float, World_FrictionCoefficient, 0, Unbounded),
+    CONFIG_SETTING(Float, World_Gravity, 0, Unbounded),
+    CONFIG_SETTING(Float, World_Height, 1, MaxWorldExtent),
+    CONFIG_SETTING(Float, World_ScaleMetersPerPixel, 0.001, 1000),
+    CONFIG_SETTING(Float, World_ViewCullMargin, 0, Unbounded),
+    CONFIG_SETTING(Float, World_Width, 1, MaxWorldExtent),
+};
+
+#undef CONFIG_SETTING
+}
+
+const Config::Setting* Config::GetSettings(size_t* count)
+{
+    *count = sizeof(Settings) / sizeof(Settings[0]);
+    return Settings;
+}
+
+const Config::Setting* Config::FindSetting(const char* name)
+{
+    for (const auto& setting : Settings)
+    {
+        if (strcmp(setting.name, name) == 0)
+            return &setting;
+    }
+
+    return nullptr;
 }
@@ -2,10 +2,50 @@
 
 namespace Config
 {
-bool LoadConfigFile();
+// Settings a configuration file can set (see ConfigFile), by name, with their type, variable and the range of
+// values the game is defined for.
+enum class SettingType
+{
+    Bool,
+    Char,
+    Float,
+    Int
+};
+
+struct Setting
+{
+    const char*     name;
+    SettingType     type;
+    void*           value;
+    double          minimum; // inclusive; ignored for Bool
+    double          maximum;
+};
+
+const Setting* GetSettings(size_t* count);
+const Setting* FindSetting(const char* name); // nullptr if there is no such setting
 
 // General
-extern int ConfigVersion;
+extern int ConfigVersion; // configuration files must have this version
+
+// Game loop
+extern float Game_ConfigPollInterval; // seconds between checks of Config.txt in the local folder for changes (0 for none)
+extern int Game_DebugCategories; // DebugCategory flags drawn while debug info is shown (1 velocity, 2 acceleration, 4 targets, 8 sensors)
+extern bool Game_InterpolateRendering; // draw objects blended between the last two updates (a frame later, but smooth at any update rate)
+extern float Game_MaxCatchUpSeconds; // wall time one frame may spend catching up on missed updates
+extern int Game_MaxCatchUpUpdates; // updates one frame may run to catch up
+extern int Game_MetricsSampleInterval; // updates between metric samples, written to Metrics.csv and Metrics.json in the local folder at exit (0 for none)
+extern bool Game_RecordInput; // write every update's input to InputRecording.bin in the local folder, for --replay
+extern bool Game_SimulationThread; // run the simulation on its own thread, independent of rendering and vsync
+extern float Game_UpdateRate; // fixed simulation updates per second, read at startup
+
+// Collision resolution
+extern float ContactSolver_BaumgarteFactor; // fraction of remaining penetration corrected per update
+extern int ContactSolver_MaxIterations;
+extern bool ContactSolver_ParallelSolve;
+extern float ContactSolver_PenetrationSlop; // meters
+extern float ContactSolver_ResidualTolerance; // Newton-seconds
+extern float ContactSolver_RestitutionThreshold; // meters per second
+extern bool ContactSolver_WarmStarting;
 
 // Behavior modules
 extern char BehaviorModule_DefaultPriorityLevel;
@@ -19,10 +59,17 @@ extern float GameObject_DefaultMass; // kilograms
 extern float GameObject_DefaultMaxAcceleration; // meters per second per second
 extern float GameObject_DefaultMaxAngularVelocity; // radians per second
 extern float GameObject_DefaultMaxSpeed; // meters per second
+extern float GameObject_DefaultRadius; // used until a texture provides the object's size
 extern const wchar_t* GameObject_DefaultTextureFile;
 
 // World attributes
+extern float World_ActivationRadius; // meters around each player and the view in which chunks are fully simulated
+extern float World_ChunkSize; // meters
+extern int World_DormantUpdateInterval; // updates between aggregate updates of dormant chunks
 extern float World_FrictionCoefficient;
 extern float World_Gravity; // meters per second per second
+extern float World_Height; // meters
 extern float World_ScaleMetersPerPixel; // world scale for displaying sprites
+extern float World_ViewCullMargin; // meters around the view within which objects are still drawn (sprites and debug info reach past their positions)
+extern float World_Width; // meters
 }
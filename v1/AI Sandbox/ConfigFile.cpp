@@ -0,0 +1,386 @@
+#include "pch.h"
+#include "ConfigFile.h"
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+using namespace Config;
+
+namespace
+{
+const char* ArchetypeSectionPrefix = "[archetype ";
+
+std::string Trim(const std::string& text)
+{
+    auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return std::string();
+
+    auto last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+bool ParseBool(const std::string& text, bool* value)
+{
+    if (text == "true" || text == "1")
+    {
+        *value = true;
+        return true;
+    }
+    if (text == "false" || text == "0")
+    {
+        *value = false;
+        return true;
+    }
+    return false;
+}
+
+bool ParseFloat(const std::string& text, float* value)
+{
+    char* end;
+    *value = strtof(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && std::isfinite(*value);
+}
+
+bool ParseInt(const std::string& text, long minValue, long maxValue, long* value)
+{
+    char* end;
+    *value = strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && *value >= minValue && *value <= maxValue;
+}
+
+std::string FormatNumber(double value)
+{
+    std::ostringstream text;
+    text << value;
+    return text.str();
+}
+
+// The shortest form that ParseFloat reads back as the same value, so a written file applies exactly the
+// settings it was written from.
+std::string FormatFloat(float value)
+{
+    std::ostringstream text;
+    for (int precision = 6; ; ++precision)
+    {
+        text.str(std::string());
+        text.precision(precision);
+        text << value;
+
+        float parsed;
+        if (precision >= std::numeric_limits<float>::max_digits10 || (ParseFloat(text.str(), &parsed) && parsed == value))
+            return text.str();
+    }
+}
+}
+
+ConfigFile::ConfigFile() :
+    m_archetypes(Archetype())
+{
+}
+
+ConfigFile::~ConfigFile()
+{
+}
+
+bool ConfigFile::Read(std::istream& input, std::string* error)
+{
+    struct ArchetypeSection
+    {
+        std::string name;
+        Archetype   archetype; // fields not given are NaN
+    };
+
+    std::vector<Value> values;
+    std::vector<ArchetypeSection> sections;
+    bool hasVersion = false;
+
+    std::string line;
+    size_t lineNumber = 0;
+    auto fail = [&](const std::string& message)
+    {
+        if (error)
+        {
+            *error = "line " + std::to_string(lineNumber) + ": " + message;
+        }
+        return false;
+    };
+
+    while (std::getline(input, line))
+    {
+        ++lineNumber;
+
+        auto comment = line.find('#');
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
+        line = Trim(line);
+        if (line.empty())
+            continue;
+
+        if (line.front() == '[')
+        {
+            auto prefixLength = strlen(ArchetypeSectionPrefix);
+            if (!hasVersion)
+                return fail("expected ConfigVersion first");
+            if (line.back() != ']' || line.compare(0, prefixLength, ArchetypeSectionPrefix) != 0)
+                return fail("expected [archetype Name]");
+
+            auto name = Trim(line.substr(prefixLength, line.size() - prefixLength - 1));
+            if (name.empty())
+                return fail("archetype has no name");
+            if (name == ArchetypeTable::DefaultName)
+                return fail("the Default archetype is set with the GameObject_Default settings");
+            if (sections.size() + 1 >= ArchetypeTable::NoArchetype)
+                return fail("too many archetypes");
+            for (const auto& section : sections)
+            {
+                if (section.name == name)
+                    return fail("archetype '" + name + "' is given twice");
+            }
+
+            ArchetypeSection section;
+            section.name = name;
+            for (size_t i = 0; i < Archetype::FieldCount; ++i)
+            {
+                const char* fieldName;
+                section.archetype.*Archetype::GetField(i, &fieldName) = NAN;
+            }
+            sections.push_back(section);
+            continue;
+        }
+
+        auto equals = line.find('=');
+        if (equals == std::string::npos)
+            return fail("expected name = value");
+
+        auto name = Trim(line.substr(0, equals));
+        auto text = Trim(line.substr(equals + 1));
+
+        if (!hasVersion)
+        {
+            long version;
+            if (name != "ConfigVersion" || !ParseInt(text, 0, INT_MAX, &version))
+                return fail("expected ConfigVersion first");
+            if (version != ConfigVersion)
+                return fail("ConfigVersion " + text + " is not supported (expected " + std::to_string(ConfigVersion) + ")");
+
+            hasVersion = true;
+            continue;
+        }
+
+        if (!sections.empty())
+        {
+            auto field = Archetype::FindField(name);
+            if (!field)
+                return fail("unknown archetype field '" + name + "'");
+
+            // Mass and radius divide; nothing else makes sense negative.
+            float value;
+            bool mustBePositive = field == &Archetype::mass || field == &Archetype::radius;
+            if (!ParseFloat(text, &value) || value < 0.f || (mustBePositive && value == 0.f))
+                return fail("'" + text + "' is not a valid " + name);
+
+            sections.back().archetype.*field = value;
+            continue;
+        }
+
+        auto setting = FindSetting(name.c_str());
+        if (!setting)
+            return fail("unknown setting '" + name + "'");
+
+        Value value;
+        value.setting = setting;
+
+        bool isValid = false;
+        long intValue;
+        double number = 0.0;
+        switch (setting->type)
+        {
+        case SettingType::Bool:
+            isValid = ParseBool(text, &value.boolValue);
+            break;
+
+        case SettingType::Char:
+            isValid = ParseInt(text, CHAR_MIN, CHAR_MAX, &intValue);
+            value.charValue = char(intValue);
+            number = double(intValue);
+            break;
+
+        case SettingType::Float:
+            isValid = ParseFloat(text, &value.floatValue);
+            number = double(value.floatValue);
+            break;
+
+        case SettingType::Int:
+            isValid = ParseInt(text, INT_MIN, INT_MAX, &intValue);
+            value.intValue = int(intValue);
+            number = double(intValue);
+            break;
+        }
+        if (!isValid)
+            return fail("'" + text + "' is not a valid value for " + name);
+        if (setting->type != SettingType::Bool && (number < setting->minimum || number > setting->maximum))
+        {
+            auto range = setting->maximum >= FLT_MAX ? "at least " + FormatNumber(setting->minimum) :
+                "from " + FormatNumber(setting->minimum) + " to " + FormatNumber(setting->maximum);
+            return fail(name + " must be " + range + " (not " + text + ")");
+        }
+
+        values.push_back(value);
+    }
+
+    if (!hasVersion)
+    {
+        if (error)
+        {
+            *error = "no ConfigVersion";
+        }
+        return false;
+    }
+
+    // Accepted: keep everything. Archetype fields not given come from the Default archetype this file makes.
+    m_values.swap(values);
+
+    auto defaultValue = [&](float* variable)
+    {
+        auto value = FindValue(variable);
+        return value ? value->floatValue : *variable;
+    };
+
+    Archetype defaults;
+    defaults.coefficientFriction = defaultValue(&GameObject_DefaultCoefficientFriction);
+    defaults.coefficientRestitution = defaultValue(&GameObject_DefaultCoefficientRestitution);
+    defaults.mass = defaultValue(&GameObject_DefaultMass);
+    defaults.maxAcceleration = defaultValue(&GameObject_DefaultMaxAcceleration);
+    defaults.maxAngularVelocity = defaultValue(&GameObject_DefaultMaxAngularVelocity);
+    defaults.maxSpeed = defaultValue(&GameObject_DefaultMaxSpeed);
+    defaults.radius = defaultValue(&GameObject_DefaultRadius);
+
+    m_archetypes = ArchetypeTable(defaults);
+    for (auto& section : sections)
+    {
+        for (size_t i = 0; i < Archetype::FieldCount; ++i)
+        {
+            const char* fieldName;
+            auto field = Archetype::GetField(i, &fieldName);
+            if (std::isnan(section.archetype.*field))
+            {
+                section.archetype.*field = defaults.*field;
+            }
+        }
+
+        m_archetypes.Set(section.name, section.archetype);
+    }
+
+    return true;
+}
+
+bool ConfigFile::Load(const std::wstring& path, std::string* error)
+{
+    std::ifstream input(path);
+    if (!input)
+    {
+        if (error)
+        {
+            *error = "cannot open the file";
+        }
+        return false;
+    }
+
+    return Read(input, error);
+}
+
+void ConfigFile::Write(std::ostream& output, const ArchetypeTable& archetypes)
+{
+    output << "# AI Sandbox configuration. Changes to this file are applied while the game runs.\n";
+    output << "ConfigVersion = " << ConfigVersion << "\n\n";
+
+    size_t count;
+    auto settings = GetSettings(&count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& setting = settings[i];
+        output << setting.name << " = ";
+        switch (setting.type)
+        {
+        case SettingType::Bool:
+            output << (*static_cast<bool*>(setting.value) ? "true" : "false");
+            break;
+
+        case SettingType::Char:
+            output << int(*static_cast<char*>(setting.value));
+            break;
+
+        case SettingType::Float:
+            output << FormatFloat(*static_cast<float*>(setting.value));
+            break;
+
+        case SettingType::Int:
+            output << *static_cast<int*>(setting.value);
+            break;
+        }
+        output << "\n";
+    }
+
+    for (uint16_t index = 0; index < archetypes.GetCount(); ++index)
+    {
+        if (index == ArchetypeTable::DefaultArchetype)
+            continue;
+
+        output << "\n" << ArchetypeSectionPrefix << archetypes.GetName(index) << "]\n";
+        for (size_t i = 0; i < Archetype::FieldCount; ++i)
+        {
+            const char* fieldName;
+            auto field = Archetype::GetField(i, &fieldName);
+            output << fieldName << " = " << FormatFloat(archetypes.Get(index).*field) << "\n";
+        }
+    }
+}
+
+void ConfigFile::Apply() const
+{
+    for (const auto& value : m_values)
+    {
+        switch (value.setting->type)
+        {
+        case SettingType::Bool:
+            *static_cast<bool*>(value.setting->value) = value.boolValue;
+            break;
+
+        case SettingType::Char:
+            *static_cast<char*>(value.setting->value) = value.charValue;
+            break;
+
+        case SettingType::Float:
+            *static_cast<float*>(value.setting->value) = value.floatValue;
+            break;
+
+        case SettingType::Int:
+            *static_cast<int*>(value.setting->value) = value.intValue;
+            break;
+        }
+    }
+}
+
+const ConfigFile::Value* ConfigFile::FindValue(const void* variable) const
+{
+    // The last value given for a setting wins.
+    for (auto value = m_values.crbegin(); value != m_values.crend(); ++value)
+    {
+        if (value->setting->value == variable)
+            return &*value;
+    }
+
+    return nullptr;
+}
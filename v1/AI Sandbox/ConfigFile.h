@@ -0,0 +1,63 @@
+//
+// ConfigFile.h - reads and writes the game's configuration file
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+#include "ArchetypeTable.h"
+
+// A parsed configuration file. The format is one "name = value" per line, with '#' starting a comment:
+//
+//     ConfigVersion = 1
+//     World_Gravity = 9.8
+//
+//     [archetype Heavy]
+//     mass = 50
+//     maxSpeed = 100
+//
+// The first line must give ConfigVersion, and it must be Config::ConfigVersion. Settings are the Config
+// variables (see Config::GetSettings); names and values are checked against their types and ranges. Each archetype
+// section sets the listed fields of one archetype; the others come from the GameObject_Default settings.
+//
+// Reading stages everything: nothing changes until Apply, and a file with any error is rejected whole.
+class ConfigFile
+{
+public:
+    ConfigFile();
+    ~ConfigFile();
+
+    // Returns false on the first error, described in error (if not null) with its line number.
+    bool Read(std::istream& input, std::string* error);
+    bool Load(const std::wstring& path, std::string* error);
+
+    // Write the current settings, and every archetype of the table but Default, in the format Read expects.
+    // Numbers are written precisely enough to read back as the same values.
+    static void Write(std::ostream& output, const ArchetypeTable& archetypes);
+
+    // Set the Config variables the file gives; the others keep their values.
+    void Apply() const;
+
+    // Default (from the GameObject_Default settings once applied), then the file's archetypes.
+    const ArchetypeTable& GetArchetypes() const { return m_archetypes; }
+
+private:
+    struct Value
+    {
+        const Config::Setting*  setting;
+        union
+        {
+            bool    boolValue;
+            char    charValue;
+            float   floatValue;
+            int     intValue;
+        };
+    };
+
+    const Value* FindValue(const void* variable) const; // the value given for that Config variable, if any
+
+    ArchetypeTable      m_archetypes;
+    std::vector<Value>  m_values;
+};
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "ConfigWatcher.h"
+
+#include <fstream>
+#include <sstream>
+
+ConfigWatcher::ConfigWatcher() :
+    m_pollInterval(0),
+    m_running(false)
+{
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    Stop();
+}
+
+void ConfigWatcher::Start(const std::wstring& path, float pollInterval)
+{
+    if (m_thread.joinable() || pollInterval <= 0.f)
+        return;
+
+    m_path = path;
+    m_pollInterval = std::chrono::milliseconds(int64_t(pollInterval * 1000.f));
+    ReadContents(&m_contents);
+
+    m_running = true;
+    m_thread = std::thread([this]() { Run(); });
+}
+
+void ConfigWatcher::Stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+std::unique_ptr<ConfigFile> ConfigWatcher::TakePending()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_pending);
+}
+
+bool ConfigWatcher::ReadContents(std::string* contents) const
+{
+    std::ifstream input(m_path, std::ios::binary);
+    if (!input)
+        return false;
+
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    *contents = buffer.str();
+    return true;
+}
+
+// Body of the watcher thread.
+void ConfigWatcher::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, m_pollInterval, [this]() { return !m_running; }))
+    {
+        lock.unlock();
+
+        // Editors often write a file in several steps; a half-written file fails to parse and is picked up
+        // again, complete, at a later check.
+        std::string contents;
+        if (ReadContents(&contents) && contents != m_contents)
+        {
+            auto config = std::make_unique<ConfigFile>();
+            std::istringstream input(contents);
+            std::string error;
+            if (config->Read(input, &error))
+            {
+                m_contents.swap(contents);
+                m_lastError.clear();
+
+                lock.lock();
+                m_pending = std::move(config);
+                continue;
+            }
+
+            if (error != m_lastError)
+            {
+                m_lastError = error;
+                OutputDebugStringA(("Config file not applied: " + error + "\n").c_str());
+            }
+        }
+
+        lock.lock();
+    }
+}
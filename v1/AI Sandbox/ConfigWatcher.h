@@ -0,0 +1,44 @@
+//
+// ConfigWatcher.h - watches the configuration file for changes on a background thread
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ConfigFile.h"
+
+// Checks the file every poll interval and parses it when its contents change, off the simulation thread.
+// The simulation takes the parsed file between updates and applies it there, so a change never lands in
+// the middle of an update. A file that does not parse is reported in the debugger output and otherwise ignored.
+class ConfigWatcher
+{
+public:
+    ConfigWatcher();
+    ~ConfigWatcher();
+
+    // Changes are relative to the file's contents when watching starts.
+    void Start(const std::wstring& path, float pollInterval);
+    void Stop();
+
+    // The latest change that parsed, if any not taken yet.
+    std::unique_ptr<ConfigFile> TakePending();
+
+private:
+    bool ReadContents(std::string* contents) const;
+    void Run();
+
+    std::string                 m_contents; // as of the last change that parsed
+    std::string                 m_lastError; // reported once
+    std::mutex                  m_mutex;
+    std::wstring                m_path;
+    std::unique_ptr<ConfigFile> m_pending;
+    std::chrono::milliseconds   m_pollInterval;
+    bool                        m_running;
+    std::thread                 m_thread;
+    std::condition_variable     m_wake; // stops the thread without waiting out the interval
+};
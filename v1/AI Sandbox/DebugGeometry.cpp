@@ -0,0 +1,98 @@
+#include "pch.h"
+#include "DebugGeometry.h"
+
+#include <cfloat>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+    // Vertices blended and submitted at a time: whole lines and triangles, and well within PrimitiveBatch's
+    // default vertex limit.
+    const size_t RenderBatchSize = 768;
+
+    void RenderBlended(PrimitiveBatch<VertexPositionColor>* primitiveBatch, D3D11_PRIMITIVE_TOPOLOGY topology,
+        const std::vector<VertexPositionColor>& vertices, const std::vector<Vector2>& moves, float alpha)
+    {
+        VertexPositionColor blended[RenderBatchSize];
+        auto back = alpha - 1.f;
+        for (size_t begin = 0; begin < vertices.size(); begin += RenderBatchSize)
+        {
+            auto count = std::min(RenderBatchSize, vertices.size() - begin);
+            for (size_t i = 0; i < count; ++i)
+            {
+                blended[i] = vertices[begin + i];
+                blended[i].position.x += moves[begin + i].x * back;
+                blended[i].position.y += moves[begin + i].y * back;
+            }
+
+            primitiveBatch->Draw(topology, blended, count);
+        }
+    }
+}
+
+DebugGeometry::DebugGeometry() :
+    m_categoryMask(DebugCategory_All),
+    m_cullMax(FLT_MAX, FLT_MAX),
+    m_cullMin(-FLT_MAX, -FLT_MAX),
+    m_move(Vector2::Zero)
+{
+}
+
+DebugGeometry::~DebugGeometry()
+{
+}
+
+void DebugGeometry::Clear()
+{
+    m_lineMoves.clear();
+    m_lineVertices.clear();
+    m_move = Vector2::Zero;
+    m_triangleMoves.clear();
+    m_triangleVertices.clear();
+}
+
+void DebugGeometry::Reserve(size_t lineVertexCount, size_t triangleVertexCount)
+{
+    m_lineMoves.reserve(lineVertexCount);
+    m_lineVertices.reserve(lineVertexCount);
+    m_triangleMoves.reserve(triangleVertexCount);
+    m_triangleVertices.reserve(triangleVertexCount);
+}
+
+void DebugGeometry::DrawLine(const VertexPositionColor& v1, const VertexPositionColor& v2)
+{
+    m_lineVertices.push_back(v1);
+    m_lineVertices.push_back(v2);
+    m_lineMoves.insert(m_lineMoves.end(), 2, m_move);
+}
+
+void DebugGeometry::DrawTriangle(const VertexPositionColor& v1, const VertexPositionColor& v2, const VertexPositionColor& v3)
+{
+    m_triangleVertices.push_back(v1);
+    m_triangleVertices.push_back(v2);
+    m_triangleVertices.push_back(v3);
+    m_triangleMoves.insert(m_triangleMoves.end(), 3, m_move);
+}
+
+void DebugGeometry::Append(const DebugGeometry& other)
+{
+    m_lineMoves.insert(m_lineMoves.end(), other.m_lineMoves.begin(), other.m_lineMoves.end());
+    m_lineVertices.insert(m_lineVertices.end(), other.m_lineVertices.begin(), other.m_lineVertices.end());
+    m_triangleMoves.insert(m_triangleMoves.end(), other.m_triangleMoves.begin(), other.m_triangleMoves.end());
+    m_triangleVertices.insert(m_triangleVertices.end(), other.m_triangleVertices.begin(), other.m_triangleVertices.end());
+}
+
+void DebugGeometry::CopyFilter(const DebugGeometry& other)
+{
+    m_categoryMask = other.m_categoryMask;
+    m_cullMax = other.m_cullMax;
+    m_cullMin = other.m_cullMin;
+}
+
+void DebugGeometry::Render(PrimitiveBatch<VertexPositionColor>* primitiveBatch, float alpha) const
+{
+    RenderBlended(primitiveBatch, D3D11_PRIMITIVE_TOPOLOGY_LINELIST, m_lineVertices, m_lineMoves, alpha);
+    RenderBlended(primitiveBatch, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, m_triangleVertices, m_triangleMoves, alpha);
+}
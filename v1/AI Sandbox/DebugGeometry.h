@@ -0,0 +1,70 @@
+//
+// DebugGeometry.h - debug lines and triangles recorded for drawing later, possibly on another thread
+//
+
+#pragma once
+
+// Kinds of debug geometry, as flags for DebugGeometry::SetCategoryMask.
+enum DebugCategory : uint32_t
+{
+    DebugCategory_Velocity      = 1 << 0,
+    DebugCategory_Acceleration  = 1 << 1,
+    DebugCategory_Targets       = 1 << 2,   // where objects are headed (drawn by their behavior modules)
+    DebugCategory_Sensors       = 1 << 3,   // collision radii
+    DebugCategory_All           = 0xF
+};
+
+// Vertices are kept in CPU-side arrays, so recording needs no device and can be checked or measured on its
+// own. Code that records geometry asks IsEnabled and IsVisible first, to skip what would not be drawn.
+class DebugGeometry
+{
+public:
+    DebugGeometry();
+    ~DebugGeometry();
+
+    // Remove the recorded vertices, keeping the filter and the arrays' capacity.
+    void Clear();
+    void Reserve(size_t lineVertexCount, size_t triangleVertexCount);
+
+    // How far the object being recorded moved in the latest update (zero for geometry fixed in the world, and
+    // after Clear). Render draws what is recorded after this back along the move, to where the object's sprite
+    // is drawn between updates.
+    void SetMove(DirectX::SimpleMath::Vector2 move) { m_move = move; }
+
+    void DrawLine(const DirectX::VertexPositionColor& v1, const DirectX::VertexPositionColor& v2);
+    void DrawTriangle(const DirectX::VertexPositionColor& v1, const DirectX::VertexPositionColor& v2, const DirectX::VertexPositionColor& v3);
+    void Append(const DebugGeometry& other);
+
+    // Filter: the categories to record (all by default) and the bounds outside which nothing is visible
+    // (unbounded by default). CopyFilter takes both from another recording.
+    void SetCategoryMask(uint32_t mask) { m_categoryMask = mask; }
+    void SetCullBounds(DirectX::SimpleMath::Vector2 min, DirectX::SimpleMath::Vector2 max) { m_cullMin = min; m_cullMax = max; }
+    void CopyFilter(const DebugGeometry& other);
+
+    uint32_t GetCategoryMask() const { return m_categoryMask; }
+    DirectX::SimpleMath::Vector2 GetCullMin() const { return m_cullMin; }
+    DirectX::SimpleMath::Vector2 GetCullMax() const { return m_cullMax; }
+    bool IsEnabled(uint32_t category) const { return (m_categoryMask & category) != 0; }
+    bool IsVisible(DirectX::SimpleMath::Vector2 min, DirectX::SimpleMath::Vector2 max) const
+    {
+        return min.x <= m_cullMax.x && max.x >= m_cullMin.x && min.y <= m_cullMax.y && max.y >= m_cullMin.y;
+    }
+
+    // Two vertices per line and three per triangle, in recording order.
+    const std::vector<DirectX::VertexPositionColor>& GetLineVertices() const { return m_lineVertices; }
+    const std::vector<DirectX::VertexPositionColor>& GetTriangleVertices() const { return m_triangleVertices; }
+
+    // Submit everything recorded to a batch that has already been begun, blended this far (0 to 1) from before
+    // the latest update to after it, as SpriteInstance::Interpolate blends the sprites.
+    void Render(DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* primitiveBatch, float alpha = 1.f) const;
+
+private:
+    uint32_t                                    m_categoryMask;
+    DirectX::SimpleMath::Vector2                m_cullMax;
+    DirectX::SimpleMath::Vector2                m_cullMin;
+    DirectX::SimpleMath::Vector2                m_move;
+    std::vector<DirectX::SimpleMath::Vector2>   m_lineMoves; // one per vertex
+    std::vector<DirectX::VertexPositionColor>   m_lineVertices;
+    std::vector<DirectX::SimpleMath::Vector2>   m_triangleMoves;
+    std::vector<DirectX::VertexPositionColor>   m_triangleVertices;
+};
@@ -0,0 +1,157 @@
+#include "pch.h"
+#include "DeterminismCheck.h"
+#include "FixedPoint.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace
+{
+bool operator==(const HashedObjectState& a, const HashedObjectState& b)
+{
+    return a.id == b.id && a.teamNumber == b.teamNumber && a.positionX == b.positionX && a.positionY == b.positionY &&
+        a.velocityX == b.velocityX && a.velocityY == b.velocityY && a.rotation == b.rotation;
+}
+
+void FindDivergingPlayer(World* first, World* second, DeterminismCheckResult* result)
+{
+    const auto& firstState = first->GetHashedState();
+    const auto& secondState = second->GetHashedState();
+
+    size_t index = 0;
+    while (index < firstState.size() && index < secondState.size() && firstState[index] == secondState[index])
+    {
+        ++index;
+    }
+
+    result->firstHasPlayer = index < firstState.size();
+    result->secondHasPlayer = index < secondState.size();
+    result->hasDivergingPlayer = result->firstHasPlayer || result->secondHasPlayer;
+    if (!result->hasDivergingPlayer)
+        return;
+
+    const auto& states = result->firstHasPlayer ? firstState : secondState;
+    result->divergingPlayerSlot = 0;
+    while (result->divergingPlayerSlot < index && states[index - result->divergingPlayerSlot - 1].teamNumber == states[index].teamNumber)
+    {
+        ++result->divergingPlayerSlot;
+    }
+
+    result->firstPlayer = result->firstHasPlayer ? firstState[index] : HashedObjectState();
+    result->secondPlayer = result->secondHasPlayer ? secondState[index] : HashedObjectState();
+}
+
+void WritePlayerState(std::wostream& output, const wchar_t* run, const HashedObjectState& state)
+{
+    auto toFloat = [](int32_t raw) { return FixedPoint::Fixed::FromRaw(raw).ToFloat(); };
+
+    output << run << L" run: id " << state.id << L", team " << state.teamNumber
+        << L", position (" << toFloat(state.positionX) << L", " << toFloat(state.positionY)
+        << L"), velocity (" << toFloat(state.velocityX) << L", " << toFloat(state.velocityY)
+        << L"), rotation " << toFloat(state.rotation) << L"\n";
+}
+}
+
+DeterminismCheckResult CheckDeterminism(const HeadlessRunOptions& first, const HeadlessRunOptions& second)
+{
+    HeadlessRunner firstRunner(first);
+    HeadlessRunner secondRunner(second);
+    firstRunner.GetWorld()->SetTickHashing(true);
+    secondRunner.GetWorld()->SetTickHashing(true);
+
+    DeterminismCheckResult result = {};
+    while (!firstRunner.IsFinished())
+    {
+        firstRunner.Step();
+        secondRunner.Step();
+
+        result.ticks = firstRunner.GetTicks();
+        result.firstHash = firstRunner.GetWorld()->GetTickHash();
+        result.secondHash = secondRunner.GetWorld()->GetTickHash();
+        result.tickHashes.push_back(result.firstHash);
+
+        if (result.firstHash != result.secondHash)
+        {
+            result.firstDivergingTick = result.ticks;
+            FindDivergingPlayer(firstRunner.GetWorld(), secondRunner.GetWorld(), &result);
+            break;
+        }
+    }
+
+    return result;
+}
+
+uint64_t FindFirstDivergingTick(const std::vector<uint64_t>& hashes, const std::vector<uint64_t>& reference)
+{
+    for (size_t i = 0; i < hashes.size() && i < reference.size(); ++i)
+    {
+        if (hashes[i] != reference[i])
+            return uint64_t(i + 1);
+    }
+    return 0;
+}
+
+void WriteTickHashes(std::ostream& output, const std::vector<uint64_t>& hashes)
+{
+    output << std::hex;
+    for (auto hash : hashes)
+    {
+        output << hash << "\n";
+    }
+    output << std::dec;
+}
+
+bool ReadTickHashes(std::istream& input, std::vector<uint64_t>* hashes)
+{
+    hashes->clear();
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.empty() || line == "\r")
+            continue;
+
+        size_t length = 0;
+        try
+        {
+            hashes->push_back(std::stoull(line, &length, 16));
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        if (line.find_first_not_of(" \t\r", length) != std::string::npos)
+            return false;
+    }
+
+    return true;
+}
+
+void WriteDeterminismCheckResult(std::wostream& output, const DeterminismCheckResult& result)
+{
+    output << L"ticks: " << result.ticks << L"\n"
+        << L"first run hash: " << std::hex << result.firstHash << std::dec << L"\n"
+        << L"second run hash: " << std::hex << result.secondHash << std::dec << L"\n";
+
+    if (!result.Passed())
+    {
+        output << L"first diverging tick: " << result.firstDivergingTick << L"\n";
+        if (result.hasDivergingPlayer)
+        {
+            auto team = result.firstHasPlayer ? result.firstPlayer.teamNumber : result.secondPlayer.teamNumber;
+            output << L"first diverging player: team " << team << L", slot " << result.divergingPlayerSlot << L"\n";
+            if (result.firstHasPlayer)
+            {
+                WritePlayerState(output, L"first", result.firstPlayer);
+            }
+            if (result.secondHasPlayer)
+            {
+                WritePlayerState(output, L"second", result.secondPlayer);
+            }
+        }
+    }
+
+    output << (result.Passed() ? L"passed" : L"FAILED") << std::endl;
+}
@@ -0,0 +1,49 @@
+//
+// DeterminismCheck.h - runs a scenario twice side by side and finds the first update and player they differ on
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include "HeadlessRunner.h"
+
+struct DeterminismCheckResult
+{
+    uint64_t                ticks;              // updates compared, up to and including the first diverging one
+    uint64_t                firstDivergingTick; // 0 if the runs never diverged
+    uint64_t                firstHash;          // tick hashes after the last update compared
+    uint64_t                secondHash;
+
+    // The first player, in team and slot order, whose state differs after the diverging update. If the
+    // runs agree on every player they both have, it is the first player only one of them has.
+    bool                    hasDivergingPlayer;
+    size_t                  divergingPlayerSlot;    // in its team
+    bool                    firstHasPlayer;
+    bool                    secondHasPlayer;
+    HashedObjectState       firstPlayer;
+    HashedObjectState       secondPlayer;
+
+    std::vector<uint64_t>   tickHashes;         // the first run's, one per update
+
+    bool Passed() const { return firstDivergingTick == 0; }
+};
+
+// Runs two headless scenarios one update at a time, comparing World tick hashes after every update, until
+// the first run's limit or the first update after which the hashes differ. With the same options the check
+// finds state that depends on anything but the inputs (uninitialized memory, pointer order, timing); with
+// options that differ only in how the work is done (such as a serial contact solve) it shows that the
+// difference changes nothing.
+DeterminismCheckResult CheckDeterminism(const HeadlessRunOptions& first, const HeadlessRunOptions& second);
+
+// The first update (counting from 1) whose hash differs from a reference, such as one recorded by a build
+// with other instruction sets; 0 if none does. Hash lists of different lengths are compared as far as both go.
+uint64_t FindFirstDivergingTick(const std::vector<uint64_t>& hashes, const std::vector<uint64_t>& reference);
+
+// Tick hashes as one hexadecimal line each. Read returns false if a line is malformed.
+void WriteTickHashes(std::ostream& output, const std::vector<uint64_t>& hashes);
+bool ReadTickHashes(std::istream& input, std::vector<uint64_t>* hashes);
+
+// Write a check's summary as "name: value" lines, ending with "passed" or "FAILED".
+void WriteDeterminismCheckResult(std::wostream& output, const DeterminismCheckResult& result);
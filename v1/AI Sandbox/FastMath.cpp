@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "Benchmark.h"
+#include "FastMath.h"
+
+#include <ostream>
+
+using namespace DirectX;
+
+namespace
+{
+// Load up to four floats, padding missing lanes with zero.
+inline XMVECTOR XM_CALLCONV LoadLanes(const float* source, size_t count)
+{
+    if (count >= 4)
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(source));
+
+    XMFLOAT4 lanes(0.f, 0.f, 0.f, 0.f);
+    memcpy(&lanes, source, count * sizeof(float));
+    return XMLoadFloat4(&lanes);
+}
+
+// Store up to four floats.
+inline void XM_CALLCONV StoreLanes(float* destination, FXMVECTOR v, size_t count)
+{
+    if (count >= 4)
+    {
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destination), v);
+        return;
+    }
+
+    XMFLOAT4 lanes;
+    XMStoreFloat4(&lanes, v);
+    memcpy(destination, &lanes, count * sizeof(float));
+}
+
+inline XMVECTOR XM_CALLCONV LengthSquared(FXMVECTOR x, FXMVECTOR y)
+{
+    return XMVectorMultiplyAdd(x, x, XMVectorMultiply(y, y));
+}
+}
+
+void FastMath::SinCosBatch(const float* angles, float* sines, float* cosines, size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        auto lanes = std::min<size_t>(4, count - i);
+        XMVECTOR s, c;
+        SinCos(LoadLanes(angles + i, lanes), &s, &c);
+        StoreLanes(sines + i, s, lanes);
+        StoreLanes(cosines + i, c, lanes);
+    }
+}
+
+void FastMath::Atan2Batch(const float* y, const float* x, float* angles, size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        auto lanes = std::min<size_t>(4, count - i);
+        StoreLanes(angles + i, Atan2(LoadLanes(y + i, lanes), LoadLanes(x + i, lanes)), lanes);
+    }
+}
+
+void FastMath::LengthBatch(const float* x, const float* y, float* lengths, size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        auto lanes = std::min<size_t>(4, count - i);
+        auto lengthSquared = LengthSquared(LoadLanes(x + i, lanes), LoadLanes(y + i, lanes));
+        StoreLanes(lengths + i, XMVectorMultiply(lengthSquared, ReciprocalSqrt(lengthSquared)), lanes);
+    }
+}
+
+void FastMath::NormalizeBatch(float* x, float* y, size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        auto lanes = std::min<size_t>(4, count - i);
+        auto vx = LoadLanes(x + i, lanes);
+        auto vy = LoadLanes(y + i, lanes);
+        auto scale = ReciprocalSqrt(LengthSquared(vx, vy));
+        StoreLanes(x + i, XMVectorMultiply(vx, scale), lanes);
+        StoreLanes(y + i, XMVectorMultiply(vy, scale), lanes);
+    }
+}
+
+void FastMath::RunBenchmarks(std::wostream& output)
+{
+    // A typical agent population, with angles and vectors spread over the ranges the simulation produces.
+    const size_t count = 10000;
+    std::vector<float> a(count), b(count), c(count), d(count);
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> angleDistribution(-10.f, 10.f);
+    std::uniform_real_distribution<float> componentDistribution(-300.f, 300.f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = angleDistribution(random);
+        b[i] = componentDistribution(random);
+        c[i] = componentDistribution(random);
+    }
+
+    std::vector<Benchmark::Result> results;
+
+    results.push_back(Benchmark::Measure("SinCos (libm)", count, [&]
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            c[i] = std::sin(a[i]);
+            d[i] = std::cos(a[i]);
+        }
+    }));
+    results.push_back(Benchmark::Measure("SinCos (FastMath batch)", count, [&]
+    {
+        SinCosBatch(a.data(), c.data(), d.data(), count);
+    }));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        c[i] = componentDistribution(random);
+    }
+
+    results.push_back(Benchmark::Measure("Atan2 (libm)", count, [&]
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            d[i] = std::atan2(b[i], c[i]);
+        }
+    }));
+    results.push_back(Benchmark::Measure("Atan2 (FastMath batch)", count, [&]
+    {
+        Atan2Batch(b.data(), c.data(), d.data(), count);
+    }));
+
+    results.push_back(Benchmark::Measure("Length (sqrt)", count, [&]
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            d[i] = std::sqrt(b[i] * b[i] + c[i] * c[i]);
+        }
+    }));
+    results.push_back(Benchmark::Measure("Length (FastMath batch)", count, [&]
+    {
+        LengthBatch(b.data(), c.data(), d.data(), count);
+    }));
+
+    // Normalize works in place, so each run normalizes already unit vectors; the cost is the same.
+    results.push_back(Benchmark::Measure("Normalize (Vector2::Normalize)", count, [&]
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            SimpleMath::Vector2 v(b[i], c[i]);
+            v.Normalize();
+            b[i] = v.x;
+            c[i] = v.y;
+        }
+    }));
+    results.push_back(Benchmark::Measure("Normalize (FastMath batch)", count, [&]
+    {
+        NormalizeBatch(b.data(), c.data(), count);
+    }));
+
+    Benchmark::WriteTable(output, results.data(), results.size());
+}
@@ -0,0 +1,160 @@
+//
+// FastMath.h - vectorized polynomial approximations for the per-agent kinematic math
+//
+// The kernels work on four lanes at a time through DirectXMath, so they map onto SSE on x86/x64 and NEON
+// on ARM. Scalar wrappers run the same kernels, so a value gives the same result whether it is computed
+// alone or as part of a batch. Error bounds are maximum absolute errors over the stated range, measured
+// against double precision:
+//
+//   SinCos      |angle| <= 10 radians           4e-7 (angles are first wrapped to [-Pi,Pi]; the wrap is done
+//                                               in single precision, so error grows with |angle|: 6e-6 at
+//                                               100 radians, 6e-5 at 1000)
+//   Atan2       any finite y, x                 3e-7 radians; Atan2(0,0) is 0
+//   ReciprocalSqrt, Length, Normalize          relative error 5e-7 with SSE's 12-bit estimate plus one
+//                                               Newton-Raphson step (2e-5 on ARM's 8-bit estimate)
+//
+// Zero-length vectors normalize to zero and have zero length, matching SimpleMath::Vector2.
+//
+
+#pragma once
+
+#include <iosfwd>
+
+namespace FastMath
+{
+namespace Detail
+{
+XMGLOBALCONST DirectX::XMVECTORF32 SinCoefficients0 = { { { -2.3889859e-08f, 2.7525562e-06f, -1.9840874e-04f, 8.3333310e-03f } } };
+XMGLOBALCONST DirectX::XMVECTORF32 SinCoefficient1 = { { { -1.6666667e-01f, -1.6666667e-01f, -1.6666667e-01f, -1.6666667e-01f } } };
+XMGLOBALCONST DirectX::XMVECTORF32 CosCoefficients0 = { { { -2.6051615e-07f, 2.4760495e-05f, -1.3888378e-03f, 4.1666638e-02f } } };
+XMGLOBALCONST DirectX::XMVECTORF32 AtanCoefficients0 = { { { 0.0028662257f, -0.0161657367f, 0.0429096138f, -0.0752896400f } } };
+XMGLOBALCONST DirectX::XMVECTORF32 AtanCoefficients1 = { { { 0.1065626393f, -0.1420889944f, 0.1999355085f, -0.3333314528f } } };
+XMGLOBALCONST DirectX::XMVECTORF32 OneAndAHalf = { { { 1.5f, 1.5f, 1.5f, 1.5f } } };
+}
+
+// Sine and cosine of four angles.
+inline void XM_CALLCONV SinCos(DirectX::FXMVECTOR angles, DirectX::XMVECTOR* sines, DirectX::XMVECTOR* cosines)
+{
+    using namespace DirectX;
+
+    // Wrap to [-Pi,Pi].
+    XMVECTOR quotient = XMVectorRound(XMVectorMultiply(angles, g_XMReciprocalTwoPi.v));
+    XMVECTOR x = XMVectorNegativeMultiplySubtract(quotient, g_XMTwoPi.v, angles);
+
+    // Fold into [-Pi/2,Pi/2] using sin(x) = sin(Pi - x) and cos(x) = -cos(Pi - x).
+    XMVECTOR sign = XMVectorAndInt(x, g_XMNegativeZero.v);
+    XMVECTOR reflected = XMVectorSubtract(XMVectorOrInt(g_XMPi.v, sign), x);
+    XMVECTOR inRange = XMVectorLessOrEqual(XMVectorAbs(x), g_XMHalfPi.v);
+    x = XMVectorSelect(reflected, x, inRange);
+    XMVECTOR cosineSign = XMVectorSelect(g_XMNegativeOne.v, g_XMOne.v, inRange);
+
+    XMVECTOR x2 = XMVectorMultiply(x, x);
+
+    // Degree 11 odd polynomial for sine.
+    const XMVECTOR sc = Detail::SinCoefficients0;
+    XMVECTOR result = XMVectorSplatX(sc);
+    result = XMVectorMultiplyAdd(result, x2, XMVectorSplatY(sc));
+    result = XMVectorMultiplyAdd(result, x2, XMVectorSplatZ(sc));
+    result = XMVectorMultiplyAdd(result, x2, XMVectorSplatW(sc));
+    result = XMVectorMultiplyAdd(result, x2, Detail::SinCoefficient1);
+    result = XMVectorMultiplyAdd(result, x2, g_XMOne.v);
+    *sines = XMVectorMultiply(result, x);
+
+    // Degree 10 even polynomial for cosine.
+    const XMVECTOR cc = Detail::CosCoefficients0;
+    result = XMVectorSplatX(cc);
+    result = XMVectorMultiplyAdd(result, x2, XMVectorSplatY(cc));
+    result = XMVectorMultiplyAdd(result, x2, XMVectorSplatZ(cc));
+    result = XMVectorMultiplyAdd(result, x2, XMVectorSplatW(cc));
+    result = XMVectorMultiplyAdd(result, x2, g_XMNegativeOneHalf.v);
+    result = XMVectorMultiplyAdd(result, x2, g_XMOne.v);
+    *cosines = XMVectorMultiply(result, cosineSign);
+}
+
+// Four-quadrant arctangent of y/x in [-Pi,Pi].
+inline DirectX::XMVECTOR XM_CALLCONV Atan2(DirectX::FXMVECTOR y, DirectX::FXMVECTOR x)
+{
+    using namespace DirectX;
+
+    // Reduce to atan(t) with t = min(|x|,|y|) / max(|x|,|y|) in [0,1].
+    XMVECTOR absX = XMVectorAbs(x);
+    XMVECTOR absY = XMVectorAbs(y);
+    XMVECTOR numerator = XMVectorMin(absX, absY);
+    XMVECTOR denominator = XMVectorMax(absX, absY);
+    XMVECTOR t = XMVectorDivide(numerator, denominator);
+    t = XMVectorSelect(t, g_XMZero.v, XMVectorEqual(denominator, g_XMZero.v));
+
+    // Degree 17 odd polynomial (Abramowitz and Stegun 4.4.49).
+    XMVECTOR t2 = XMVectorMultiply(t, t);
+    const XMVECTOR a0 = Detail::AtanCoefficients0;
+    const XMVECTOR a1 = Detail::AtanCoefficients1;
+    XMVECTOR result = XMVectorSplatX(a0);
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatY(a0));
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatZ(a0));
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatW(a0));
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatX(a1));
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatY(a1));
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatZ(a1));
+    result = XMVectorMultiplyAdd(result, t2, XMVectorSplatW(a1));
+    result = XMVectorMultiplyAdd(result, t2, g_XMOne.v);
+    result = XMVectorMultiply(result, t);
+
+    // Undo the reduction: swap octants, mirror into the left half-plane, then take the sign of y.
+    result = XMVectorSelect(result, XMVectorSubtract(g_XMHalfPi.v, result), XMVectorGreater(absY, absX));
+    result = XMVectorSelect(result, XMVectorSubtract(g_XMPi.v, result), XMVectorLess(x, g_XMZero.v));
+    return XMVectorOrInt(result, XMVectorAndInt(y, g_XMNegativeZero.v));
+}
+
+// 1/sqrt(v) from the hardware estimate refined with one Newton-Raphson step; 0 for v == 0.
+inline DirectX::XMVECTOR XM_CALLCONV ReciprocalSqrt(DirectX::FXMVECTOR v)
+{
+    using namespace DirectX;
+
+    XMVECTOR estimate = XMVectorReciprocalSqrtEst(v);
+
+    // r' = r * (1.5 - 0.5 * v * r * r)
+    XMVECTOR halfV = XMVectorMultiply(v, g_XMOneHalf.v);
+    XMVECTOR correction = XMVectorNegativeMultiplySubtract(halfV, XMVectorMultiply(estimate, estimate), Detail::OneAndAHalf.v);
+    XMVECTOR result = XMVectorMultiply(estimate, correction);
+    return XMVectorSelect(result, g_XMZero.v, XMVectorLessOrEqual(v, g_XMZero.v));
+}
+
+// Scalar forms of the kernels above.
+inline void SinCos(float angle, float* sine, float* cosine)
+{
+    DirectX::XMVECTOR sines, cosines;
+    SinCos(DirectX::XMVectorReplicate(angle), &sines, &cosines);
+    *sine = DirectX::XMVectorGetX(sines);
+    *cosine = DirectX::XMVectorGetX(cosines);
+}
+
+inline float Atan2(float y, float x)
+{
+    return DirectX::XMVectorGetX(Atan2(DirectX::XMVectorReplicate(y), DirectX::XMVectorReplicate(x)));
+}
+
+inline float ReciprocalSqrt(float value)
+{
+    return DirectX::XMVectorGetX(ReciprocalSqrt(DirectX::XMVectorReplicate(value)));
+}
+
+inline float Length(DirectX::SimpleMath::Vector2 v)
+{
+    auto lengthSquared = v.LengthSquared();
+    return lengthSquared * ReciprocalSqrt(lengthSquared);
+}
+
+inline DirectX::SimpleMath::Vector2 Normalize(DirectX::SimpleMath::Vector2 v)
+{
+    return v * ReciprocalSqrt(v.LengthSquared());
+}
+
+// Batch entry points over structure-of-arrays data. Inputs and outputs may alias element for element.
+void SinCosBatch(const float* angles, float* sines, float* cosines, size_t count);
+void Atan2Batch(const float* y, const float* x, float* angles, size_t count);
+void LengthBatch(const float* x, const float* y, float* lengths, size_t count);
+void NormalizeBatch(float* x, float* y, size_t count);
+
+// Microbenchmark of the batch entry points against the C runtime versions of the same math.
+void RunBenchmarks(std::wostream& output);
+}
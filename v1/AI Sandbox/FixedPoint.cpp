@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "FixedPoint.h"
+
+using namespace FixedPoint;
+
+namespace
+{
+// xxHash64 primes
+const uint64_t HashPrime1 = 11400714785074694791ull;
+const uint64_t HashPrime2 = 14029467366897019727ull;
+const uint64_t HashPrime3 = 1609587929392839161ull;
+const uint64_t HashPrime4 = 9650029242287828579ull;
+const uint64_t HashPrime5 = 2870177450012600261ull;
+
+uint64_t RotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t Read64(const uint8_t* bytes)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+uint32_t Read32(const uint8_t* bytes)
+{
+    return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+}
+
+uint64_t HashRound(uint64_t accumulator, uint64_t input)
+{
+    return RotateLeft(accumulator + input * HashPrime2, 31) * HashPrime1;
+}
+
+uint64_t HashMerge(uint64_t hash, uint64_t accumulator)
+{
+    return (hash ^ HashRound(0, accumulator)) * HashPrime1 + HashPrime4;
+}
+
+// CORDIC works in Q2.30, with inputs pre-shifted so small vectors keep their precision.
+const int CordicFractionBits = 30;
+const int CordicIterations = 30;
+const int CordicInputShift = 24;
+
+// atan(2^-i) in Q2.30. These literals are the table; nothing is computed with floating point.
+const int64_t CordicAngles[CordicIterations] =
+{
+    843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851, 8388437,
+    4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768,
+    16384, 8192, 4096, 2048, 1024, 512, 256, 128,
+    64, 32, 16, 8, 4, 2
+};
+
+const int64_t CordicGainInverse = 652032874; // 1/K in Q2.30
+const int64_t CordicHalfPi = 1686629713;
+const int64_t CordicPi = 3373259426;
+
+// Sine over a quarter turn, in Q16.16, sampled at SineTableQuarter + 1 points.
+const int SineTableQuarter = 256;
+const int SineTableFull = SineTableQuarter * 4;
+
+struct SineTable
+{
+    int32_t values[SineTableQuarter + 1];
+
+    SineTable()
+    {
+        // Generate the table with CORDIC rotations so it is identical on every machine.
+        for (int i = 0; i <= SineTableQuarter; ++i)
+        {
+            int64_t x = CordicGainInverse;
+            int64_t y = 0;
+            int64_t z = (CordicHalfPi * i) / SineTableQuarter;
+
+            for (int j = 0; j < CordicIterations; ++j)
+            {
+                auto dx = y >> j;
+                auto dy = x >> j;
+                if (z >= 0)
+                {
+                    x -= dx;
+                    y += dy;
+                    z -= CordicAngles[j];
+                }
+                else
+                {
+                    x += dx;
+                    y -= dy;
+                    z += CordicAngles[j];
+                }
+            }
+
+            auto shift = CordicFractionBits - Fixed::FractionBits;
+            values[i] = int32_t((y + (int64_t(1) << (shift - 1))) >> shift);
+        }
+    }
+};
+
+const SineTable& GetSineTable()
+{
+    static const SineTable s_table;
+    return s_table;
+}
+
+// Sine at a whole table step in [0,SineTableFull].
+int32_t SineAtStep(int step)
+{
+    const auto& table = GetSineTable().values;
+    step %= SineTableFull;
+
+    auto quadrant = step / SineTableQuarter;
+    auto offset = step % SineTableQuarter;
+    switch (quadrant)
+    {
+    case 0: return table[offset];
+    case 1: return table[SineTableQuarter - offset];
+    case 2: return -table[offset];
+    default: return -table[SineTableQuarter - offset];
+    }
+}
+
+uint64_t IntegerSqrt(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit = uint64_t(1) << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return result;
+}
+}
+
+Fixed FixedPoint::Sqrt(Fixed value)
+{
+    if (value.raw <= 0)
+        return Fixed();
+
+    // sqrt(raw * 2^16) is the square root in Q16.16.
+    return Fixed::FromRaw(int64_t(IntegerSqrt(uint64_t(value.raw) << Fixed::FractionBits)));
+}
+
+Fixed FixedPoint::Length(const FixedVector2& v)
+{
+    // The sum of squares is in Q32.32; its square root is back in Q16.16.
+    auto x = int64_t(v.x.raw);
+    auto y = int64_t(v.y.raw);
+    return Fixed::FromRaw(int64_t(IntegerSqrt(uint64_t(x * x) + uint64_t(y * y))));
+}
+
+FixedVector2 FixedPoint::Normalize(const FixedVector2& v)
+{
+    auto length = Length(v);
+    if (length.raw == 0)
+        return FixedVector2();
+
+    return v / length;
+}
+
+Fixed FixedPoint::Sin(Fixed angle)
+{
+    // Wrap to [0,2Pi) and convert to table steps with 16 fractional bits for interpolation.
+    auto wrapped = int64_t(angle.raw) % TwoPi.raw;
+    if (wrapped < 0)
+    {
+        wrapped += TwoPi.raw;
+    }
+
+    auto position = (wrapped * SineTableFull * Fixed::OneRaw) / TwoPi.raw;
+    auto step = int(position >> Fixed::FractionBits);
+    auto fraction = position & (Fixed::OneRaw - 1);
+
+    auto a = int64_t(SineAtStep(step));
+    auto b = int64_t(SineAtStep(step + 1));
+    return Fixed::FromRaw(a + (((b - a) * fraction) >> Fixed::FractionBits));
+}
+
+Fixed FixedPoint::Cos(Fixed angle)
+{
+    return Sin(angle + HalfPi);
+}
+
+Fixed FixedPoint::Atan2(Fixed y, Fixed x)
+{
+    if (x.raw == 0 && y.raw == 0)
+        return Fixed();
+
+    int64_t cx = int64_t(x.raw) << CordicInputShift;
+    int64_t cy = int64_t(y.raw) << CordicInputShift;
+    int64_t z = 0;
+
+    // CORDIC vectoring converges for vectors in the right half-plane; rotate the left half by Pi.
+    if (cx < 0)
+    {
+        z = cy >= 0 ? CordicPi : -CordicPi;
+        cx = -cx;
+        cy = -cy;
+    }
+
+    for (int i = 0; i < CordicIterations; ++i)
+    {
+        auto dx = cy >> i;
+        auto dy = cx >> i;
+        if (cy > 0)
+        {
+            cx += dx;
+            cy -= dy;
+            z += CordicAngles[i];
+        }
+        else
+        {
+            cx -= dx;
+            cy += dy;
+            z -= CordicAngles[i];
+        }
+    }
+
+    auto shift = CordicFractionBits - Fixed::FractionBits;
+    return Fixed::FromRaw((z + (int64_t(1) << (shift - 1))) >> shift);
+}
+
+uint64_t FixedPoint::Hash(const void* data, size_t size, uint64_t seed)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    auto end = bytes + size;
+    uint64_t hash;
+
+    // 32-byte stripes into four lanes, then the tail 8, 4 and 1 bytes at a time.
+    if (size >= 32)
+    {
+        uint64_t lanes[4] = { seed + HashPrime1 + HashPrime2, seed + HashPrime2, seed, seed - HashPrime1 };
+        for (; end - bytes >= 32; bytes += 32)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                lanes[i] = HashRound(lanes[i], Read64(bytes + i * 8));
+            }
+        }
+
+        hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+        for (auto lane : lanes)
+        {
+            hash = HashMerge(hash, lane);
+        }
+    }
+    else
+    {
+        hash = seed + HashPrime5;
+    }
+
+    hash += uint64_t(size);
+    for (; end - bytes >= 8; bytes += 8)
+    {
+        hash = RotateLeft(hash ^ HashRound(0, Read64(bytes)), 27) * HashPrime1 + HashPrime4;
+    }
+    if (end - bytes >= 4)
+    {
+        hash = RotateLeft(hash ^ (Read32(bytes) * HashPrime1), 23) * HashPrime2 + HashPrime3;
+        bytes += 4;
+    }
+    for (; bytes < end; ++bytes)
+    {
+        hash = RotateLeft(hash ^ (*bytes * HashPrime5), 11) * HashPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= HashPrime2;
+    hash ^= hash >> 29;
+    hash *= HashPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,120 @@
+//
+// FixedPoint.h - Q16.16 fixed-point arithmetic with deterministic trig and square root
+//
+// Everything here uses integer arithmetic only, so results are bit-identical across compilers,
+// instruction sets and thread orderings. Defining FIXED_POINT_SIMULATION in the project's
+// preprocessor definitions (the ReleaseFixedPoint configuration does) switches the kinematic
+// pipeline (GameObject state, integration and steering) over to these types.
+//
+
+#pragma once
+
+namespace FixedPoint
+{
+struct Fixed
+{
+    static const int FractionBits = 16;
+    static const int32_t OneRaw = 1 << FractionBits;
+
+    int32_t raw;
+
+    Fixed() : raw(0) {}
+
+    static Fixed FromRaw(int64_t raw)
+    {
+        // Saturate rather than wrap, so overflow degrades gracefully and stays deterministic.
+        Fixed result;
+        result.raw = int32_t(std::max<int64_t>(INT32_MIN, std::min<int64_t>(INT32_MAX, raw)));
+        return result;
+    }
+
+    static Fixed FromInt(int32_t value) { return FromRaw(int64_t(value) << FractionBits); }
+
+    // Scaling by a power of two is exact, and the rounding below is fully specified by IEEE 754.
+    static Fixed FromFloat(float value) { return FromRaw(std::llround(double(value) * OneRaw)); }
+    float ToFloat() const { return float(double(raw) / OneRaw); }
+
+    Fixed operator-() const { return FromRaw(-int64_t(raw)); }
+
+    Fixed& operator+=(Fixed rhs) { *this = FromRaw(int64_t(raw) + rhs.raw); return *this; }
+    Fixed& operator-=(Fixed rhs) { *this = FromRaw(int64_t(raw) - rhs.raw); return *this; }
+    Fixed& operator*=(Fixed rhs) { *this = FromRaw((int64_t(raw) * rhs.raw + (OneRaw / 2)) >> FractionBits); return *this; }
+    Fixed& operator/=(Fixed rhs)
+    {
+        if (rhs.raw == 0)
+        {
+            *this = FromRaw(raw >= 0 ? INT32_MAX : INT32_MIN);
+        }
+        else
+        {
+            *this = FromRaw((int64_t(raw) * OneRaw) / rhs.raw);
+        }
+        return *this;
+    }
+
+    bool operator==(Fixed rhs) const { return raw == rhs.raw; }
+    bool operator!=(Fixed rhs) const { return raw != rhs.raw; }
+    bool operator<(Fixed rhs) const { return raw < rhs.raw; }
+    bool operator<=(Fixed rhs) const { return raw <= rhs.raw; }
+    bool operator>(Fixed rhs) const { return raw > rhs.raw; }
+    bool operator>=(Fixed rhs) const { return raw >= rhs.raw; }
+};
+
+inline Fixed operator+(Fixed lhs, Fixed rhs) { return lhs += rhs; }
+inline Fixed operator-(Fixed lhs, Fixed rhs) { return lhs -= rhs; }
+inline Fixed operator*(Fixed lhs, Fixed rhs) { return lhs *= rhs; }
+inline Fixed operator/(Fixed lhs, Fixed rhs) { return lhs /= rhs; }
+
+inline Fixed Abs(Fixed value) { return value.raw < 0 ? -value : value; }
+inline Fixed Min(Fixed a, Fixed b) { return a < b ? a : b; }
+inline Fixed Max(Fixed a, Fixed b) { return a > b ? a : b; }
+
+struct FixedVector2
+{
+    Fixed x;
+    Fixed y;
+
+    FixedVector2() {}
+    FixedVector2(Fixed x, Fixed y) : x(x), y(y) {}
+    explicit FixedVector2(DirectX::SimpleMath::Vector2 v) : x(Fixed::FromFloat(v.x)), y(Fixed::FromFloat(v.y)) {}
+
+    DirectX::SimpleMath::Vector2 ToVector2() const { return DirectX::SimpleMath::Vector2(x.ToFloat(), y.ToFloat()); }
+
+    FixedVector2 operator-() const { return FixedVector2(-x, -y); }
+    FixedVector2& operator+=(const FixedVector2& rhs) { x += rhs.x; y += rhs.y; return *this; }
+    FixedVector2& operator-=(const FixedVector2& rhs) { x -= rhs.x; y -= rhs.y; return *this; }
+    FixedVector2& operator*=(Fixed s) { x *= s; y *= s; return *this; }
+    FixedVector2& operator/=(Fixed s) { x /= s; y /= s; return *this; }
+
+    bool IsZero() const { return x.raw == 0 && y.raw == 0; }
+};
+
+inline FixedVector2 operator+(FixedVector2 lhs, const FixedVector2& rhs) { return lhs += rhs; }
+inline FixedVector2 operator-(FixedVector2 lhs, const FixedVector2& rhs) { return lhs -= rhs; }
+inline FixedVector2 operator*(FixedVector2 lhs, Fixed s) { return lhs *= s; }
+inline FixedVector2 operator/(FixedVector2 lhs, Fixed s) { return lhs /= s; }
+
+// Constants
+const Fixed Pi = Fixed::FromRaw(205887);
+const Fixed HalfPi = Fixed::FromRaw(102944);
+const Fixed TwoPi = Fixed::FromRaw(411775);
+
+// Square root, exact to the last bit (rounded down).
+Fixed Sqrt(Fixed value);
+
+// Vector length computed with a 64-bit intermediate, so it does not overflow for any representable vector.
+Fixed Length(const FixedVector2& v);
+
+// Returns the zero vector when v is zero.
+FixedVector2 Normalize(const FixedVector2& v);
+
+// Table-based sine and cosine with linear interpolation (absolute error below 5e-5).
+Fixed Sin(Fixed angle);
+Fixed Cos(Fixed angle);
+
+// CORDIC arctangent in the range [-Pi,Pi] (absolute error below 2e-5); Atan2(0,0) is 0.
+Fixed Atan2(Fixed y, Fixed x);
+
+// xxHash64 of a byte range, for hashing quantized simulation state. Multi-byte values are read little-endian.
+uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+}
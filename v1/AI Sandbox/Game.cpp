@@ -4,11 +4,11 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 #include "RandomHelper.h"
+#include "WicTextureDecoder.h"
 
-// Behavior modules
-#include "FollowBehavior.h"
-#include "PlayerInput.h"
+#include <sstream>
 
 extern void ExitGame();
 
@@ -19,18 +19,89 @@ using namespace Helper;
 
 using Microsoft::WRL::ComPtr;
 
+namespace
+{
+std::wstring GetLocalFilePath(const wchar_t* fileName)
+{
+    return std::wstring(Windows::Storage::ApplicationData::Current->LocalFolder->Path->Data()) + L"\\" + fileName;
+}
+
+// One line of count, mean, p50, p95, p99 and max, with values multiplied by scale (to change units).
+void WriteHistogramSummary(std::ostream& output, const char* name, const Histogram& histogram, double scale)
+{
+    output << name << ": count " << histogram.GetCount() << ", mean " << histogram.GetMean() * scale
+        << ", p50 " << histogram.GetPercentile(50.0) * scale << ", p95 " << histogram.GetPercentile(95.0) * scale
+        << ", p99 " << histogram.GetPercentile(99.0) * scale << ", max " << histogram.GetMax() * scale << "\n";
+}
+}
+
 Game::Game() noexcept(false) :
-    m_showDebugInfo(true)
+    m_catchUpWindow(&m_timer.GetCatchUpUpdates()),
+    m_exitRequested(false),
+    m_frameIntervalWindow(&m_timer.GetFrameIntervals()),
+    m_metrics(MetricsRegistry::Default()),
+    m_renderDurationWindow(&m_timer.GetRenderDurations()),
+    m_screenViewport(),
+    m_showDebugInfo(true),
+    m_simulationRunning(false),
+    m_updateDurationWindow(&m_timer.GetUpdateDurations())
 {
     RandomInit();
-    LoadConfigFile();
+
+    // Settings come from Config.txt in the local folder, which is created with the defaults if missing.
+    m_configFilePath = GetLocalFilePath(L"Config.txt");
+
+    ConfigFile config;
+    std::string configError;
+    bool hasConfig = config.Load(m_configFilePath, &configError);
+    if (hasConfig)
+    {
+        config.Apply();
+    }
+    else if (!std::ifstream(m_configFilePath))
+    {
+        std::ofstream output(m_configFilePath);
+        ConfigFile::Write(output, config.GetArchetypes());
+    }
+    else
+    {
+        OutputDebugStringA(("Config file not applied: " + configError + "\n").c_str());
+    }
 
     m_deviceResources = std::make_unique<DX::DeviceResources>();
     m_deviceResources->RegisterDeviceNotify(this);
 
     m_inputResources = std::make_unique<InputResources>();
 
-    m_world = std::make_unique<World>();
+    m_world = std::make_unique<World>(WorldParameters(), &MetricsRegistry::Default());
+    if (hasConfig)
+    {
+        m_world->GetArchetypes()->Apply(config.GetArchetypes());
+    }
+}
+
+Game::~Game()
+{
+    StopSimulationThread();
+    m_configWatcher.Stop();
+    m_inputRecorder.End();
+
+    if (m_metrics.GetSampleCount() > 0)
+    {
+        std::ofstream csv(GetLocalFilePath(L"Metrics.csv"));
+        m_metrics.WriteCsv(csv);
+        std::ofstream json(GetLocalFilePath(L"Metrics.json"));
+        m_metrics.WriteJson(json);
+    }
+
+    if (m_timer.GetUpdateDurations().GetCount() > 0)
+    {
+        std::ofstream frameTimes(GetLocalFilePath(L"FrameTimes.txt"));
+        WriteHistogramSummary(frameTimes, "update ms", m_timer.GetUpdateDurations(), 1e-6);
+        WriteHistogramSummary(frameTimes, "catch-up updates per tick", m_timer.GetCatchUpUpdates(), 1.0);
+        WriteHistogramSummary(frameTimes, "render ms", m_timer.GetRenderDurations(), 1e-6);
+        WriteHistogramSummary(frameTimes, "frame interval ms", m_timer.GetFrameIntervals(), 1e-6);
+    }
 }
 
 // Initialize the Direct3D resources required to run.
@@ -45,43 +116,158 @@ void Game::Initialize(IUnknown* window, int width, int height, DXGI_MODE_ROTATIO
     CreateWindowSizeDependentResources();
 
     m_inputResources->CreateInputResources(window);
+    m_screenViewport = m_deviceResources->GetScreenViewport();
 
-    // 60 FPS fixed timestep update logic
+    // Fixed timestep update logic (Game_UpdateRate updates per second; rendering blends between them)
     m_timer.SetFixedTimeStep(true);
-    m_timer.SetTargetElapsedSeconds(1.0 / 60);
+    m_timer.SetTargetElapsedSeconds(1.0 / std::max(1.f, Game_UpdateRate));
+    m_timer.SetMaxUpdatesPerTick(uint32_t(Game_MaxCatchUpUpdates));
+    m_timer.SetMaxCatchUpSeconds(Game_MaxCatchUpSeconds);
 
     auto device = m_deviceResources->GetD3DDevice();
-    auto viewport = m_deviceResources->GetScreenViewport();
 
-    // Setup world and its initial teams and players
-    m_world->SetWorldBoundary(Vector2(viewport.Width, viewport.Height));
+    // Setup world and its initial teams and players (InputReplay::Begin builds the same world)
     m_world->CreateTeam();
-
-    auto humanPlayer = std::make_shared<GameObject>(Vector2(viewport.Width / 2.f, viewport.Height / 2.f), device);
-    auto playerInputModule = std::make_shared<PlayerInput>(m_inputResources.get());
-    humanPlayer->AddBehaviorModule(playerInputModule);
-    m_world->AddPlayer(humanPlayer, 0);
+    ExecuteInputCommand(m_world.get(), m_inputResources.get(),
+        { InputCommandType::SpawnPlayer, m_world->GetWorldBoundary() / 2.f }, device);
 
     // Create (empty) second team, for AI agents
     m_world->CreateTeam();
+
+    UpdateView();
+
+    if (Game_RecordInput)
+    {
+        m_inputRecordingFile.open(GetLocalFilePath(L"InputRecording.bin"), std::ios::binary | std::ios::trunc);
+        if (m_inputRecordingFile)
+        {
+            InputRecordingHeader header;
+            header.seed = GetRandomSeed();
+            header.timeStep = m_timer.GetTargetElapsedSeconds();
+            header.viewSize = Vector2(m_screenViewport.Width, m_screenViewport.Height);
+
+            // The configuration as applied, so InputReplay::Begin starts from the same settings and archetypes.
+            std::ostringstream config;
+            ConfigFile::Write(config, *m_world->GetArchetypes());
+            header.config = config.str();
+
+            m_inputRecorder.Begin(&m_inputRecordingFile, header);
+        }
+    }
+    else
+    {
+        // Live changes are not part of the input recording, so they would make a recorded session diverge on replay.
+        m_configWatcher.Start(m_configFilePath, Game_ConfigPollInterval);
+    }
+
+    StartSimulationThread();
 }
 
 #pragma region Frame Update
 // Executes the basic game loop.
 void Game::Tick()
 {
+    // With a simulation thread, this thread only renders.
+    if (!m_simulationThread.joinable())
+    {
+        RunSimulationStep();
+    }
+
+    if (m_exitRequested)
+    {
+        ExitGame();
+        return;
+    }
+
+    Render();
+}
+
+// Runs as many updates as are due, then hands the result to the renderer.
+void Game::RunSimulationStep()
+{
+    // Configuration changes land between updates, never during one.
+    auto config = m_configWatcher.TakePending();
+    if (config)
+    {
+        ApplyConfig(*config);
+    }
+
+    auto frameCount = m_timer.GetFrameCount();
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
     });
 
-    Render();
+    if (m_timer.GetFrameCount() != frameCount)
+    {
+        PublishRenderSnapshot();
+    }
+}
+
+// Body of the simulation thread.
+void Game::RunSimulation()
+{
+    Profiler::SetThreadName("Simulation");
+
+    while (m_simulationRunning)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_simulationMutex);
+            RunSimulationStep();
+        }
+
+        // Sleep until the next fixed step is due.
+        auto ticksUntilNextUpdate = m_timer.GetTicksUntilNextUpdate();
+        if (ticksUntilNextUpdate > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(ticksUntilNextUpdate / (DX::StepTimer::TicksPerSecond / 1000000)));
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Game::StartSimulationThread()
+{
+    if (!Game_SimulationThread || m_simulationThread.joinable())
+        return;
+
+    m_timer.ResetElapsedTime();
+    m_simulationRunning = true;
+    m_simulationThread = std::thread([this]() { RunSimulation(); });
+}
+
+void Game::StopSimulationThread()
+{
+    if (!m_simulationThread.joinable())
+        return;
+
+    m_simulationRunning = false;
+    m_simulationThread.join();
+}
+
+// Applies a changed configuration file to the running game.
+void Game::ApplyConfig(const ConfigFile& config)
+{
+    config.Apply();
+
+    m_timer.SetMaxUpdatesPerTick(uint32_t(Game_MaxCatchUpUpdates));
+    m_timer.SetMaxCatchUpSeconds(Game_MaxCatchUpSeconds);
+
+    // The world's parameters start from the Config values; its objects see archetype changes through their tables.
+    m_world->SetParameters(WorldParameters());
+    m_world->GetArchetypes()->Apply(config.GetArchetypes());
+    UpdateView();
 }
 
 // Updates the world.
 void Game::Update(DX::StepTimer const& timer)
 {
     PIXBeginEvent(PIX_COLOR_DEFAULT, L"Update");
+    PROFILE_ZONE("Game::Update");
 
     float elapsedTime = float(timer.GetElapsedSeconds());
 
@@ -94,19 +280,8 @@ void Game::Update(DX::StepTimer const& timer)
 
     if (kbTracker.pressed.Escape)
     {
-        ExitGame();
-    }
-
-    if (kbTracker.pressed.Space)
-    {
-        // Create new agent.
-        auto viewport = m_deviceResources->GetScreenViewport();
-        auto agent = std::make_shared<GameObject>(RandomScreenPosition(viewport), device);
-        agent->CreateTexture(m_deviceResources->GetD3DDevice());
-        agent->SetTextureTint(Colors::Red.v);
-        auto followModule = std::make_shared<FollowBehavior>(m_world->GetPlayer(0, 0));
-        agent->AddBehaviorModule(followModule);
-        m_world->AddPlayer(agent, 1);
+        // Exit from the window's thread, which may not be this one.
+        m_exitRequested = true;
     }
 
     if (kbTracker.pressed.OemTilde)
@@ -115,40 +290,134 @@ void Game::Update(DX::StepTimer const& timer)
         m_showDebugInfo = !m_showDebugInfo;
     }
 
-    m_world->Update(elapsedTime);
+    if (kbTracker.pressed.F9)
+    {
+        // Toggle profiling; stopping writes the recording to ProfilerTrace.json in the local folder.
+        if (Profiler::IsRecording())
+        {
+            Profiler::Stop();
+            std::ofstream trace(GetLocalFilePath(L"ProfilerTrace.json"));
+            Profiler::WriteChromeTrace(trace);
+        }
+        else
+        {
+            Profiler::Start();
+        }
+    }
+
+    // Turn input into world commands. Everything that changes the world from outside goes through the
+    // frame, so a recording of the frames replays the session exactly (see InputReplay).
+    m_inputFrame.keyboard = kbTracker.GetLastState();
+    m_inputFrame.mouse = mouseTracker.GetLastState();
+    m_inputFrame.viewSize = Vector2(m_screenViewport.Width, m_screenViewport.Height);
+    m_inputFrame.commands.clear();
+
+    if (kbTracker.pressed.Space)
+    {
+        // Create new agent.
+        m_inputFrame.commands.push_back({ InputCommandType::SpawnAgent, m_world->ScreenToWorld(RandomScreenPosition(m_screenViewport)) });
+    }
 
     if (mouseTracker.leftButton == ButtonState::PRESSED)
     {
         if (!m_world->GetPlayer(0, 0))
         {
             // No player on team 0...create one that's human-controlled!
-            auto mouseState = mouseTracker.GetLastState();
-            auto mousePos = Vector2(float(mouseState.x), float(mouseState.y));
-            auto humanPlayer = std::make_shared<GameObject>(mousePos, device);
-            auto playerInputModule = std::make_shared<PlayerInput>(m_inputResources.get());
-            humanPlayer->AddBehaviorModule(playerInputModule);
-            m_world->AddPlayer(humanPlayer, 0);
+            auto mousePos = m_world->ScreenToWorld(Vector2(float(m_inputFrame.mouse.x), float(m_inputFrame.mouse.y)));
+            m_inputFrame.commands.push_back({ InputCommandType::SpawnPlayer, mousePos });
         }
     }
     else if (mouseTracker.middleButton == ButtonState::PRESSED)
     {
-        m_world->RemoveAllPlayers(1); // remove all team 1 players
+        m_inputFrame.commands.push_back({ InputCommandType::RemoveAllAgents, Vector2::Zero }); // remove all team 1 players
     }
     else if (mouseTracker.rightButton == ButtonState::PRESSED)
     {
-        m_world->RemovePlayer(m_world->GetPlayer(0, 0)); // a test...
+        m_inputFrame.commands.push_back({ InputCommandType::RemovePlayer, Vector2::Zero }); // a test...
+    }
+
+    m_inputRecorder.Write(m_inputFrame);
+
+    for (const auto& command : m_inputFrame.commands)
+    {
+        ExecuteInputCommand(m_world.get(), m_inputResources.get(), command, device);
+    }
+
+    UpdateView();
+    m_world->Update(elapsedTime);
+
+    if (Game_MetricsSampleInterval > 0 && timer.GetFrameCount() % uint32_t(Game_MetricsSampleInterval) == 0)
+    {
+        m_metrics.Sample(timer.GetFrameCount());
     }
 
     PIXEndEvent();
 }
+
+// Centers the view on the human player, keeping it inside the world.
+void Game::UpdateView()
+{
+    m_world->CenterView(Vector2(m_screenViewport.Width, m_screenViewport.Height));
+}
+
+// Records the world as it is after the latest update, for the renderer.
+void Game::PublishRenderSnapshot()
+{
+    auto& snapshot = m_renderSnapshots.GetWriteBuffer();
+    snapshot.Clear();
+
+    m_world->Render(&snapshot);
+
+    if (m_showDebugInfo)
+    {
+        auto viewOrigin = m_world->GetViewOrigin();
+        auto viewMax = viewOrigin + m_world->GetViewSize();
+        snapshot.debugGeometry.SetCategoryMask(uint32_t(Game_DebugCategories));
+        snapshot.debugGeometry.SetCullBounds(viewOrigin, viewMax);
+        m_world->RenderDebugInfo(&snapshot.debugGeometry);
+
+        // Readouts for the human players, each shown while its sprite is on screen (which Render decides, as
+        // it blends them).
+        for (const auto& player : m_world->GetTeam(0))
+        {
+            PlayerStatus status;
+            status.position = player->GetPosition();
+            status.previousPosition = player->GetPreviousPosition();
+            status.acceleration = player->GetAcceleration().Length();
+            status.maxAcceleration = player->GetMaxAcceleration();
+            status.maxSpeed = player->GetMaxSpeed();
+            status.speed = player->GetSpeed();
+            snapshot.playerStatus.push_back(status);
+        }
+    }
+
+    snapshot.showDebugInfo = m_showDebugInfo;
+    snapshot.simulationTicksPerSecond = m_timer.GetFramesPerSecond();
+    snapshot.timeDilation = float(m_timer.GetTimeDilation());
+    snapshot.droppedUpdates = m_timer.GetDroppedUpdates();
+    snapshot.updateCount = m_timer.GetFrameCount();
+    snapshot.interpolationAlpha = m_timer.GetInterpolationAlpha();
+    snapshot.publishTime = std::chrono::steady_clock::now();
+    snapshot.updateSeconds = Game_InterpolateRendering ? m_timer.GetTargetElapsedSeconds() : 0.0;
+
+    m_renderSnapshots.Publish();
+}
 #pragma endregion
 
 #pragma region Frame Render
-// Draws the scene.
+// Draws the most recently completed update.
 void Game::Render()
 {
+    PROFILE_ZONE("Game::Render");
+
+    m_timer.BeginFrame();
+    UpdateFrameTimeWindows();
+
+    m_renderSnapshots.Acquire();
+    const auto& snapshot = m_renderSnapshots.GetReadBuffer();
+
     // Don't try to render anything before the first Update.
-    if (m_timer.GetFrameCount() == 0)
+    if (snapshot.updateCount == 0)
     {
         return;
     }
@@ -158,25 +427,80 @@ void Game::Render()
     auto context = m_deviceResources->GetD3DDeviceContext();
     PIXBeginEvent(context, PIX_COLOR_DEFAULT, L"Render");
 
+    // Objects and the view are drawn blended between the last two updates, by how far time has run towards
+    // the next, so motion is smooth at any update rate.
+    auto alpha = snapshot.GetInterpolationAlpha(std::chrono::steady_clock::now());
+
+    // World space is offset from screen space by the view origin.
+    auto viewOrigin = Vector2::Lerp(snapshot.previousViewOrigin, snapshot.viewOrigin, alpha);
+    auto view = Matrix::CreateTranslation(-viewOrigin.x, -viewOrigin.y, 0.f);
+
     // Render SpriteBatch objects.
-    m_spriteBatch->Begin();
+    m_spriteBatch->Begin(SpriteSortMode_Deferred, nullptr, nullptr, nullptr, nullptr, nullptr, view);
 
-    m_world->Render(m_spriteBatch.get());
+    // SpriteBatch draws each run of sprites with the same texture in one call, and the objects share their
+    // textures through the cache, so a crowd costs a handful of draws rather than one per sprite.
+    for (const auto& sprite : snapshot.sprites)
+    {
+        if (sprite.texture >= snapshot.textures.size())
+            continue;
 
-    if (m_showDebugInfo)
+        Vector2 position;
+        float rotation;
+        sprite.Interpolate(alpha, &position, &rotation);
+
+        const auto& texture = *snapshot.textures[sprite.texture];
+        m_spriteBatch->Draw(WicTextureDecoder::GetShaderResourceView(texture), position, nullptr, UnpackColor(sprite.tint), rotation, texture.origin);
+    }
+
+    m_spriteBatch->End();
+
+    m_spriteBatch->Begin();
+
+    if (snapshot.showDebugInfo)
     {
-        for (const auto& player : m_world->GetTeam(0))
+        // Formatted into a fixed buffer, so drawing the debug info does not allocate every frame.
+        wchar_t text[160];
+
+        auto viewMax = viewOrigin + snapshot.viewSize;
+        for (const auto& status : snapshot.playerStatus)
         {
+            auto position = Vector2::Lerp(status.previousPosition, status.position, alpha);
+            if (position.x < viewOrigin.x || position.y < viewOrigin.y || position.x > viewMax.x || position.y > viewMax.y)
+                continue;
+
             Vector2 textPos(10.f);
-            std::wstring text;
 
-            text = L"Speed: " + std::to_wstring(player->GetSpeed()) + L" / " + std::to_wstring(player->GetMaxSpeed());
-            m_fontDebugInfo->DrawString(m_spriteBatch.get(), text.c_str(), textPos);
+            swprintf_s(text, L"Speed: %f / %f", status.speed, status.maxSpeed);
+            m_fontDebugInfo->DrawString(m_spriteBatch.get(), text, textPos);
 
             textPos.y += 20.f;
-            text = L"Accel: " + std::to_wstring(player->GetAcceleration().Length()) + L" / " + std::to_wstring(player->GetMaxAcceleration());
-            m_fontDebugInfo->DrawString(m_spriteBatch.get(), text.c_str(), textPos);
+            swprintf_s(text, L"Accel: %f / %f", status.acceleration, status.maxAcceleration);
+            m_fontDebugInfo->DrawString(m_spriteBatch.get(), text, textPos);
         }
+
+        const auto& partitionStats = snapshot.partitionStats;
+        Vector2 textPos(10.f, 50.f);
+        swprintf_s(text, L"Chunks: %zu / %zu  Agents: %zu visible, %zu active, %zu dormant", partitionStats.activeChunkCount,
+            partitionStats.chunkCount, snapshot.visibleObjectCount, partitionStats.activeObjectCount, partitionStats.dormantObjectCount);
+        m_fontDebugInfo->DrawString(m_spriteBatch.get(), text, textPos);
+
+        textPos.y += 20.f;
+        swprintf_s(text, L"Updates/s: %u  Time dilation: %f  Dropped updates: %llu", snapshot.simulationTicksPerSecond,
+            snapshot.timeDilation, static_cast<unsigned long long>(snapshot.droppedUpdates));
+        m_fontDebugInfo->DrawString(m_spriteBatch.get(), text, textPos);
+
+        // Last second's tails, in milliseconds.
+        const auto& frameIntervals = m_frameIntervalWindow.GetLast();
+        const auto& renderDurations = m_renderDurationWindow.GetLast();
+        const auto& updateDurations = m_updateDurationWindow.GetLast();
+        textPos.y += 20.f;
+        swprintf_s(text, L"Frame p50/p99/max: %.2f / %.2f / %.2f  Render p99: %.2f  Update p99: %.2f  Catch-up max: %llu",
+            frameIntervals.GetPercentile(50.0) * 1e-6, frameIntervals.GetPercentile(99.0) * 1e-6,
+            frameIntervals.GetPercentile(100.0) * 1e-6, renderDurations.GetPercentile(99.0) * 1e-6,
+            updateDurations.GetPercentile(99.0) * 1e-6,
+            static_cast<unsigned long long>(m_catchUpWindow.GetLast().GetPercentile(100.0)));
+        m_fontDebugInfo->DrawString(m_spriteBatch.get(), text, textPos);
     }
 
     m_spriteBatch->End();
@@ -186,29 +510,45 @@ void Game::Render()
     context->OMSetDepthStencilState(m_commonStates->DepthNone(), 0);
     context->RSSetState(m_commonStates->CullNone());
 
+    m_basicEffect->SetView(view);
     m_basicEffect->Apply(context);
     context->IASetInputLayout(m_inputLayout.Get());
 
     m_primitiveBatch->Begin();
 
-    if (m_showDebugInfo)
+    if (snapshot.showDebugInfo)
     {
-        for (const auto& player : m_world->GetTeam(0))
-        {
-            player->RenderDebugInfo(m_primitiveBatch.get());
-        }
+        snapshot.debugGeometry.Render(m_primitiveBatch.get(), alpha);
     }
 
     m_primitiveBatch->End();
 
     PIXEndEvent(context);
+    m_timer.EndFrame();
 
     // Show the new frame.
     PIXBeginEvent(PIX_COLOR_DEFAULT, L"Present");
-    m_deviceResources->Present();
+    {
+        PROFILE_ZONE("Present");
+        m_deviceResources->Present();
+    }
     PIXEndEvent();
 }
 
+// Closes the last second's frame time windows once a second.
+void Game::UpdateFrameTimeWindows()
+{
+    auto now = DX::StepTimer::Clock::now();
+    if (now - m_frameTimeWindowStart < std::chrono::seconds(1))
+        return;
+
+    m_catchUpWindow.Advance();
+    m_frameIntervalWindow.Advance();
+    m_renderDurationWindow.Advance();
+    m_updateDurationWindow.Advance();
+    m_frameTimeWindowStart = now;
+}
+
 // Helper method to clear the back buffers.
 void Game::Clear()
 {
@@ -245,6 +585,14 @@ void Game::OnDeactivated()
 
 void Game::OnSuspending()
 {
+    StopSimulationThread();
+
+    // The app may be terminated while suspended, so make sure the recording so far is on disk.
+    if (m_inputRecorder.IsRecording())
+    {
+        m_inputRecordingFile.flush();
+    }
+
     auto context = m_deviceResources->GetD3DDeviceContext();
     context->ClearState();
 
@@ -257,6 +605,8 @@ void Game::OnResuming()
 {
     m_timer.ResetElapsedTime();
     m_inputResources->Resume();
+
+    StartSimulationThread();
 }
 
 void Game::OnWindowSizeChanged(int width, int height, DXGI_MODE_ROTATION rotation)
@@ -266,7 +616,9 @@ void Game::OnWindowSizeChanged(int width, int height, DXGI_MODE_ROTATION rotatio
 
     CreateWindowSizeDependentResources();
 
-    m_world->SetWorldBoundary(Vector2(float(width), float(height)));
+    std::lock_guard<std::mutex> lock(m_simulationMutex);
+    m_screenViewport = m_deviceResources->GetScreenViewport();
+    UpdateView();
 }
 
 void Game::ValidateDevice()
@@ -313,7 +665,9 @@ void Game::CreateDeviceDependentResources()
     m_fontDebugInfo = std::make_unique<SpriteFont>(device, L"Assets\\Consolas_12.spritefont");
     m_fontDebugInfo->SetDefaultCharacter(L'*');
 
-    m_world->CreateAllTextures(device);
+    // Textures are decoded for this device from now on.
+    TextureCache::Default().SetDecoder(std::make_unique<WicTextureDecoder>(device));
+    m_world->CreateAllTextures();
 }
 
 // Allocate all memory resources that change on a window SizeChanged event.
@@ -331,12 +685,17 @@ void Game::CreateWindowSizeDependentResources()
 
 void Game::OnDeviceLost()
 {
+    // Nothing may touch the world's textures, or hold on to them, until the device is restored.
+    StopSimulationThread();
+    m_renderSnapshots.Reset();
+
     m_commonStates.reset();
     m_spriteBatch.reset();
     m_basicEffect.reset();
     m_inputLayout.Reset();
 
     m_world->ResetAllTextures();
+    TextureCache::Default().SetDecoder(nullptr);
 }
 
 void Game::OnDeviceRestored()
@@ -344,5 +703,7 @@ void Game::OnDeviceRestored()
     CreateDeviceDependentResources();
 
     CreateWindowSizeDependentResources();
+
+    StartSimulationThread();
 }
 #pragma endregion
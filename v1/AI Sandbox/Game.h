@@ -4,9 +4,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "ConfigWatcher.h"
 #include "DeviceResources.h"
+#include "InputRecording.h"
 #include "InputResources.h"
+#include "Metrics.h"
+#include "RenderSnapshot.h"
 #include "StepTimer.h"
+#include "TripleBuffer.h"
 #include "World.h"
 
 // A basic game implementation that creates a D3D11 device and provides a game loop.
@@ -15,6 +25,7 @@ class Game : public DX::IDeviceNotify
 public:
 
     Game() noexcept(false);
+    ~Game();
 
     // Initialization and management
     void Initialize(IUnknown* window, int width, int height, DXGI_MODE_ROTATION rotation);
@@ -39,17 +50,37 @@ public:
 
 private:
 
+    void ApplyConfig(const ConfigFile& config);
     void Update(DX::StepTimer const& timer);
+    void UpdateView();
     void Render();
+    void UpdateFrameTimeWindows();
+
+    // Simulation loop
+    void PublishRenderSnapshot();
+    void RunSimulation();
+    void RunSimulationStep();
+    void StartSimulationThread();
+    void StopSimulationThread();
 
     void Clear();
 
     void CreateDeviceDependentResources();
     void CreateWindowSizeDependentResources();
 
+    // Configuration
+    std::wstring                            m_configFilePath;
+    ConfigWatcher                           m_configWatcher;
+
     // I/O resources
+    InputFrame                              m_inputFrame; // this update's input, reused between updates
+    InputRecorder                           m_inputRecorder;
+    std::ofstream                           m_inputRecordingFile;
     std::unique_ptr<InputResources>         m_inputResources;
 
+    // Metrics
+    MetricsSampler                          m_metrics;
+
     // Rendering resources
     std::unique_ptr<DirectX::BasicEffect>       m_basicEffect;
     std::unique_ptr<DirectX::CommonStates>      m_commonStates;
@@ -59,7 +90,22 @@ private:
     std::unique_ptr<DirectX::PrimitiveBatch<DirectX::VertexPositionColor>>  m_primitiveBatch;
     bool                                        m_showDebugInfo;
     std::unique_ptr<DirectX::SpriteBatch>       m_spriteBatch;
-    DX::StepTimer                               m_timer;
+    TripleBuffer<RenderSnapshot>                m_renderSnapshots;
+
+    // Simulation
+    std::atomic<bool>                       m_exitRequested;
+    D3D11_VIEWPORT                          m_screenViewport; // copy of the device's viewport, for the simulation
+    std::mutex                              m_simulationMutex; // held by the simulation for each step
+    std::atomic<bool>                       m_simulationRunning;
+    std::thread                             m_simulationThread;
+    DX::StepTimer                           m_timer;
+
+    // Frame times over the last second, for the debug display (render thread only)
+    HistogramWindow                         m_catchUpWindow;
+    HistogramWindow                         m_frameIntervalWindow;
+    DX::StepTimer::Clock::time_point        m_frameTimeWindowStart;
+    HistogramWindow                         m_renderDurationWindow;
+    HistogramWindow                         m_updateDurationWindow;
 
     // World
     std::unique_ptr<World>                  m_world;
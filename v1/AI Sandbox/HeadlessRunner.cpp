@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "FollowBehavior.h"
+#include "HeadlessRunner.h"
+#include "RandomHelper.h"
+
+#include <chrono>
+#include <ostream>
+
+using namespace Config;
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+HeadlessRunOptions::HeadlessRunOptions() :
+    agentCount(100),
+    maxSimulatedSeconds(0.0),
+    maxTicks(60 * 60),
+    metricsSampleInterval(0),
+    parameters(),
+    playerPathRadius(500.f),
+    playerSpeed(0.f),
+    reportInterval(0),
+    scenario(),
+    seed(1),
+    spawnRadius(World_ActivationRadius),
+    timeStep(1.0 / 60)
+{
+}
+
+HeadlessRunner::HeadlessRunner(const HeadlessRunOptions& options) :
+    m_metrics(m_metricsRegistry),
+    m_options(options),
+    m_ticks(0)
+{
+    if (!m_options.scenario.empty())
+    {
+        ScenarioDescription description;
+        ScenarioGenerator::GetPreset(m_options.scenario, &description);
+        description.seed = m_options.seed;
+
+        m_scenario = std::make_unique<ScenarioGenerator>(description);
+        m_world = m_scenario->CreateWorld(m_options.parameters, nullptr, &m_metricsRegistry);
+        m_player = m_world->GetPlayer(0, 0);
+        return;
+    }
+
+    m_world = std::make_unique<World>(options.parameters, &m_metricsRegistry);
+
+    std::mt19937 random(m_options.seed);
+
+    m_world->CreateTeam();
+    m_world->CreateTeam();
+
+    const auto& archetypes = *m_world->GetArchetypes();
+    auto center = m_world->GetWorldBoundary() / 2.f;
+    m_player = std::make_shared<GameObject>(GetPlayerPathPosition(0.0), nullptr, archetypes);
+    m_world->AddPlayer(m_player, 0);
+
+    for (size_t i = 0; i < m_options.agentCount; ++i)
+    {
+        // Uniform over the spawn disk.
+        auto angle = Helper::RandomUnit(random) * XM_2PI;
+        auto distance = std::sqrt(Helper::RandomUnit(random)) * m_options.spawnRadius;
+        auto agent = std::make_shared<GameObject>(center + Vector2(std::cos(angle), std::sin(angle)) * distance, nullptr, archetypes);
+        agent->AddBehaviorModule(std::make_shared<FollowBehavior>(m_player));
+        m_world->AddPlayer(agent, 1);
+    }
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+}
+
+bool HeadlessRunner::ParseArguments(const std::vector<std::wstring>& arguments, HeadlessRunOptions* options)
+{
+    for (size_t i = 0; i + 1 < arguments.size(); ++i)
+    {
+        const auto& name = arguments[i];
+        const auto& value = arguments[i + 1];
+
+        try
+        {
+            if (name == L"--ticks")
+            {
+                options->maxTicks = std::stoull(value);
+            }
+            else if (name == L"--seconds")
+            {
+                options->maxSimulatedSeconds = std::stod(value);
+            }
+            else if (name == L"--step")
+            {
+                options->timeStep = std::stod(value);
+            }
+            else if (name == L"--agents")
+            {
+                options->agentCount = size_t(std::stoull(value));
+            }
+            else if (name == L"--spawn-radius")
+            {
+                options->spawnRadius = std::stof(value);
+            }
+            else if (name == L"--player-speed")
+            {
+                options->playerSpeed = std::stof(value);
+            }
+            else if (name == L"--player-path-radius")
+            {
+                options->playerPathRadius = std::stof(value);
+            }
+            else if (name == L"--seed")
+            {
+                options->seed = uint32_t(std::stoul(value));
+            }
+            else if (name == L"--report")
+            {
+                options->reportInterval = std::stoull(value);
+            }
+            else if (name == L"--metrics")
+            {
+                options->metricsSampleInterval = std::stoull(value);
+            }
+            else if (name == L"--scenario")
+            {
+                options->scenario = std::string(value.begin(), value.end()); // preset names are ASCII
+                ScenarioDescription description;
+                if (!ScenarioGenerator::GetPreset(options->scenario, &description))
+                    return false;
+            }
+            else
+            {
+                continue;
+            }
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        ++i;
+    }
+
+    // A seconds limit replaces the default tick limit unless ticks were given too.
+    if (options->maxSimulatedSeconds > 0.0 && std::find(arguments.begin(), arguments.end(), L"--ticks") == arguments.end())
+    {
+        options->maxTicks = 0;
+    }
+
+    return options->timeStep > 0.0 && (options->maxTicks > 0 || options->maxSimulatedSeconds > 0.0) &&
+        (options->playerSpeed == 0.f || options->playerPathRadius > 0.f);
+}
+
+HeadlessRunResult HeadlessRunner::Run(std::wostream* report)
+{
+    using Clock = std::chrono::steady_clock;
+
+    HeadlessRunResult result = {};
+    auto start = Clock::now();
+
+    while (!IsFinished())
+    {
+        Step();
+
+        result.ticks = m_ticks;
+        result.simulatedSeconds = GetSimulatedSeconds();
+
+        if (report && m_options.reportInterval > 0 && result.ticks % m_options.reportInterval == 0)
+        {
+            result.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+            *report << L"tick " << result.ticks << L": " << result.simulatedSeconds << L" s simulated, "
+                << result.SimulatedSecondsPerWallSecond() << L" simulated s per wall s" << std::endl;
+        }
+    }
+
+    result.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.stateHash = m_world->ComputeStateHash();
+
+    if (report)
+    {
+        WriteHeadlessRunResult(*report, result);
+    }
+
+    return result;
+}
+
+void HeadlessRunner::Step()
+{
+    // Steer the player onto where its path will be at the end of this step; collisions may still push it off.
+    if (m_player && m_options.playerSpeed != 0.f)
+    {
+        auto target = GetPlayerPathPosition(double(m_ticks + 1) * m_options.timeStep);
+        m_player->SetVelocity((target - m_player->GetPosition()) / float(m_options.timeStep));
+    }
+
+    if (m_scenario)
+    {
+        m_scenario->Update(m_world.get());
+    }
+
+    m_world->Update(float(m_options.timeStep));
+    ++m_ticks;
+
+    if (m_options.metricsSampleInterval > 0 && m_ticks % m_options.metricsSampleInterval == 0)
+    {
+        m_metrics.Sample(m_ticks);
+    }
+}
+
+bool HeadlessRunner::IsFinished() const
+{
+    if (m_options.maxTicks > 0 && m_ticks >= m_options.maxTicks)
+        return true;
+    if (m_options.maxSimulatedSeconds > 0.0 && GetSimulatedSeconds() >= m_options.maxSimulatedSeconds)
+        return true;
+
+    return false;
+}
+
+Vector2 HeadlessRunner::GetPlayerPathPosition(double time) const
+{
+    auto center = m_world->GetWorldBoundary() / 2.f;
+    if (m_options.playerSpeed == 0.f)
+        return center;
+
+    // The angle is kept in double so long runs stay on the path.
+    auto angle = time * m_options.playerSpeed / m_options.playerPathRadius;
+    return center + Vector2(float(std::cos(angle)), float(std::sin(angle))) * m_options.playerPathRadius;
+}
+
+void WriteHeadlessRunResult(std::wostream& output, const HeadlessRunResult& result)
+{
+    output << L"ticks: " << result.ticks << L"\n"
+        << L"simulated seconds: " << result.simulatedSeconds << L"\n"
+        << L"wall seconds: " << result.wallSeconds << L"\n"
+        << L"simulated seconds per wall second: " << result.SimulatedSecondsPerWallSecond() << L"\n"
+        << L"state hash: " << std::hex << result.stateHash << std::dec << L"\n";
+}
@@ -0,0 +1,85 @@
+//
+// HeadlessRunner.h - runs a World as fast as possible, with no rendering, input or frame pacing
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+#include "Metrics.h"
+#include "ScenarioGenerator.h"
+#include "World.h"
+
+struct HeadlessRunOptions
+{
+    HeadlessRunOptions();
+
+    uint64_t        maxTicks;               // stop after this many updates (0 for no limit)
+    double          maxSimulatedSeconds;    // stop after this much simulated time (0 for no limit)
+    double          timeStep;               // seconds per update
+    size_t          agentCount;             // agents following the player
+    float           spawnRadius;            // meters around the player in which agents start
+    float           playerSpeed;            // meters per second along the player's path (0 to stand still)
+    float           playerPathRadius;       // meters; the player circles the world center at this distance
+    uint32_t        seed;
+    uint64_t        reportInterval;         // updates between progress lines (0 for none)
+    uint64_t        metricsSampleInterval;  // updates between samples of the run's metrics (0 for none)
+    std::string     scenario;               // ScenarioGenerator preset to run instead of the standard scenario (empty for none)
+    WorldParameters parameters;             // settings for the run's world
+};
+
+struct HeadlessRunResult
+{
+    uint64_t    ticks;
+    double      simulatedSeconds;
+    double      wallSeconds;
+    uint64_t    stateHash;              // World::ComputeStateHash at the end of the run
+
+    double SimulatedSecondsPerWallSecond() const { return wallSeconds > 0.0 ? simulatedSeconds / wallSeconds : 0.0; }
+};
+
+// Sets up the standard scenario (one player on team 0, optionally moving along a circle, followers on team 1)
+// and calls World::Update back to back with a fixed time step until the tick or simulated time limit is reached. Everything is seeded, so a
+// run is reproducible; with FIXED_POINT_SIMULATION the final state hash is identical on every machine.
+// With a scenario preset, the world comes from the ScenarioGenerator instead (seeded with the run's seed,
+// its team 0 leader being the player) and the agent count and spawn radius options do not apply.
+class HeadlessRunner
+{
+public:
+    HeadlessRunner(const HeadlessRunOptions& options);
+    ~HeadlessRunner();
+
+    // Parse "--ticks N", "--seconds S", "--step S", "--agents N", "--spawn-radius M", "--player-speed S",
+    // "--player-path-radius M", "--seed N", "--report N", "--metrics N" and "--scenario NAME" from a command line, ignoring
+    // anything else. Returns false if a value is malformed or there is no such scenario preset.
+    static bool ParseArguments(const std::vector<std::wstring>& arguments, HeadlessRunOptions* options);
+
+    HeadlessRunResult Run(std::wostream* report = nullptr);
+
+    // Move the player along its path and update the world once. Run calls this until a limit is reached;
+    // callers that measure the simulation as it goes can call it directly instead.
+    void Step();
+
+    bool IsFinished() const;
+    uint64_t GetTicks() const { return m_ticks; }
+    double GetSimulatedSeconds() const { return double(m_ticks) * m_options.timeStep; }
+
+    const MetricsSampler& GetMetrics() const { return m_metrics; }
+    GameObject* GetPlayer() { return m_player.get(); }
+    World* GetWorld() { return m_world.get(); }
+
+private:
+    DirectX::SimpleMath::Vector2 GetPlayerPathPosition(double time) const;
+
+    MetricsRegistry                     m_metricsRegistry; // the world reports here; before m_metrics, which samples it
+    MetricsSampler                      m_metrics;
+    HeadlessRunOptions                  m_options;
+    std::shared_ptr<GameObject>         m_player;
+    std::unique_ptr<ScenarioGenerator>  m_scenario;
+    uint64_t                            m_ticks;
+    std::unique_ptr<World>              m_world;
+};
+
+// Write a run's summary as "name: value" lines.
+void WriteHeadlessRunResult(std::wostream& output, const HeadlessRunResult& result);
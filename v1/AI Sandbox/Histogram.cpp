@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "Histogram.h"
+
+#include <cmath>
+
+const uint32_t Histogram::SubBucketBits;
+const uint32_t Histogram::SubBucketCount;
+const size_t Histogram::BucketCount;
+
+namespace
+{
+uint32_t FloorLog2(uint64_t value)
+{
+    uint32_t log = 0;
+    for (uint32_t shift = 32; shift > 0; shift /= 2)
+    {
+        if (value >> shift)
+        {
+            value >>= shift;
+            log += shift;
+        }
+    }
+    return log;
+}
+}
+
+Histogram::Histogram()
+{
+    Reset();
+}
+
+Histogram::~Histogram()
+{
+}
+
+size_t Histogram::GetBucketIndex(uint64_t value)
+{
+    // Values below SubBucketCount have a bucket each; above, the top SubBucketBits bits after the leading one
+    // pick the bucket within the value's power of 2.
+    if (value < SubBucketCount)
+        return size_t(value);
+
+    auto exponent = FloorLog2(value);
+    auto subBucket = (value >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+    return (size_t(exponent - SubBucketBits + 1) << SubBucketBits) + size_t(subBucket);
+}
+
+uint64_t Histogram::GetBucketUpperBound(size_t index)
+{
+    if (index < SubBucketCount)
+        return uint64_t(index);
+
+    auto shift = uint32_t(index >> SubBucketBits) - 1;
+    auto lowerBound = (uint64_t(SubBucketCount) + (index & (SubBucketCount - 1))) << shift;
+    return lowerBound + ((uint64_t(1) << shift) - 1);
+}
+
+void Histogram::Record(uint64_t value)
+{
+    m_buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void Histogram::Reset()
+{
+    for (auto& bucket : m_buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+}
+
+double Histogram::GetMean() const
+{
+    auto count = GetCount();
+    return count ? double(m_sum.load(std::memory_order_relaxed)) / double(count) : 0.0;
+}
+
+uint64_t Histogram::GetPercentile(double percentile) const
+{
+    HistogramSnapshot snapshot;
+    Read(&snapshot);
+    return snapshot.GetPercentile(percentile);
+}
+
+void Histogram::Read(HistogramSnapshot* snapshot) const
+{
+    snapshot->buckets.resize(BucketCount);
+    snapshot->count = 0;
+    for (size_t i = 0; i < BucketCount; ++i)
+    {
+        snapshot->buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot->count += snapshot->buckets[i]; // consistent with the buckets while recording goes on
+    }
+    snapshot->max = m_max.load(std::memory_order_relaxed);
+    snapshot->sum = m_sum.load(std::memory_order_relaxed);
+}
+
+HistogramSnapshot::HistogramSnapshot() :
+    count(0),
+    max(0),
+    sum(0)
+{
+}
+
+void HistogramSnapshot::Subtract(const HistogramSnapshot& earlier)
+{
+    for (size_t i = 0; i < buckets.size() && i < earlier.buckets.size(); ++i)
+    {
+        buckets[i] -= earlier.buckets[i];
+    }
+    count -= earlier.count;
+    sum -= earlier.sum;
+}
+
+uint64_t HistogramSnapshot::GetPercentile(double percentile) const
+{
+    if (count == 0)
+        return 0;
+
+    // The bucket holding the ranked value, reported as its largest value (never above the largest recorded).
+    auto rank = uint64_t(std::ceil(std::min(std::max(percentile, 0.0), 100.0) / 100.0 * double(count)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(Histogram::GetBucketUpperBound(i), max);
+    }
+    return max;
+}
+
+HistogramWindow::HistogramWindow(const Histogram* histogram) :
+    m_histogram(histogram)
+{
+}
+
+void HistogramWindow::Advance()
+{
+    m_histogram->Read(&m_current);
+    m_last = m_current;
+    m_last.Subtract(m_previous);
+    std::swap(m_previous, m_current);
+}
@@ -0,0 +1,82 @@
+//
+// Histogram.h - fixed-size log-linear histogram of non-negative integer values
+//
+
+#pragma once
+
+#include <atomic>
+
+struct HistogramSnapshot;
+
+// Each power of 2 is split into SubBucketCount linear buckets, so a value is counted within 1/SubBucketCount
+// of itself (12.5%) in a fixed set of counters, whatever the range (nanoseconds to hours, say). Recording is
+// a few relaxed atomic operations and may happen on any thread.
+class Histogram
+{
+public:
+    static const uint32_t SubBucketBits = 3;
+    static const uint32_t SubBucketCount = 1 << SubBucketBits;
+    static const size_t BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+    Histogram();
+    ~Histogram();
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void Record(uint64_t value);
+    void Reset();
+
+    uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+    double GetMean() const;
+    uint64_t GetPercentile(double percentile) const; // percentile from 0 to 100; 0 if empty
+
+    // Copy the counts, to compute statistics of an interval (see HistogramSnapshot::Subtract).
+    void Read(HistogramSnapshot* snapshot) const;
+
+    static size_t GetBucketIndex(uint64_t value);
+    static uint64_t GetBucketUpperBound(size_t index); // largest value counted in the bucket
+
+private:
+    std::atomic<uint64_t>   m_buckets[BucketCount];
+    std::atomic<uint64_t>   m_count;
+    std::atomic<uint64_t>   m_max;
+    std::atomic<uint64_t>   m_sum;
+};
+
+struct HistogramSnapshot
+{
+    std::vector<uint64_t>   buckets;
+    uint64_t                count;
+    uint64_t                max; // of everything recorded, not only since an earlier snapshot
+    uint64_t                sum;
+
+    HistogramSnapshot();
+
+    // Leave only what was recorded after earlier was read.
+    void Subtract(const HistogramSnapshot& earlier);
+
+    double GetMean() const { return count ? double(sum) / double(count) : 0.0; }
+    uint64_t GetPercentile(double percentile) const;
+};
+
+// What a histogram recorded over the latest window of time: each Advance call closes a window and starts the
+// next. The window's max is that of its top bucket. Advancing reuses the snapshots' storage, so only the first
+// call allocates.
+class HistogramWindow
+{
+public:
+    explicit HistogramWindow(const Histogram* histogram);
+
+    void Advance();
+
+    // The most recently closed window (empty before the first Advance).
+    const HistogramSnapshot& GetLast() const { return m_last; }
+
+private:
+    HistogramSnapshot   m_current;
+    const Histogram*    m_histogram;
+    HistogramSnapshot   m_last;
+    HistogramSnapshot   m_previous; // totals when the current window started
+};
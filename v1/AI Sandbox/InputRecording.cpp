@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "InputRecording.h"
+#include "InputResources.h"
+#include "World.h"
+
+#include <istream>
+#include <ostream>
+
+// Behavior modules
+#include "FollowBehavior.h"
+#include "PlayerInput.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+const uint32_t RecordingMagic = 0x49534941; // "AISI"
+const uint32_t RecordingVersion = 2;
+
+// Longest configuration a recording may hold; anything longer is taken to be a damaged file.
+const uint64_t MaxConfigSize = 1 << 20;
+
+// Frame flags
+const uint8_t KeyboardChanged = 0x1;
+const uint8_t MouseChanged = 0x2;
+const uint8_t HasCommands = 0x4;
+const uint8_t ViewChanged = 0x8;
+
+// Values are written in the machine's byte order; recordings are replayed on the platform that made them.
+template<typename T>
+inline void WriteValue(std::ostream& output, const T& value)
+{
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+inline bool ReadValue(std::istream& input, T* value)
+{
+    return bool(input.read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+// Mouse::State has padding, so it is compared and stored field by field.
+bool MouseStatesEqual(const Mouse::State& a, const Mouse::State& b)
+{
+    return a.leftButton == b.leftButton && a.middleButton == b.middleButton && a.rightButton == b.rightButton &&
+        a.xButton1 == b.xButton1 && a.xButton2 == b.xButton2 && a.x == b.x && a.y == b.y &&
+        a.scrollWheelValue == b.scrollWheelValue && a.positionMode == b.positionMode;
+}
+
+void WriteMouseState(std::ostream& output, const Mouse::State& state)
+{
+    uint8_t buttons = (state.leftButton ? 0x1 : 0) | (state.middleButton ? 0x2 : 0) | (state.rightButton ? 0x4 : 0) |
+        (state.xButton1 ? 0x8 : 0) | (state.xButton2 ? 0x10 : 0);
+    WriteValue(output, buttons);
+    WriteValue(output, int32_t(state.x));
+    WriteValue(output, int32_t(state.y));
+    WriteValue(output, int32_t(state.scrollWheelValue));
+    WriteValue(output, uint8_t(state.positionMode));
+}
+
+bool ReadMouseState(std::istream& input, Mouse::State* state)
+{
+    uint8_t buttons, positionMode;
+    int32_t x, y, scrollWheelValue;
+    if (!ReadValue(input, &buttons) || !ReadValue(input, &x) || !ReadValue(input, &y) ||
+        !ReadValue(input, &scrollWheelValue) || !ReadValue(input, &positionMode))
+        return false;
+
+    state->leftButton = (buttons & 0x1) != 0;
+    state->middleButton = (buttons & 0x2) != 0;
+    state->rightButton = (buttons & 0x4) != 0;
+    state->xButton1 = (buttons & 0x8) != 0;
+    state->xButton2 = (buttons & 0x10) != 0;
+    state->x = x;
+    state->y = y;
+    state->scrollWheelValue = scrollWheelValue;
+    state->positionMode = Mouse::Mode(positionMode);
+    return true;
+}
+
+InputFrame EmptyFrame()
+{
+    InputFrame frame;
+    memset(&frame.keyboard, 0, sizeof(frame.keyboard));
+    memset(&frame.mouse, 0, sizeof(frame.mouse));
+    frame.viewSize = Vector2::Zero;
+    return frame;
+}
+}
+
+InputRecorder::InputRecorder() :
+    m_frameCount(0),
+    m_output(nullptr),
+    m_previousFrame(EmptyFrame())
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+}
+
+void InputRecorder::Begin(std::ostream* output, const InputRecordingHeader& header)
+{
+    m_output = output;
+    m_previousFrame = EmptyFrame();
+    m_previousFrame.viewSize = header.viewSize;
+    m_frameCount = 0;
+
+    WriteValue(*m_output, RecordingMagic);
+    WriteValue(*m_output, RecordingVersion);
+    WriteValue(*m_output, uint32_t(sizeof(Keyboard::State)));
+    WriteValue(*m_output, header.seed);
+    WriteValue(*m_output, header.timeStep);
+    WriteValue(*m_output, header.viewSize.x);
+    WriteValue(*m_output, header.viewSize.y);
+    WriteValue(*m_output, uint64_t(header.config.size()));
+    m_output->write(header.config.data(), std::streamsize(header.config.size()));
+}
+
+void InputRecorder::End()
+{
+    if (m_output)
+    {
+        m_output->flush();
+        m_output = nullptr;
+    }
+}
+
+void InputRecorder::Write(const InputFrame& frame)
+{
+    if (!m_output)
+        return;
+
+    uint8_t flags = 0;
+    if (memcmp(&frame.keyboard, &m_previousFrame.keyboard, sizeof(Keyboard::State)) != 0)
+    {
+        flags |= KeyboardChanged;
+    }
+    if (!MouseStatesEqual(frame.mouse, m_previousFrame.mouse))
+    {
+        flags |= MouseChanged;
+    }
+    if (!frame.commands.empty())
+    {
+        flags |= HasCommands;
+    }
+    if (frame.viewSize != m_previousFrame.viewSize)
+    {
+        flags |= ViewChanged;
+    }
+
+    WriteValue(*m_output, flags);
+    if (flags & KeyboardChanged)
+    {
+        WriteValue(*m_output, frame.keyboard);
+    }
+    if (flags & MouseChanged)
+    {
+        WriteMouseState(*m_output, frame.mouse);
+    }
+    if (flags & ViewChanged)
+    {
+        WriteValue(*m_output, frame.viewSize.x);
+        WriteValue(*m_output, frame.viewSize.y);
+    }
+    if (flags & HasCommands)
+    {
+        WriteValue(*m_output, uint32_t(frame.commands.size()));
+        for (const auto& command : frame.commands)
+        {
+            WriteValue(*m_output, command.type);
+            WriteValue(*m_output, command.position.x);
+            WriteValue(*m_output, command.position.y);
+        }
+    }
+
+    m_previousFrame.keyboard = frame.keyboard;
+    m_previousFrame.mouse = frame.mouse;
+    m_previousFrame.viewSize = frame.viewSize;
+    ++m_frameCount;
+}
+
+InputPlayback::InputPlayback() :
+    m_frameCount(0),
+    m_header(),
+    m_input(nullptr),
+    m_previousFrame(EmptyFrame())
+{
+}
+
+InputPlayback::~InputPlayback()
+{
+}
+
+bool InputPlayback::Begin(std::istream* input)
+{
+    m_input = input;
+    m_previousFrame = EmptyFrame();
+    m_frameCount = 0;
+
+    uint32_t magic, version, keyboardStateSize;
+    if (!ReadValue(*m_input, &magic) || !ReadValue(*m_input, &version) || !ReadValue(*m_input, &keyboardStateSize) ||
+        magic != RecordingMagic || version != RecordingVersion || keyboardStateSize != sizeof(Keyboard::State))
+        return false;
+
+    uint64_t configSize;
+    if (!ReadValue(*m_input, &m_header.seed) || !ReadValue(*m_input, &m_header.timeStep) ||
+        !ReadValue(*m_input, &m_header.viewSize.x) || !ReadValue(*m_input, &m_header.viewSize.y) ||
+        !ReadValue(*m_input, &configSize) || configSize > MaxConfigSize)
+        return false;
+
+    m_header.config.resize(size_t(configSize));
+    if (!m_input->read(&m_header.config[0], std::streamsize(configSize)))
+        return false;
+
+    m_previousFrame.viewSize = m_header.viewSize;
+
+    return m_header.timeStep > 0.0;
+}
+
+bool InputPlayback::Read(InputFrame* frame)
+{
+    uint8_t flags;
+    if (!m_input || !ReadValue(*m_input, &flags))
+        return false;
+
+    frame->keyboard = m_previousFrame.keyboard;
+    frame->mouse = m_previousFrame.mouse;
+    frame->viewSize = m_previousFrame.viewSize;
+    frame->commands.clear();
+
+    if ((flags & KeyboardChanged) && !ReadValue(*m_input, &frame->keyboard))
+        return false;
+    if ((flags & MouseChanged) && !ReadMouseState(*m_input, &frame->mouse))
+        return false;
+    if ((flags & ViewChanged) && (!ReadValue(*m_input, &frame->viewSize.x) || !ReadValue(*m_input, &frame->viewSize.y)))
+        return false;
+
+    if (flags & HasCommands)
+    {
+        uint32_t commandCount;
+        if (!ReadValue(*m_input, &commandCount))
+            return false;
+
+        frame->commands.resize(commandCount);
+        for (auto& command : frame->commands)
+        {
+            if (!ReadValue(*m_input, &command.type) || !ReadValue(*m_input, &command.position.x) ||
+                !ReadValue(*m_input, &command.position.y))
+                return false;
+        }
+    }
+
+    m_previousFrame.keyboard = frame->keyboard;
+    m_previousFrame.mouse = frame->mouse;
+    m_previousFrame.viewSize = frame->viewSize;
+    ++m_frameCount;
+    return true;
+}
+
+void ExecuteInputCommand(World* world, InputResources* inputResources, const InputCommand& command, ID3D11Device2* device)
+{
+    switch (command.type)
+    {
+    case InputCommandType::SpawnAgent:
+    {
+        auto agent = std::make_shared<GameObject>(command.position, device, *world->GetArchetypes());
+        agent->SetTextureTint(Colors::Red.v);
+        auto followModule = std::make_shared<FollowBehavior>(world->GetPlayer(0, 0));
+        agent->AddBehaviorModule(followModule);
+        world->AddPlayer(agent, 1);
+        break;
+    }
+
+    case InputCommandType::SpawnPlayer:
+    {
+        auto humanPlayer = std::make_shared<GameObject>(command.position, device, *world->GetArchetypes());
+        auto playerInputModule = std::make_shared<PlayerInput>(inputResources);
+        humanPlayer->AddBehaviorModule(playerInputModule);
+        world->AddPlayer(humanPlayer, 0);
+        break;
+    }
+
+    case InputCommandType::RemoveAllAgents:
+        world->RemoveAllPlayers(1);
+        break;
+
+    case InputCommandType::RemovePlayer:
+        world->RemovePlayer(world->GetPlayer(0, 0));
+        break;
+    }
+}
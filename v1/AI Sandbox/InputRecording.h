@@ -0,0 +1,92 @@
+//
+// InputRecording.h - a compact per-update log of input and world commands, for reproducing a session
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+class InputResources;
+class World;
+
+// Changes to the world made in response to input. Commands are recorded with their outcome already decided
+// (a spawn position, for example), so replaying them does not depend on how it was chosen.
+enum class InputCommandType : uint8_t
+{
+    SpawnAgent,         // a follower on team 1 at position
+    SpawnPlayer,        // a human-controlled player on team 0 at position
+    RemoveAllAgents,
+    RemovePlayer        // the first player on team 0
+};
+
+struct InputCommand
+{
+    InputCommandType                type;
+    DirectX::SimpleMath::Vector2    position;
+};
+
+// Everything the simulation took from outside during one update.
+struct InputFrame
+{
+    DirectX::Keyboard::State        keyboard;
+    DirectX::Mouse::State           mouse;
+    DirectX::SimpleMath::Vector2    viewSize;   // view (and screen) size, which mouse positions are relative to
+    std::vector<InputCommand>       commands;
+};
+
+struct InputRecordingHeader
+{
+    uint32_t                        seed;       // Helper::RandomInit seed at the start of the session
+    double                          timeStep;   // seconds per update
+    DirectX::SimpleMath::Vector2    viewSize;   // at the start of the session
+    std::string                     config;     // the settings and archetypes the session ran with, in ConfigFile format
+};
+
+// Writes frames to a binary stream. Each frame costs one byte when nothing changed; keyboard, mouse and view
+// state are only written when they differ from the previous frame.
+class InputRecorder
+{
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    void Begin(std::ostream* output, const InputRecordingHeader& header);
+    void End();
+    bool IsRecording() const { return m_output != nullptr; }
+
+    void Write(const InputFrame& frame);
+
+    uint64_t GetFrameCount() const { return m_frameCount; }
+
+private:
+    std::ostream*   m_output;
+    InputFrame      m_previousFrame;
+    uint64_t        m_frameCount;
+};
+
+// Reads frames written by InputRecorder.
+class InputPlayback
+{
+public:
+    InputPlayback();
+    ~InputPlayback();
+
+    // Returns false if the stream is not a recording this build can read.
+    bool Begin(std::istream* input);
+
+    // Returns false at the end of the recording, or if it is truncated.
+    bool Read(InputFrame* frame);
+
+    const InputRecordingHeader& GetHeader() const { return m_header; }
+    uint64_t GetFrameCount() const { return m_frameCount; }
+
+private:
+    std::istream*           m_input;
+    InputRecordingHeader    m_header;
+    InputFrame              m_previousFrame;
+    uint64_t                m_frameCount;
+};
+
+// Carry out a command, live or on replay. device may be null (no textures, when running headless).
+void ExecuteInputCommand(World* world, InputResources* inputResources, const InputCommand& command, ID3D11Device2* device);
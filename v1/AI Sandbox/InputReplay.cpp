@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "ConfigFile.h"
+#include "InputReplay.h"
+#include "RandomHelper.h"
+
+#include <chrono>
+#include <ostream>
+#include <sstream>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+InputReplay::InputReplay()
+{
+}
+
+InputReplay::~InputReplay()
+{
+}
+
+bool InputReplay::Begin(std::istream* input)
+{
+    if (!m_playback.Begin(input))
+        return false;
+
+    const auto& header = m_playback.GetHeader();
+    Helper::RandomInit(header.seed);
+
+    // The session's configuration, applied as Game's constructor applies Config.txt.
+    ConfigFile config;
+    std::istringstream configText(header.config);
+    if (!config.Read(configText, nullptr))
+        return false;
+
+    config.Apply();
+
+    // Same starting world as Game::Initialize.
+    m_world = std::make_unique<World>();
+    m_world->GetArchetypes()->Apply(config.GetArchetypes());
+    m_world->CreateTeam();
+    ExecuteInputCommand(m_world.get(), &m_inputResources,
+        { InputCommandType::SpawnPlayer, m_world->GetWorldBoundary() / 2.f }, nullptr);
+    m_world->CreateTeam();
+    m_world->CenterView(header.viewSize);
+
+    return true;
+}
+
+InputReplayResult InputReplay::Run(std::wostream* report, uint64_t reportInterval)
+{
+    using Clock = std::chrono::steady_clock;
+
+    InputReplayResult result = {};
+    if (!m_world)
+        return result;
+
+    auto elapsedTime = float(m_playback.GetHeader().timeStep);
+    auto start = Clock::now();
+
+    InputFrame frame;
+    while (m_playback.Read(&frame))
+    {
+        auto updateStart = Clock::now();
+
+        m_inputResources.Update(frame.keyboard, frame.mouse);
+        for (const auto& command : frame.commands)
+        {
+            ExecuteInputCommand(m_world.get(), &m_inputResources, command, nullptr);
+        }
+
+        m_world->CenterView(frame.viewSize);
+        m_world->Update(elapsedTime);
+
+        ++result.ticks;
+        auto updateSeconds = std::chrono::duration<double>(Clock::now() - updateStart).count();
+        if (updateSeconds > result.slowestUpdateSeconds)
+        {
+            result.slowestTick = result.ticks;
+            result.slowestUpdateSeconds = updateSeconds;
+        }
+
+        if (report && reportInterval > 0 && result.ticks % reportInterval == 0)
+        {
+            *report << L"tick " << result.ticks << L": " << m_world->GetWorldPartitionStats().activeObjectCount
+                << L" active agents" << std::endl;
+        }
+    }
+
+    result.simulatedSeconds = double(result.ticks) * m_playback.GetHeader().timeStep;
+    result.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.stateHash = m_world->ComputeStateHash();
+
+    if (report)
+    {
+        WriteInputReplayResult(*report, result);
+    }
+
+    return result;
+}
+
+void WriteInputReplayResult(std::wostream& output, const InputReplayResult& result)
+{
+    output << L"ticks: " << result.ticks << L"\n"
+        << L"simulated seconds: " << result.simulatedSeconds << L"\n"
+        << L"wall seconds: " << result.wallSeconds << L"\n"
+        << L"slowest update: tick " << result.slowestTick << L", " << result.slowestUpdateSeconds * 1000.0 << L" ms\n"
+        << L"state hash: " << std::hex << result.stateHash << std::dec << L"\n";
+}
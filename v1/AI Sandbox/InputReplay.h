@@ -0,0 +1,48 @@
+//
+// InputReplay.h - re-simulates a recorded session as fast as possible, with no rendering or frame pacing
+//
+
+#pragma once
+
+#include <iosfwd>
+
+#include "InputRecording.h"
+#include "InputResources.h"
+#include "World.h"
+
+struct InputReplayResult
+{
+    uint64_t    ticks;
+    double      simulatedSeconds;
+    double      wallSeconds;
+    uint64_t    slowestTick;            // update that took the longest, counting from 1
+    double      slowestUpdateSeconds;
+    uint64_t    stateHash;              // World::ComputeStateHash at the end of the replay
+};
+
+// Rebuilds the session's starting world, then feeds each recorded frame through the same steps as
+// Game::Update: input trackers, commands, view, World::Update. Everything the simulation depends on is in
+// the recording, so a replay takes the same path as the session every time, which makes slow updates
+// seen live reproducible under a profiler.
+class InputReplay
+{
+public:
+    InputReplay();
+    ~InputReplay();
+
+    // Returns false if the stream is not a readable recording. The recording's configuration is applied to the
+    // Config variables, as the session applied Config.txt.
+    bool Begin(std::istream* input);
+
+    InputReplayResult Run(std::wostream* report = nullptr, uint64_t reportInterval = 0);
+
+    World* GetWorld() { return m_world.get(); }
+
+private:
+    InputResources          m_inputResources;
+    InputPlayback           m_playback;
+    std::unique_ptr<World>  m_world;
+};
+
+// Write a replay's summary as "name: value" lines.
+void WriteInputReplayResult(std::wostream& output, const InputReplayResult& result);
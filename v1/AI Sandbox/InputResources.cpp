@@ -28,9 +28,11 @@ void InputResources::Resume()
 
 void InputResources::Update()
 {
-    auto kbState = m_keyboard->GetState();
-    m_keyboardTracker.Update(kbState);
+    Update(m_keyboard->GetState(), m_mouse->GetState());
+}
 
-    auto mouseState = m_mouse->GetState();
+void InputResources::Update(const Keyboard::State& keyboardState, const Mouse::State& mouseState)
+{
+    m_keyboardTracker.Update(keyboardState);
     m_mouseTracker.Update(mouseState);
 }
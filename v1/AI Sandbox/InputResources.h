@@ -16,6 +16,9 @@ public:
     void Resume();
     void Update();
 
+    // Advance the trackers from given states instead of the devices (when replaying a recording).
+    void Update(const DirectX::Keyboard::State& keyboardState, const DirectX::Mouse::State& mouseState);
+
 private:
     std::unique_ptr<DirectX::Keyboard> m_keyboard;
     DirectX::Keyboard::KeyboardStateTracker m_keyboardTracker;
@@ -3,8 +3,17 @@
 //
 
 #include "pch.h"
+#include "AllocationCheck.h"
+#include "DeterminismCheck.h"
+#include "FastMath.h"
 #include "Game.h"
+#include "HeadlessRunner.h"
+#include "InputReplay.h"
+#include "ParameterSweep.h"
+#include "Profiler.h"
+#include "WorldBenchmarks.h"
 
+#include <fstream>
 #include <ppltasks.h>
 
 using namespace concurrency;
@@ -396,13 +405,223 @@ public:
 
 // Entry point
 [Platform::MTAThread]
-int __cdecl main(Platform::Array<Platform::String^>^ /*argv*/)
+int __cdecl main(Platform::Array<Platform::String^>^ argv)
 {
     if (!XMVerifyCPUSupport())
     {
         throw std::exception("XMVerifyCPUSupport");
     }
 
+    std::vector<std::wstring> arguments;
+    for (auto argument : argv)
+    {
+        arguments.push_back(argument->Data());
+    }
+
+    auto hasArgument = [&](const wchar_t* name) { return std::find(arguments.begin(), arguments.end(), name) != arguments.end(); };
+    auto localFilePath = [](const wchar_t* fileName)
+    {
+        return std::wstring(Windows::Storage::ApplicationData::Current->LocalFolder->Path->Data()) + L"\\" + fileName;
+    };
+
+    // "--benchmark-math" runs the FastMath microbenchmarks instead of the game, writing the results
+    // to FastMathBenchmark.txt in the app's local folder.
+    if (hasArgument(L"--benchmark-math"))
+    {
+        std::wofstream output(localFilePath(L"FastMathBenchmark.txt"));
+        FastMath::RunBenchmarks(output);
+        return 0;
+    }
+
+    // "--benchmark-world" runs the World and behavior microbenchmarks instead of the game, writing a table
+    // to WorldBenchmark.txt and JSON to WorldBenchmark.json in the app's local folder. "--max-agents N" limits
+    // the largest World::Update population (1000000 by default).
+    if (hasArgument(L"--benchmark-world"))
+    {
+        size_t maxAgents = 1000000;
+        auto maxAgentsArgument = std::find(arguments.begin(), arguments.end(), L"--max-agents");
+        if (maxAgentsArgument != arguments.end() && maxAgentsArgument + 1 != arguments.end())
+        {
+            maxAgents = size_t(std::wcstoull((maxAgentsArgument + 1)->c_str(), nullptr, 10));
+        }
+
+        auto results = RunWorldBenchmarks(maxAgents);
+
+        std::wofstream output(localFilePath(L"WorldBenchmark.txt"));
+        Benchmark::WriteTable(output, results.data(), results.size());
+        std::ofstream json(localFilePath(L"WorldBenchmark.json"));
+        Benchmark::WriteJson(json, "World", results.data(), results.size());
+        return 0;
+    }
+
+    // "--headless" runs the simulation without a window as fast as possible (see HeadlessRunner for its
+    // options), writing progress and results to HeadlessRun.txt in the app's local folder. The exit code
+    // is nonzero if the options could not be parsed. "--profile" also records the run with the profiler,
+    // writing the trace to HeadlessTrace.json, and "--metrics N" writes a sample of the metrics every N
+    // updates to HeadlessMetrics.csv and HeadlessMetrics.json. "--scenario NAME" runs one of the
+    // ScenarioGenerator presets ("10k-chasers", "1m-idle" or "high-churn") seeded with "--seed N"; it works
+    // with "--sweep" too, and with "--check-allocations" for presets without churn.
+    if (hasArgument(L"--headless"))
+    {
+        std::wofstream output(localFilePath(L"HeadlessRun.txt"));
+
+        HeadlessRunOptions options;
+        if (!HeadlessRunner::ParseArguments(arguments, &options))
+        {
+            output << L"invalid headless run options" << std::endl;
+            return 1;
+        }
+
+        HeadlessRunner runner(options);
+        if (hasArgument(L"--profile"))
+        {
+            Profiler::Start();
+            runner.Run(&output);
+            Profiler::Stop();
+
+            std::ofstream trace(localFilePath(L"HeadlessTrace.json"));
+            Profiler::WriteChromeTrace(trace);
+        }
+        else
+        {
+            runner.Run(&output);
+        }
+
+        if (options.metricsSampleInterval > 0)
+        {
+            std::ofstream csv(localFilePath(L"HeadlessMetrics.csv"));
+            runner.GetMetrics().WriteCsv(csv);
+            std::ofstream json(localFilePath(L"HeadlessMetrics.json"));
+            runner.GetMetrics().WriteJson(json);
+        }
+        return 0;
+    }
+
+    // "--check-allocations" runs the headless scenario (see HeadlessRunner for its options) and checks that
+    // World::Update makes no heap allocations once settled: after "--warmup N" updates (600 by default), none
+    // of the next "--ticks N" updates may allocate. The result goes to AllocationCheck.txt in the app's local
+    // folder, and the exit code is nonzero if the check failed, the options could not be parsed or the
+    // scenario has churn.
+    if (hasArgument(L"--check-allocations"))
+    {
+        std::wofstream output(localFilePath(L"AllocationCheck.txt"));
+
+        HeadlessRunOptions options;
+        if (!HeadlessRunner::ParseArguments(arguments, &options) || options.maxTicks == 0)
+        {
+            output << L"invalid headless run options" << std::endl;
+            return 1;
+        }
+
+        uint64_t warmupTicks = 600;
+        auto warmupArgument = std::find(arguments.begin(), arguments.end(), L"--warmup");
+        if (warmupArgument != arguments.end() && warmupArgument + 1 != arguments.end())
+        {
+            warmupTicks = std::wcstoull((warmupArgument + 1)->c_str(), nullptr, 10);
+        }
+
+        AllocationCheckResult result;
+        if (!CheckSteadyStateAllocations(options, warmupTicks, options.maxTicks, &result))
+        {
+            output << L"the scenario spawns agents every update, so it never reaches a steady state" << std::endl;
+            return 1;
+        }
+        WriteAllocationCheckResult(output, result);
+        return result.Passed() ? 0 : 1;
+    }
+
+    // "--check-determinism" runs the headless scenario (see HeadlessRunner for its options) twice side by
+    // side, comparing world hashes after every update, and reports the first update and player on which the
+    // runs differ. "--serial-second" solves contacts on the calling thread only in the second run, to check
+    // that the parallel solve changes nothing. The first run's hashes go to DeterminismHashes.txt; if a
+    // DeterminismReference.txt (such a file from another build, for example one with other instruction sets)
+    // is in the app's local folder, they are compared with it too. The result goes to DeterminismCheck.txt,
+    // and the exit code is nonzero if anything diverged or the options could not be parsed.
+    if (hasArgument(L"--check-determinism"))
+    {
+        std::wofstream output(localFilePath(L"DeterminismCheck.txt"));
+
+        HeadlessRunOptions options;
+        if (!HeadlessRunner::ParseArguments(arguments, &options))
+        {
+            output << L"invalid headless run options" << std::endl;
+            return 1;
+        }
+
+        auto secondOptions = options;
+        if (hasArgument(L"--serial-second"))
+        {
+            secondOptions.parameters.contactParallelSolve = false;
+        }
+
+        auto result = CheckDeterminism(options, secondOptions);
+        WriteDeterminismCheckResult(output, result);
+
+        std::ofstream hashes(localFilePath(L"DeterminismHashes.txt"));
+        WriteTickHashes(hashes, result.tickHashes);
+
+        uint64_t referenceDivergingTick = 0;
+        std::ifstream referenceInput(localFilePath(L"DeterminismReference.txt"));
+        if (referenceInput.is_open())
+        {
+            std::vector<uint64_t> reference;
+            if (!ReadTickHashes(referenceInput, &reference))
+            {
+                output << L"could not read DeterminismReference.txt" << std::endl;
+                return 1;
+            }
+
+            referenceDivergingTick = FindFirstDivergingTick(result.tickHashes, reference);
+            output << L"first tick diverging from the reference: " << referenceDivergingTick << std::endl;
+        }
+
+        return result.Passed() && referenceDivergingTick == 0 ? 0 : 1;
+    }
+
+    // "--replay" re-simulates InputRecording.bin (written when Game_RecordInput is set) at full speed,
+    // writing progress and results to InputReplay.txt in the app's local folder. "--report N" adds a progress
+    // line every N updates. The exit code is nonzero if the recording could not be read.
+    if (hasArgument(L"--replay"))
+    {
+        std::wofstream output(localFilePath(L"InputReplay.txt"));
+        std::ifstream input(localFilePath(L"InputRecording.bin"), std::ios::binary);
+
+        InputReplay replay;
+        if (!replay.Begin(&input))
+        {
+            output << L"could not read InputRecording.bin" << std::endl;
+            return 1;
+        }
+
+        HeadlessRunOptions options;
+        HeadlessRunner::ParseArguments(arguments, &options);
+        replay.Run(&output, options.reportInterval);
+        return 0;
+    }
+
+    // "--sweep" runs the headless scenario over a grid or random sample of world parameters (see
+    // ParameterSweep for its options), writing one row per parameter point to Sweep.csv and progress to
+    // Sweep.txt in the app's local folder. The exit code is nonzero if the options could not be parsed.
+    if (hasArgument(L"--sweep"))
+    {
+        std::wofstream output(localFilePath(L"Sweep.txt"));
+
+        ParameterSweepOptions options;
+        if (!ParameterSweep::ParseArguments(arguments, &options))
+        {
+            output << L"invalid sweep options" << std::endl;
+            return 1;
+        }
+
+        ParameterSweep sweep(options);
+        output << sweep.GetPointCount() << L" points, " << sweep.GetRunCount() << L" runs" << std::endl;
+        auto results = sweep.Run(&output);
+
+        std::ofstream csv(localFilePath(L"Sweep.csv"));
+        WriteParameterSweepCsv(csv, options, results);
+        return 0;
+    }
+
     auto viewProviderFactory = ref new ViewProviderFactory();
     CoreApplication::Run(viewProviderFactory);
     return 0;
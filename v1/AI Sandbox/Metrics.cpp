@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "Metrics.h"
+#include "Profiler.h"
+
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace
+{
+template<typename TMetric>
+TMetric* GetOrCreate(std::map<std::string, std::unique_ptr<TMetric>>& metrics, const std::string& name)
+{
+    auto& metric = metrics[name];
+    if (!metric)
+    {
+        metric.reset(new TMetric());
+    }
+    return metric.get();
+}
+
+template<typename TMetric>
+const TMetric* Find(const std::map<std::string, std::unique_ptr<TMetric>>& metrics, const std::string& name)
+{
+    auto it = metrics.find(name);
+    return it != metrics.end() ? it->second.get() : nullptr;
+}
+
+void WriteJsonNumber(std::ostream& output, double value)
+{
+    // JSON has no NaN; columns a sample does not have are null.
+    if (std::isnan(value))
+    {
+        output << "null";
+    }
+    else
+    {
+        output << value;
+    }
+}
+}
+
+ScopedHistogramTimer::ScopedHistogramTimer(Histogram* histogram) :
+    m_histogram(histogram),
+    m_start(Profiler::Now())
+{
+}
+
+ScopedHistogramTimer::~ScopedHistogramTimer()
+{
+    m_histogram->Record(Profiler::Now() - m_start);
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+}
+
+Counter* MetricsRegistry::GetCounter(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetOrCreate(m_counters, name);
+}
+
+Gauge* MetricsRegistry::GetGauge(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetOrCreate(m_gauges, name);
+}
+
+Histogram* MetricsRegistry::GetHistogram(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetOrCreate(m_histograms, name);
+}
+
+const Counter* MetricsRegistry::FindCounter(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Find(m_counters, name);
+}
+
+const Gauge* MetricsRegistry::FindGauge(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Find(m_gauges, name);
+}
+
+const Histogram* MetricsRegistry::FindHistogram(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Find(m_histograms, name);
+}
+
+void MetricsRegistry::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& counter : m_counters)
+    {
+        counter.second->Reset();
+    }
+    for (auto& histogram : m_histograms)
+    {
+        histogram.second->Reset();
+    }
+}
+
+MetricsRegistry& MetricsRegistry::Default()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsSampler::MetricsSampler(const MetricsRegistry& registry) :
+    m_registry(registry)
+{
+}
+
+MetricsSampler::~MetricsSampler()
+{
+}
+
+size_t MetricsSampler::GetColumn(const std::string& name)
+{
+    auto it = m_columnIndices.find(name);
+    if (it != m_columnIndices.end())
+        return it->second;
+
+    m_columns.push_back(name);
+    m_columnIndices[name] = m_columns.size() - 1;
+    return m_columns.size() - 1;
+}
+
+void MetricsSampler::Sample(uint64_t tick)
+{
+    m_samples.push_back({ tick, std::vector<double>(m_columns.size(), NAN) });
+    auto& sample = m_samples.back();
+    auto set = [&](const std::string& name, double value)
+    {
+        auto column = GetColumn(name);
+        if (column >= sample.values.size())
+        {
+            sample.values.resize(column + 1, NAN);
+        }
+        sample.values[column] = value;
+    };
+
+    std::lock_guard<std::mutex> lock(m_registry.m_mutex);
+
+    for (const auto& counter : m_registry.m_counters)
+    {
+        set(counter.first, double(counter.second->GetValue()));
+    }
+    for (const auto& gauge : m_registry.m_gauges)
+    {
+        set(gauge.first, gauge.second->GetValue());
+    }
+
+    HistogramSnapshot interval;
+    for (const auto& histogram : m_registry.m_histograms)
+    {
+        histogram.second->Read(&interval);
+
+        auto& previous = m_previousHistograms[histogram.first];
+        auto current = interval;
+        interval.Subtract(previous);
+        previous = std::move(current);
+
+        set(histogram.first + ".count", double(interval.count));
+        set(histogram.first + ".mean", interval.GetMean());
+        set(histogram.first + ".p50", double(interval.GetPercentile(50.0)));
+        set(histogram.first + ".p95", double(interval.GetPercentile(95.0)));
+        set(histogram.first + ".p99", double(interval.GetPercentile(99.0)));
+        set(histogram.first + ".max", double(interval.GetPercentile(100.0)));
+    }
+}
+
+void MetricsSampler::WriteCsv(std::ostream& output) const
+{
+    output << "tick";
+    for (const auto& column : m_columns)
+    {
+        output << "," << column;
+    }
+    output << "\n";
+
+    output << std::setprecision(9);
+    for (const auto& sample : m_samples)
+    {
+        output << sample.tick;
+        for (size_t i = 0; i < m_columns.size(); ++i)
+        {
+            output << ",";
+            if (i < sample.values.size() && !std::isnan(sample.values[i]))
+            {
+                output << sample.values[i];
+            }
+        }
+        output << "\n";
+    }
+}
+
+void MetricsSampler::WriteJson(std::ostream& output) const
+{
+    output << "{\"columns\": [\"tick\"";
+    for (const auto& column : m_columns)
+    {
+        output << ", \"" << column << "\"";
+    }
+    output << "],\n\"samples\": [";
+
+    output << std::setprecision(9);
+    for (size_t i = 0; i < m_samples.size(); ++i)
+    {
+        const auto& sample = m_samples[i];
+        output << (i == 0 ? "\n[" : ",\n[") << sample.tick;
+        for (size_t column = 0; column < m_columns.size(); ++column)
+        {
+            output << ", ";
+            WriteJsonNumber(output, column < sample.values.size() ? sample.values[column] : NAN);
+        }
+        output << "]";
+    }
+    output << "\n]}\n";
+}
@@ -0,0 +1,118 @@
+//
+// Metrics.h - named counters, gauges and histograms, sampled into CSV or JSON
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <mutex>
+#include <string>
+
+#include "Histogram.h"
+
+class Counter
+{
+public:
+    Counter() : m_value(0) {}
+
+    void Add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t GetValue() const { return m_value.load(std::memory_order_relaxed); }
+    void Reset() { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value;
+};
+
+class Gauge
+{
+public:
+    Gauge() : m_value(0.0) {}
+
+    void Set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    double GetValue() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value;
+};
+
+// Records the time from construction to destruction into a histogram, in nanoseconds.
+class ScopedHistogramTimer
+{
+public:
+    explicit ScopedHistogramTimer(Histogram* histogram);
+    ~ScopedHistogramTimer();
+
+    ScopedHistogramTimer(const ScopedHistogramTimer&) = delete;
+    ScopedHistogramTimer& operator=(const ScopedHistogramTimer&) = delete;
+
+private:
+    Histogram*  m_histogram;
+    uint64_t    m_start;
+};
+
+// Metrics by name. Get* creates a metric on first use and the pointer stays valid as long as the registry,
+// so code looks its metrics up once and then updates them without the registry's lock. Updates are relaxed
+// atomic operations. Find* (nullptr if there is no such metric) is for code that checks values, for example
+// performance assertions in tests.
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    Counter* GetCounter(const std::string& name);
+    Gauge* GetGauge(const std::string& name);
+    Histogram* GetHistogram(const std::string& name);
+
+    const Counter* FindCounter(const std::string& name) const;
+    const Gauge* FindGauge(const std::string& name) const;
+    const Histogram* FindHistogram(const std::string& name) const;
+
+    // Zero every counter and histogram (gauges keep their values).
+    void Reset();
+
+    // Process-wide registry of the interactive game: its World reports here. Other worlds (headless runs and
+    // ParameterSweep's, which run side by side) report to registries of their own.
+    static MetricsRegistry& Default();
+
+private:
+    friend class MetricsSampler;
+
+    mutable std::mutex                                  m_mutex;
+    std::map<std::string, std::unique_ptr<Counter>>     m_counters;
+    std::map<std::string, std::unique_ptr<Gauge>>       m_gauges;
+    std::map<std::string, std::unique_ptr<Histogram>>   m_histograms;
+};
+
+// Rows of metric values, one per Sample call. Counters are sampled as their total, gauges as their value,
+// and histograms as the count, mean, p50, p95, p99 and max of what was recorded since the previous sample.
+// Metrics created between samples get a column from then on.
+class MetricsSampler
+{
+public:
+    explicit MetricsSampler(const MetricsRegistry& registry);
+    ~MetricsSampler();
+
+    void Sample(uint64_t tick);
+
+    size_t GetSampleCount() const { return m_samples.size(); }
+
+    // CSV with a header row; JSON as {"columns": [...], "samples": [[tick, values...], ...]}.
+    void WriteCsv(std::ostream& output) const;
+    void WriteJson(std::ostream& output) const;
+
+private:
+    size_t GetColumn(const std::string& name);
+
+    struct Row
+    {
+        uint64_t            tick;
+        std::vector<double> values; // by column; shorter than the columns if metrics were added later
+    };
+
+    std::vector<std::string>                    m_columns;
+    std::map<std::string, size_t>               m_columnIndices;
+    std::map<std::string, HistogramSnapshot>    m_previousHistograms;
+    const MetricsRegistry&                      m_registry;
+    std::vector<Row>                            m_samples;
+};
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "ParallelHelper.h"
+#include "Profiler.h"
+
+using namespace Helper;
+
+namespace
+{
+// Set on pool worker threads, and on a thread while it is running a job, so nested calls run inline.
+thread_local bool t_insideParallelFor = false;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) :
+    m_activeWorkers(0),
+    m_allocationAttribution(),
+    m_batchSize(1),
+    m_context(nullptr),
+    m_count(0),
+    m_generation(0),
+    m_invoke(nullptr),
+    m_nextIndex(0),
+    m_stop(false)
+{
+    if (threadCount == 0)
+    {
+        auto hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_jobReady.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::Default()
+{
+    static ThreadPool s_pool;
+    return s_pool;
+}
+
+void ThreadPool::Run(size_t count, size_t minBatchSize, const void* context, InvokeFunction invoke)
+{
+    if (count == 0)
+        return;
+
+    minBatchSize = std::max<size_t>(minBatchSize, 1);
+
+    // Small loops, nested loops, and loops issued while another thread owns the pool run on the calling thread.
+    std::unique_lock<std::mutex> submitLock(m_submitMutex, std::defer_lock);
+    if (m_workers.empty() || count <= minBatchSize || t_insideParallelFor || !submitLock.try_lock())
+    {
+        invoke(context, 0, count);
+        return;
+    }
+
+    {
+        // Wait for any worker still finishing the previous job before reusing the job fields.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobDone.wait(lock, [this] { return m_activeWorkers == 0; });
+
+        // Aim for a few batches per thread so uneven batches balance out.
+        auto batchCount = GetConcurrency() * 4;
+        m_batchSize = std::max(minBatchSize, (count + batchCount - 1) / batchCount);
+        m_allocationAttribution = AllocationTracker::GetAttribution();
+        m_context = context;
+        m_invoke = invoke;
+        m_count = count;
+        m_nextIndex.store(0, std::memory_order_relaxed);
+        ++m_generation;
+    }
+    m_jobReady.notify_all();
+
+    t_insideParallelFor = true;
+    RunBatches();
+    t_insideParallelFor = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobDone.wait(lock, [this] { return m_activeWorkers == 0; });
+}
+
+void ThreadPool::RunBatches()
+{
+    PROFILE_ZONE("Parallel batches");
+
+    for (;;)
+    {
+        auto begin = m_nextIndex.fetch_add(m_batchSize, std::memory_order_relaxed);
+        if (begin >= m_count)
+            break;
+
+        m_invoke(m_context, begin, std::min(begin + m_batchSize, m_count));
+    }
+}
+
+void ThreadPool::WorkerLoop()
+{
+    Profiler::SetThreadName("Worker");
+    t_insideParallelFor = true;
+    uint64_t seenGeneration = 0;
+
+    for (;;)
+    {
+        AllocationTracker::Attribution attribution;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop)
+                return;
+
+            seenGeneration = m_generation;
+            attribution = m_allocationAttribution;
+            ++m_activeWorkers;
+        }
+
+        {
+            AllocationTracker::AttributionScope allocationScope(attribution);
+            RunBatches();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeWorkers;
+        }
+        m_jobDone.notify_all();
+    }
+}
@@ -0,0 +1,76 @@
+//
+// ParallelHelper.h - a small persistent thread pool for splitting loops across cores
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "AllocationTracker.h"
+
+namespace Helper
+{
+class ThreadPool
+{
+public:
+    // A threadCount of 0 uses one worker per hardware thread, minus the calling thread.
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that take part in a ParallelFor, including the calling thread.
+    size_t GetConcurrency() const { return m_workers.size() + 1; }
+
+    // Call func(begin, end) over [0,count) in batches of at least minBatchSize items and block until all
+    // batches are done. Nested calls, and calls made while another thread owns the pool, run inline. Workers'
+    // allocations are attributed to the calling thread (see AllocationTracker::AttributionScope).
+    template<typename TFunc>
+    void ParallelFor(size_t count, size_t minBatchSize, const TFunc& func)
+    {
+        auto invoke = [](const void* context, size_t begin, size_t end)
+        {
+            (*static_cast<const TFunc*>(context))(begin, end);
+        };
+        Run(count, minBatchSize, &func, invoke);
+    }
+
+    // Process-wide pool shared by the simulation.
+    static ThreadPool& Default();
+
+private:
+    typedef void(*InvokeFunction)(const void* context, size_t begin, size_t end);
+
+    void Run(size_t count, size_t minBatchSize, const void* context, InvokeFunction invoke);
+    void RunBatches();
+    void WorkerLoop();
+
+    std::vector<std::thread>    m_workers;
+    std::mutex                  m_submitMutex;  // held by the thread that owns the current job
+    std::mutex                  m_mutex;        // guards job publication and worker bookkeeping
+    std::condition_variable     m_jobReady;
+    std::condition_variable     m_jobDone;
+    uint64_t                    m_generation;
+    size_t                      m_activeWorkers;
+    bool                        m_stop;
+
+    // Current job
+    AllocationTracker::Attribution  m_allocationAttribution; // the submitting thread's
+    const void*                     m_context;
+    InvokeFunction                  m_invoke;
+    size_t                          m_count;
+    size_t                          m_batchSize;
+    std::atomic<size_t>             m_nextIndex;
+};
+
+// Split a loop across the default thread pool.
+template<typename TFunc>
+inline void ParallelFor(size_t count, size_t minBatchSize, const TFunc& func)
+{
+    ThreadPool::Default().ParallelFor(count, minBatchSize, func);
+}
+}
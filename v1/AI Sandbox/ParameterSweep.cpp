@@ -0,0 +1,308 @@
+#include "pch.h"
+#include "ParallelHelper.h"
+#include "ParameterSweep.h"
+#include "RandomHelper.h"
+
+#include <chrono>
+#include <ostream>
+
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+// Parameter names are plain ASCII.
+std::string NarrowName(const std::wstring& name)
+{
+    std::string narrow;
+    for (auto c : name)
+    {
+        narrow += static_cast<char>(c);
+    }
+    return narrow;
+}
+
+// Parse "Name=min:max[:steps]".
+bool ParseDimension(const std::wstring& text, SweepDimension* dimension)
+{
+    auto equals = text.find(L'=');
+    if (equals == std::wstring::npos)
+        return false;
+
+    dimension->name = NarrowName(text.substr(0, equals));
+    dimension->parameter = WorldParameters::FindFloatParameter(dimension->name);
+    if (!dimension->parameter)
+        return false;
+
+    auto range = text.substr(equals + 1);
+    auto firstColon = range.find(L':');
+    if (firstColon == std::wstring::npos)
+        return false;
+    auto secondColon = range.find(L':', firstColon + 1);
+
+    dimension->minimum = std::stof(range.substr(0, firstColon));
+    dimension->maximum = std::stof(range.substr(firstColon + 1, secondColon - firstColon - 1));
+    dimension->steps = secondColon == std::wstring::npos ? 5 : size_t(std::stoull(range.substr(secondColon + 1)));
+
+    return dimension->steps > 0 && dimension->minimum <= dimension->maximum;
+}
+}
+
+ParameterSweepOptions::ParameterSweepOptions() :
+    catchDistance(100.f),
+    catchFraction(0.9f),
+    dimensions(),
+    repeats(1),
+    reportInterval(0),
+    run(),
+    samples(0)
+{
+}
+
+ParameterSweep::ParameterSweep(const ParameterSweepOptions& options) :
+    m_options(options)
+{
+    const auto& dimensions = m_options.dimensions;
+
+    if (m_options.samples > 0)
+    {
+        // Random sample, uniform over the box; seeded so the same options always pick the same points.
+        std::mt19937 random(m_options.run.seed);
+
+        m_points.resize(m_options.samples);
+        for (auto& point : m_points)
+        {
+            for (const auto& dimension : dimensions)
+            {
+                point.push_back(dimension.minimum + Helper::RandomUnit(random) * (dimension.maximum - dimension.minimum));
+            }
+        }
+    }
+    else
+    {
+        // Full grid, with the last dimension varying fastest.
+        size_t pointCount = 1;
+        for (const auto& dimension : dimensions)
+        {
+            pointCount *= dimension.steps;
+        }
+
+        m_points.resize(pointCount);
+        for (size_t pointIndex = 0; pointIndex < pointCount; ++pointIndex)
+        {
+            auto& point = m_points[pointIndex];
+            point.resize(dimensions.size());
+
+            auto remainder = pointIndex;
+            for (size_t d = dimensions.size(); d-- > 0;)
+            {
+                const auto& dimension = dimensions[d];
+                auto step = remainder % dimension.steps;
+                remainder /= dimension.steps;
+
+                auto t = dimension.steps > 1 ? float(step) / float(dimension.steps - 1) : 0.f;
+                point[d] = dimension.minimum + t * (dimension.maximum - dimension.minimum);
+            }
+        }
+    }
+}
+
+bool ParameterSweep::ParseArguments(const std::vector<std::wstring>& arguments, ParameterSweepOptions* options)
+{
+    if (!HeadlessRunner::ParseArguments(arguments, &options->run))
+        return false;
+
+    for (size_t i = 0; i + 1 < arguments.size(); ++i)
+    {
+        const auto& name = arguments[i];
+        const auto& value = arguments[i + 1];
+
+        try
+        {
+            if (name == L"--sweep-param")
+            {
+                SweepDimension dimension;
+                if (!ParseDimension(value, &dimension))
+                    return false;
+
+                options->dimensions.push_back(dimension);
+            }
+            else if (name == L"--samples")
+            {
+                options->samples = size_t(std::stoull(value));
+            }
+            else if (name == L"--repeats")
+            {
+                options->repeats = size_t(std::stoull(value));
+            }
+            else if (name == L"--catch-distance")
+            {
+                options->catchDistance = std::stof(value);
+            }
+            else if (name == L"--catch-fraction")
+            {
+                options->catchFraction = std::stof(value);
+            }
+            else if (name == L"--sweep-report")
+            {
+                options->reportInterval = std::stoull(value);
+            }
+            else
+            {
+                continue;
+            }
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        ++i;
+    }
+
+    return options->repeats > 0 && options->catchFraction > 0.f && options->catchFraction <= 1.f;
+}
+
+std::vector<SweepPointResult> ParameterSweep::Run(std::wostream* report)
+{
+    auto runCount = GetRunCount();
+    std::vector<RunMetrics> runs(runCount);
+
+    std::atomic<uint64_t> completedRuns(0);
+    std::mutex reportMutex;
+
+    // One run per batch: runs are long and vary in length, so workers take the next one as soon as they finish.
+    Helper::ParallelFor(runCount, 1, [&](size_t begin, size_t end)
+    {
+        for (auto runIndex = begin; runIndex < end; ++runIndex)
+        {
+            runs[runIndex] = RunPoint(runIndex / m_options.repeats, runIndex % m_options.repeats);
+
+            auto completed = ++completedRuns;
+            if (report && m_options.reportInterval > 0 && completed % m_options.reportInterval == 0)
+            {
+                std::lock_guard<std::mutex> lock(reportMutex);
+                *report << completed << L" of " << runCount << L" runs done" << std::endl;
+            }
+        }
+    });
+
+    std::vector<SweepPointResult> results(m_points.size());
+    for (size_t pointIndex = 0; pointIndex < m_points.size(); ++pointIndex)
+    {
+        auto& result = results[pointIndex];
+        result.values = m_points[pointIndex];
+        result.runs = m_options.repeats;
+        result.caughtRuns = 0;
+        result.meanTimeToCatch = 0.0;
+        result.meanDistance = 0.0;
+        result.finalMeanDistance = 0.0;
+        result.wallSeconds = 0.0;
+
+        for (size_t repeat = 0; repeat < m_options.repeats; ++repeat)
+        {
+            const auto& run = runs[pointIndex * m_options.repeats + repeat];
+            if (run.timeToCatch >= 0.0)
+            {
+                ++result.caughtRuns;
+                result.meanTimeToCatch += run.timeToCatch;
+            }
+            result.meanDistance += run.meanDistance;
+            result.finalMeanDistance += run.finalMeanDistance;
+            result.wallSeconds += run.wallSeconds;
+        }
+
+        result.meanTimeToCatch = result.caughtRuns > 0 ? result.meanTimeToCatch / double(result.caughtRuns) : -1.0;
+        result.meanDistance /= double(result.runs);
+        result.finalMeanDistance /= double(result.runs);
+        result.wallSeconds /= double(result.runs);
+    }
+
+    return results;
+}
+
+ParameterSweep::RunMetrics ParameterSweep::RunPoint(size_t pointIndex, size_t repeat) const
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+
+    auto runOptions = m_options.run;
+    runOptions.seed = m_options.run.seed + uint32_t(repeat);
+    for (size_t d = 0; d < m_options.dimensions.size(); ++d)
+    {
+        runOptions.parameters.*m_options.dimensions[d].parameter = m_points[pointIndex][d];
+    }
+
+    HeadlessRunner runner(runOptions);
+    const auto& agents = runner.GetWorld()->GetTeam(1);
+    auto agentCount = agents.size();
+    auto catchCount = size_t(std::ceil(m_options.catchFraction * float(agentCount)));
+    auto catchDistanceSquared = m_options.catchDistance * m_options.catchDistance;
+
+    RunMetrics metrics = {};
+    metrics.timeToCatch = -1.0;
+
+    double distanceSum = 0.0;
+    while (!runner.IsFinished())
+    {
+        runner.Step();
+
+        // Agents in dormant chunks report their position as of their chunk's last aggregate update.
+        auto playerPosition = runner.GetPlayer()->GetPosition();
+        double tickDistance = 0.0;
+        size_t caughtUp = 0;
+        for (const auto& agent : agents)
+        {
+            auto distanceSquared = Vector2::DistanceSquared(agent->GetPosition(), playerPosition);
+            tickDistance += std::sqrt(distanceSquared);
+            if (distanceSquared <= catchDistanceSquared)
+            {
+                ++caughtUp;
+            }
+        }
+
+        if (agentCount > 0)
+        {
+            metrics.finalMeanDistance = tickDistance / double(agentCount);
+            distanceSum += metrics.finalMeanDistance;
+        }
+
+        if (metrics.timeToCatch < 0.0 && agentCount > 0 && caughtUp >= catchCount)
+        {
+            metrics.timeToCatch = runner.GetSimulatedSeconds();
+        }
+    }
+
+    metrics.meanDistance = runner.GetTicks() > 0 ? distanceSum / double(runner.GetTicks()) : 0.0;
+    metrics.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return metrics;
+}
+
+void WriteParameterSweepCsv(std::ostream& output, const ParameterSweepOptions& options, const std::vector<SweepPointResult>& results)
+{
+    output << "point";
+    for (const auto& dimension : options.dimensions)
+    {
+        output << "," << dimension.name;
+    }
+    output << ",runs,caught_runs,mean_time_to_catch,mean_distance,final_mean_distance,wall_seconds_per_run\n";
+
+    for (size_t pointIndex = 0; pointIndex < results.size(); ++pointIndex)
+    {
+        const auto& result = results[pointIndex];
+
+        output << pointIndex;
+        for (auto value : result.values)
+        {
+            output << "," << value;
+        }
+
+        // The time to catch is left empty when no run caught up.
+        output << "," << result.runs << "," << result.caughtRuns << ",";
+        if (result.caughtRuns > 0)
+        {
+            output << result.meanTimeToCatch;
+        }
+        output << "," << result.meanDistance << "," << result.finalMeanDistance << "," << result.wallSeconds << "\n";
+    }
+}
@@ -0,0 +1,82 @@
+//
+// ParameterSweep.h - runs many independent headless worlds over a grid or random sample of parameters
+//
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+#include "HeadlessRunner.h"
+
+// One swept parameter, varied over [minimum,maximum].
+struct SweepDimension
+{
+    std::string                 name;       // Config name (see WorldParameters::FindFloatParameter)
+    float WorldParameters::*    parameter;
+    float                       minimum;
+    float                       maximum;
+    size_t                      steps;      // evenly spaced grid values, including both ends
+};
+
+struct ParameterSweepOptions
+{
+    ParameterSweepOptions();
+
+    HeadlessRunOptions          run;            // every run starts from these; run.parameters holds the unswept values
+    std::vector<SweepDimension> dimensions;
+    size_t                      samples;        // random points to run instead of the full grid (0 for the grid)
+    size_t                      repeats;        // runs per point, seeded run.seed, run.seed + 1, ...
+    float                       catchDistance;  // meters from the player within which an agent has caught up
+    float                       catchFraction;  // fraction of agents that must be caught up at once
+    uint64_t                    reportInterval; // completed runs between progress lines (0 for none)
+};
+
+// Metrics for one point, averaged over its repeats.
+struct SweepPointResult
+{
+    std::vector<float>  values;             // one per dimension
+    size_t              runs;
+    size_t              caughtRuns;         // runs in which the agents caught up with the player
+    double              meanTimeToCatch;    // seconds, over the caught runs (negative if there were none)
+    double              meanDistance;       // meters from agent to player, over all agents and updates
+    double              finalMeanDistance;  // meters from agent to player at the end of a run
+    double              wallSeconds;        // per run
+};
+
+// Runs the HeadlessRunner scenario once per point and repeat, each in its own World with its own
+// WorldParameters, spread over every core with Helper::ParallelFor. The runs share nothing, so the results
+// do not depend on the number of cores or the order in which runs finish.
+class ParameterSweep
+{
+public:
+    ParameterSweep(const ParameterSweepOptions& options);
+
+    // Parse "--sweep-param Name=min:max[:steps]" (once per dimension, steps defaulting to 5), "--samples N",
+    // "--repeats N", "--catch-distance M", "--catch-fraction F" and "--sweep-report N", plus the HeadlessRunner
+    // options used for every run. Returns false if a value is malformed or a parameter name is unknown.
+    static bool ParseArguments(const std::vector<std::wstring>& arguments, ParameterSweepOptions* options);
+
+    size_t GetPointCount() const { return m_points.size(); }
+    size_t GetRunCount() const { return m_points.size() * m_options.repeats; }
+
+    // Run every point and return its results, in point order.
+    std::vector<SweepPointResult> Run(std::wostream* report = nullptr);
+
+private:
+    struct RunMetrics
+    {
+        double  timeToCatch; // negative if the agents never caught up
+        double  meanDistance;
+        double  finalMeanDistance;
+        double  wallSeconds;
+    };
+
+    RunMetrics RunPoint(size_t pointIndex, size_t repeat) const;
+
+    ParameterSweepOptions           m_options;
+    std::vector<std::vector<float>> m_points; // parameter values, one per dimension
+};
+
+// Write a header naming each dimension, then one row per point.
+void WriteParameterSweepCsv(std::ostream& output, const ParameterSweepOptions& options, const std::vector<SweepPointResult>& results);
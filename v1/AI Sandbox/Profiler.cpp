@@ -0,0 +1,180 @@
+#include "pch.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+struct Event
+{
+    const char* name;
+    uint64_t    begin; // nanoseconds
+    uint64_t    end; // nanoseconds
+};
+
+// Written only by its thread; read by WriteChromeTrace.
+struct ThreadBuffer
+{
+    std::vector<Event>      events; // ring
+    uint64_t                mask;
+    std::atomic<uint64_t>   written; // events ever written; the ring holds the last events.size()
+    uint64_t                recording; // the recording the events belong to
+    uint32_t                threadId;
+    const char*             threadName;
+};
+
+const Clock::time_point Epoch = Clock::now();
+
+std::atomic<uint64_t>                       CurrentRecording(0);
+size_t                                      EventsPerThread = Profiler::DefaultEventsPerThread;
+std::vector<std::unique_ptr<ThreadBuffer>>  ThreadBuffers; // kept after their threads exit, for the trace
+std::mutex                                  ThreadBuffersMutex;
+thread_local ThreadBuffer*                  LocalBuffer = nullptr;
+thread_local const char*                    LocalThreadName = nullptr;
+
+ThreadBuffer* GetLocalBuffer()
+{
+    std::lock_guard<std::mutex> lock(ThreadBuffersMutex);
+    if (!LocalBuffer)
+    {
+        ThreadBuffers.emplace_back(new ThreadBuffer());
+        LocalBuffer = ThreadBuffers.back().get();
+        LocalBuffer->threadId = uint32_t(ThreadBuffers.size());
+        LocalBuffer->threadName = LocalThreadName;
+    }
+
+    // First event of this recording on this thread: drop the old events.
+    LocalBuffer->events.resize(EventsPerThread);
+    LocalBuffer->mask = EventsPerThread - 1;
+    LocalBuffer->written.store(0, std::memory_order_relaxed);
+    LocalBuffer->recording = CurrentRecording.load(std::memory_order_relaxed);
+    return LocalBuffer;
+}
+
+void WriteJsonString(std::ostream& output, const char* text)
+{
+    output << '"';
+    for (; *text; ++text)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            output << '\\';
+        }
+        output << *text;
+    }
+    output << '"';
+}
+
+// Chrome traces are in microseconds.
+void WriteMicroseconds(std::ostream& output, uint64_t nanoseconds)
+{
+    output << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+}
+}
+
+std::atomic<bool> Profiler::Detail::isRecording(false);
+
+void Profiler::Detail::Record(const char* name, uint64_t begin, uint64_t end)
+{
+    // Zones begun before Stop may end after it.
+    if (!isRecording.load(std::memory_order_relaxed))
+        return;
+
+    auto buffer = LocalBuffer;
+    if (!buffer || buffer->recording != CurrentRecording.load(std::memory_order_acquire))
+    {
+        buffer = GetLocalBuffer();
+    }
+
+    auto written = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[written & buffer->mask] = { name, begin, end };
+    buffer->written.store(written + 1, std::memory_order_release);
+}
+
+uint64_t Profiler::Now()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Epoch).count());
+}
+
+void Profiler::Start(size_t eventsPerThread)
+{
+    {
+        std::lock_guard<std::mutex> lock(ThreadBuffersMutex);
+
+        EventsPerThread = 1;
+        while (EventsPerThread < eventsPerThread)
+        {
+            EventsPerThread *= 2;
+        }
+    }
+
+    // Threads notice the new recording at their next event.
+    CurrentRecording.fetch_add(1, std::memory_order_release);
+    Detail::isRecording.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::Stop()
+{
+    Detail::isRecording.store(false, std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    LocalThreadName = name;
+
+    std::lock_guard<std::mutex> lock(ThreadBuffersMutex);
+    if (LocalBuffer)
+    {
+        LocalBuffer->threadName = name;
+    }
+}
+
+void Profiler::WriteChromeTrace(std::ostream& output)
+{
+    std::lock_guard<std::mutex> lock(ThreadBuffersMutex);
+    auto recording = CurrentRecording.load(std::memory_order_acquire);
+
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool isFirst = true;
+    auto separate = [&]()
+    {
+        output << (isFirst ? "\n" : ",\n");
+        isFirst = false;
+    };
+
+    for (const auto& buffer : ThreadBuffers)
+    {
+        if (buffer->recording != recording)
+            continue;
+
+        if (buffer->threadName)
+        {
+            separate();
+            output << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+            WriteJsonString(output, buffer->threadName);
+            output << "}}";
+        }
+
+        auto written = buffer->written.load(std::memory_order_acquire);
+        auto first = written > buffer->events.size() ? written - buffer->events.size() : 0;
+        for (auto i = first; i < written; ++i)
+        {
+            const auto& event = buffer->events[i & buffer->mask];
+            separate();
+            output << "{\"name\":";
+            WriteJsonString(output, event.name);
+            output << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":";
+            WriteMicroseconds(output, event.begin);
+            output << ",\"dur\":";
+            WriteMicroseconds(output, event.end - event.begin);
+            output << "}";
+        }
+    }
+
+    output << "\n]}\n";
+}
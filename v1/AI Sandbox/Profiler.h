@@ -0,0 +1,79 @@
+//
+// Profiler.h - scoped timing zones recorded per thread, exported as a Chrome trace
+//
+
+#pragma once
+
+#include <atomic>
+#include <iosfwd>
+
+// Zones are compiled in unless PROFILER_DISABLED is defined in the project's preprocessor definitions.
+// While the profiler is not recording, a zone costs one relaxed atomic load. While it is, each thread
+// appends its zones to its own ring buffer (no locks, no allocation), keeping the most recent ones.
+namespace Profiler
+{
+const size_t DefaultEventsPerThread = size_t(1) << 18;
+
+namespace Detail
+{
+extern std::atomic<bool> isRecording;
+void Record(const char* name, uint64_t begin, uint64_t end);
+}
+
+// Nanoseconds since the process started.
+uint64_t Now();
+
+// Start recording, dropping the events of earlier recordings. eventsPerThread is rounded up to a power of 2.
+void Start(size_t eventsPerThread = DefaultEventsPerThread);
+void Stop();
+inline bool IsRecording() { return Detail::isRecording.load(std::memory_order_relaxed); }
+
+// Name the calling thread in traces (threads are numbered otherwise). name must outlive the profiler.
+void SetThreadName(const char* name);
+
+// Write the last recording in the Chrome trace event format, which chrome://tracing and Perfetto
+// (ui.perfetto.dev) open. Call after Stop; zones that end on other threads while writing may be torn.
+void WriteChromeTrace(std::ostream& output);
+
+class Zone
+{
+public:
+    // name must outlive the profiler (normally a string literal).
+    explicit Zone(const char* name) :
+        m_begin(0),
+        m_isRecording(IsRecording()),
+        m_name(name)
+    {
+        if (m_isRecording)
+        {
+            m_begin = Now();
+        }
+    }
+
+    ~Zone()
+    {
+        if (m_isRecording)
+        {
+            Detail::Record(m_name, m_begin, Now());
+        }
+    }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    uint64_t    m_begin;
+    bool        m_isRecording;
+    const char* m_name;
+};
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Time the rest of the enclosing scope as a zone with this name.
+#if defined(PROFILER_DISABLED)
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
@@ -3,7 +3,29 @@
 
 #include <time.h>
 
+namespace
+{
+std::mt19937 s_randomEngine;
+uint32_t s_randomSeed = std::mt19937::default_seed;
+}
+
 void Helper::RandomInit()
 {
-    srand((uint32_t)time(nullptr));
+    RandomInit((uint32_t)time(nullptr));
+}
+
+void Helper::RandomInit(uint32_t seed)
+{
+    s_randomSeed = seed;
+    s_randomEngine.seed(seed);
+}
+
+uint32_t Helper::GetRandomSeed()
+{
+    return s_randomSeed;
+}
+
+std::mt19937& Helper::RandomEngine()
+{
+    return s_randomEngine;
 }
@@ -2,30 +2,46 @@
 
 namespace Helper
 {
-// Initialize random number system
+// Initialize random number system, from the clock or from a known seed (to reproduce a recorded session)
 void RandomInit();
+void RandomInit(uint32_t seed);
+uint32_t GetRandomSeed();
+
+// The generator behind the functions below. mt19937 produces the same sequence on every platform.
+std::mt19937& RandomEngine();
+
+// Generate random float in the range [0,1] from the given generator. Unlike std::uniform_real_distribution,
+// whose algorithm is up to the standard library, this draws the same numbers on every platform.
+inline float RandomUnit(std::mt19937& engine)
+{
+    return float(engine() >> 8) * (1.f / float(0xFFFFFF));
+}
+
+// Generate random float in the range [0,1]
+inline float RandomUnit()
+{
+    return RandomUnit(RandomEngine());
+}
 
 // Generate random angle (in radians) in the range [0,2Pi]
 inline float RandomAngle()
 {
-    float angle = float(rand()) / float(RAND_MAX);
-    return angle * DirectX::XM_2PI;
+    return RandomUnit() * DirectX::XM_2PI;
 }
 
-// Generate random integer in the range [min,max] (if max-min <= RAND_MAX(32767))
+// Generate random integer in the range [min,max]
 inline int32_t RandomBetween(int32_t min, int32_t max)
 {
-    return (rand() % (max - min + 1)) + min;
+    return int32_t(RandomEngine()() % uint32_t(max - min + 1)) + min;
 }
 
-// Generate random float in the range [min,max] (if max-min <= RAND_MAX(32767))
+// Generate random float in the range [min,max]
 inline float RandomBetween(float min, float max)
 {
-    float f = float(rand()) / float(RAND_MAX);
-    return min + (f * (max - min));
+    return min + (RandomUnit() * (max - min));
 }
 
-// Generate random screen position in the viewport range [TopLeft,BottomRight) (assuming width and height are both <= RAND_MAX(32767))
+// Generate random screen position in the viewport range [TopLeft,BottomRight)
 inline DirectX::SimpleMath::Vector2 RandomScreenPosition(D3D11_VIEWPORT viewport)
 {
     return DirectX::SimpleMath::Vector2(
@@ -0,0 +1,106 @@
+//
+// RenderSnapshot.h - everything the renderer needs from one completed simulation update
+//
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+
+#include "DebugGeometry.h"
+#include "TextureCache.h"
+#include "WorldPartition.h"
+
+// One entry of the snapshot's sprite stream. It holds no references to count and takes 32 bytes, so a million
+// of them are written in one parallel pass without touching the textures' reference counts.
+struct SpriteInstance
+{
+    static const uint32_t NoTexture = UINT32_MAX;
+
+    // Where to draw the sprite, blended this far (0 to 1) from its transform before the latest update to the
+    // one after it. Rotation turns the short way round.
+    void Interpolate(float alpha, DirectX::SimpleMath::Vector2* drawPosition, float* drawRotation) const
+    {
+        auto turn = rotation - previousRotation;
+        turn -= DirectX::XM_2PI * std::floor((turn + DirectX::XM_PI) / DirectX::XM_2PI);
+        *drawPosition = previousPosition + (position - previousPosition) * alpha;
+        *drawRotation = previousRotation + turn * alpha;
+    }
+
+    DirectX::SimpleMath::Vector2    position;
+    DirectX::SimpleMath::Vector2    previousPosition; // before the latest update
+    float                           rotation; // radians
+    float                           previousRotation;
+    uint32_t                        tint; // RGBA, 8 bits each (see PackColor)
+    uint32_t                        texture; // index in RenderSnapshot::textures, or NoTexture
+};
+
+inline uint32_t PackColor(const DirectX::SimpleMath::Color& color)
+{
+    auto toByte = [](float value) { return uint32_t(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f); };
+    return toByte(color.R()) | (toByte(color.G()) << 8) | (toByte(color.B()) << 16) | (toByte(color.A()) << 24);
+}
+
+inline DirectX::SimpleMath::Color UnpackColor(uint32_t color)
+{
+    const float scale = 1.f / 255.f;
+    return DirectX::SimpleMath::Color(float(color & 0xff) * scale, float((color >> 8) & 0xff) * scale,
+        float((color >> 16) & 0xff) * scale, float(color >> 24) * scale);
+}
+
+// Debug readout for one human-controlled player, shown while the player's sprite is on screen.
+struct PlayerStatus
+{
+    DirectX::SimpleMath::Vector2    position;
+    DirectX::SimpleMath::Vector2    previousPosition; // before the latest update
+    float                           acceleration;
+    float                           maxAcceleration;
+    float                           maxSpeed;
+    float                           speed;
+};
+
+// Produced by the simulation after each update and handed to the renderer through a TripleBuffer, so the
+// renderer never reads the World while it is being updated.
+struct RenderSnapshot
+{
+    RenderSnapshot() : droppedUpdates(0), interpolationAlpha(1.0), partitionStats(), showDebugInfo(false), simulationTicksPerSecond(0), timeDilation(1.f), updateCount(0), updateSeconds(0.0), visibleObjectCount(0) {}
+
+    // How far to blend from the state before the latest update to the state after it, drawing at the given
+    // time: StepTimer's alpha when the snapshot was published, advanced by the time since. At most 1, so a
+    // late update holds the latest state rather than extrapolating past it.
+    float GetInterpolationAlpha(std::chrono::steady_clock::time_point now) const
+    {
+        if (updateSeconds <= 0.0)
+            return 1.f;
+
+        auto sincePublished = std::chrono::duration<double>(now - publishTime).count();
+        return float(std::min(1.0, std::max(0.0, interpolationAlpha + sincePublished / updateSeconds)));
+    }
+
+    // Sprites are left as they are: World::Render sizes the stream and writes every entry.
+    void Clear()
+    {
+        debugGeometry.Clear();
+        playerStatus.clear();
+    }
+
+    std::vector<SpriteInstance>     sprites;
+    std::vector<TextureHandle>      textures; // by Texture::index; keeps them alive if their objects are removed
+    DebugGeometry                   debugGeometry;
+    std::vector<PlayerStatus>       playerStatus;
+    WorldPartitionStats             partitionStats;
+    size_t                          visibleObjectCount; // drawn, of partitionStats.activeObjectCount
+    bool                            showDebugInfo;
+    uint32_t                        simulationTicksPerSecond;
+    float                           timeDilation; // simulated seconds per real second
+    uint64_t                        droppedUpdates; // updates skipped to stay within the catch-up budget
+    uint32_t                        updateCount; // 0 until the first update has completed
+    DirectX::SimpleMath::Vector2    viewOrigin;
+    DirectX::SimpleMath::Vector2    previousViewOrigin; // before the latest update
+    DirectX::SimpleMath::Vector2    viewSize;
+
+    // Interpolation between updates (see GetInterpolationAlpha)
+    double                                  interpolationAlpha;
+    std::chrono::steady_clock::time_point   publishTime;
+    double                                  updateSeconds; // length of a fixed update (0 to draw the latest state as is)
+};
@@ -0,0 +1,227 @@
+#include "pch.h"
+#include "FollowBehavior.h"
+#include "MoveWaitFollowScript.h"
+#include "RandomHelper.h"
+#include "ScenarioGenerator.h"
+#include "ScriptBehavior.h"
+
+#include <cmath>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+// One leader at the world center on team 0, for the other teams to follow.
+ScenarioTeam LeaderTeam()
+{
+    ScenarioTeam team;
+    team.agentCount = 1;
+    team.spawnRadius = 0.f;
+    return team;
+}
+}
+
+ScenarioTeam::ScenarioTeam() :
+    agentCount(0),
+    churnPerUpdate(0),
+    followFraction(0.f),
+    followTeam(0),
+    maxFollowDistance(0.f),
+    maxScriptWait(0.f),
+    minFollowDistance(0.f),
+    scriptFraction(0.f),
+    spawnCenter(0.5f, 0.5f),
+    spawnDistribution(SpawnDistribution::Disk),
+    spawnRadius(Config::World_ActivationRadius)
+{
+}
+
+ScenarioDescription::ScenarioDescription() :
+    height(0.f),
+    name(),
+    seed(1),
+    teams(),
+    width(0.f)
+{
+}
+
+ScenarioGenerator::ScenarioGenerator(const ScenarioDescription& description) :
+    m_description(description),
+    m_device(nullptr),
+    m_random(description.seed)
+{
+}
+
+ScenarioGenerator::~ScenarioGenerator()
+{
+}
+
+std::unique_ptr<World> ScenarioGenerator::CreateWorld(const WorldParameters& parameters, ID3D11Device2* device, MetricsRegistry* metrics)
+{
+    auto worldParameters = parameters;
+    if (m_description.width > 0.f && m_description.height > 0.f)
+    {
+        worldParameters.width = m_description.width;
+        worldParameters.height = m_description.height;
+    }
+
+    auto world = std::make_unique<World>(worldParameters, metrics);
+    m_device = device;
+    m_random.seed(m_description.seed);
+
+    for (size_t teamNumber = 0; teamNumber < m_description.teams.size(); ++teamNumber)
+    {
+        world->CreateTeam();
+    }
+
+    // Team by team, so followers find their targets when the followed team comes first.
+    for (size_t teamNumber = 0; teamNumber < m_description.teams.size(); ++teamNumber)
+    {
+        for (size_t i = 0; i < m_description.teams[teamNumber].agentCount; ++i)
+        {
+            SpawnAgent(world.get(), teamNumber);
+        }
+    }
+
+    return world;
+}
+
+void ScenarioGenerator::Update(World* world)
+{
+    for (size_t teamNumber = 0; teamNumber < m_description.teams.size(); ++teamNumber)
+    {
+        // Players join at the back of their team, so the oldest are at the front (and cheapest to remove).
+        auto churn = std::min(m_description.teams[teamNumber].churnPerUpdate, world->GetTeam(teamNumber).size());
+        for (size_t i = 0; i < churn; ++i)
+        {
+            world->RemovePlayer(world->GetTeam(teamNumber).front());
+        }
+        for (size_t i = 0; i < churn; ++i)
+        {
+            SpawnAgent(world, teamNumber);
+        }
+    }
+}
+
+void ScenarioGenerator::SpawnAgent(World* world, size_t teamNumber)
+{
+    const auto& team = m_description.teams[teamNumber];
+
+    // Every agent draws the same numbers whatever it turns out to be, so changing a behavior mix moves no
+    // other agent.
+    auto position = GetSpawnPosition(team, world->GetWorldBoundary());
+    auto behaviorRoll = Helper::RandomUnit(m_random);
+    auto followDistance = team.minFollowDistance + Helper::RandomUnit(m_random) * (team.maxFollowDistance - team.minFollowDistance);
+    auto scriptDestination = GetSpawnPosition(team, world->GetWorldBoundary());
+    auto scriptWait = Helper::RandomUnit(m_random) * team.maxScriptWait;
+
+    auto agent = std::make_shared<GameObject>(position, m_device, *world->GetArchetypes());
+    if (teamNumber > 0)
+    {
+        agent->SetTextureTint(Colors::Red.v);
+    }
+
+    if (behaviorRoll < team.followFraction)
+    {
+        auto followModule = std::make_shared<FollowBehavior>(world->GetPlayer(team.followTeam, 0));
+        if (followDistance > 0.f)
+        {
+            followModule->SetFollowDistance(followDistance);
+        }
+        agent->AddBehaviorModule(followModule);
+    }
+    else if (behaviorRoll < team.followFraction + team.scriptFraction)
+    {
+        auto scripts = world->GetScriptScheduler();
+        auto script = scripts->Start<MoveWaitFollowScript>(agent.get(), scriptDestination, scriptWait);
+        agent->AddBehaviorModule(std::make_shared<ScriptBehavior>(scripts, script));
+    }
+
+    world->AddPlayer(agent, teamNumber);
+}
+
+Vector2 ScenarioGenerator::GetSpawnPosition(const ScenarioTeam& team, Vector2 worldSize)
+{
+    auto u = Helper::RandomUnit(m_random);
+    auto v = Helper::RandomUnit(m_random);
+
+    Vector2 position;
+    switch (team.spawnDistribution)
+    {
+    case SpawnDistribution::Uniform:
+        position = Vector2(u, v) * worldSize;
+        break;
+
+    case SpawnDistribution::Disk:
+        position = team.spawnCenter * worldSize + Vector2(std::cos(u * XM_2PI), std::sin(u * XM_2PI)) * std::sqrt(v) * team.spawnRadius;
+        break;
+
+    case SpawnDistribution::Cluster:
+    {
+        // Box-Muller rather than std::normal_distribution, whose draws differ between standard libraries.
+        auto distance = std::sqrt(-2.f * std::log(1.f - u * 0.999999f)) * team.spawnRadius;
+        position = team.spawnCenter * worldSize + Vector2(std::cos(v * XM_2PI), std::sin(v * XM_2PI)) * distance;
+        break;
+    }
+    }
+
+    position.Clamp(Vector2::Zero, worldSize);
+    return position;
+}
+
+bool ScenarioGenerator::GetPreset(const std::string& name, ScenarioDescription* description)
+{
+    ScenarioDescription preset;
+    preset.name = name;
+
+    if (name == "10k-chasers")
+    {
+        // A dense crowd converging on one player: follow steering and collision under load.
+        ScenarioTeam chasers;
+        chasers.agentCount = 10000;
+        chasers.followFraction = 1.f;
+        preset.teams = { LeaderTeam(), chasers };
+    }
+    else if (name == "1m-idle")
+    {
+        // A million agents without behaviors over the whole world: the cost of dormant chunks and of
+        // activating them around the player.
+        ScenarioTeam idle;
+        idle.agentCount = 1000000;
+        idle.spawnDistribution = SpawnDistribution::Uniform;
+        preset.teams = { LeaderTeam(), idle };
+    }
+    else if (name == "high-churn")
+    {
+        // A steady population with 1% replaced every update: spawning, despawn events and partition updates.
+        ScenarioTeam followers;
+        followers.agentCount = 2000;
+        followers.churnPerUpdate = 20;
+        followers.followFraction = 1.f;
+        followers.maxFollowDistance = 120.f;
+        followers.minFollowDistance = 20.f;
+
+        ScenarioTeam scripted;
+        scripted.agentCount = 500;
+        scripted.churnPerUpdate = 5;
+        scripted.maxScriptWait = 5.f;
+        scripted.scriptFraction = 1.f;
+        scripted.spawnDistribution = SpawnDistribution::Cluster;
+        scripted.spawnRadius = 256.f;
+
+        preset.teams = { LeaderTeam(), followers, scripted };
+    }
+    else
+    {
+        return false;
+    }
+
+    *description = preset;
+    return true;
+}
+
+std::vector<std::string> ScenarioGenerator::GetPresetNames()
+{
+    return { "10k-chasers", "1m-idle", "high-churn" };
+}
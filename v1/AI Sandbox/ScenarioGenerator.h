@@ -0,0 +1,80 @@
+//
+// ScenarioGenerator.h - builds reproducible worlds from a seed and a description of their teams
+//
+
+#pragma once
+
+#include <string>
+
+#include "World.h"
+
+enum class SpawnDistribution
+{
+    Uniform,    // anywhere in the world
+    Disk,       // uniformly over a disk of spawnRadius
+    Cluster     // normally distributed around the spawn center, spawnRadius being the standard deviation
+};
+
+struct ScenarioTeam
+{
+    ScenarioTeam();
+
+    size_t                          agentCount;
+    SpawnDistribution               spawnDistribution;
+    DirectX::SimpleMath::Vector2    spawnCenter;        // fraction of the world's size ((0.5, 0.5) is the center)
+    float                           spawnRadius;        // meters
+
+    // Behavior mix. Each agent gets one behavior by these fractions; the rest stand idle.
+    float                           followFraction;     // follow the first agent of followTeam
+    float                           scriptFraction;     // MoveWaitFollowScript to a point in the spawn area
+    size_t                          followTeam;
+    float                           minFollowDistance;  // meters; each follower picks one in [min, max] (0 for the world's)
+    float                           maxFollowDistance;  // meters
+    float                           maxScriptWait;      // seconds a scripted agent waits at its destination, at most
+
+    size_t                          churnPerUpdate;     // oldest agents removed, and as many spawned, every update
+};
+
+struct ScenarioDescription
+{
+    ScenarioDescription();
+
+    std::string                 name;
+    uint32_t                    seed;
+    float                       width;  // meters (0 to keep the world parameters' size)
+    float                       height; // meters
+    std::vector<ScenarioTeam>   teams;
+};
+
+// Builds a world as described and keeps up its churn. Everything is drawn from one generator seeded with the
+// description's seed, in a fixed order per agent, so the same description always gives the same world and
+// the same spawns, update for update.
+class ScenarioGenerator
+{
+public:
+    explicit ScenarioGenerator(const ScenarioDescription& description);
+    ~ScenarioGenerator();
+
+    // A populated world with the description's size and the rest of parameters. Agents get textures if
+    // device is given. The world reports to metrics, or to a registry of its own (see World).
+    std::unique_ptr<World> CreateWorld(const WorldParameters& parameters = WorldParameters(), ID3D11Device2* device = nullptr,
+        MetricsRegistry* metrics = nullptr);
+
+    // Replace each team's oldest agents by its churn. Call before every World::Update.
+    void Update(World* world);
+
+    const ScenarioDescription& GetDescription() const { return m_description; }
+
+    // Presets for the standard perf workloads: "10k-chasers", "1m-idle" and "high-churn". Returns false if
+    // there is no preset by that name.
+    static bool GetPreset(const std::string& name, ScenarioDescription* description);
+    static std::vector<std::string> GetPresetNames();
+
+private:
+    void SpawnAgent(World* world, size_t teamNumber);
+    DirectX::SimpleMath::Vector2 GetSpawnPosition(const ScenarioTeam& team, DirectX::SimpleMath::Vector2 worldSize);
+
+    ScenarioDescription m_description;
+    ID3D11Device2*      m_device;
+    std::mt19937        m_random;
+};
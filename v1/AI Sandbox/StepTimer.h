@@ -4,16 +4,24 @@
 
 #pragma once
 
+#include <chrono>
+#include <algorithm>
 #include <cmath>
-#include <exception>
 #include <stdint.h>
 
+#include "Histogram.h"
+
 namespace DX
 {
     // Helper class for animation and simulation timing.
+    //
+    // Time is read from std::chrono::steady_clock, which is monotonic on every platform (QueryPerformanceCounter
+    // on Windows, clock_gettime(CLOCK_MONOTONIC) on POSIX systems), so the timer does not depend on Win32.
     class StepTimer
     {
     public:
+        using Clock = std::chrono::steady_clock;
+
         StepTimer() noexcept(false) :
             m_elapsedTicks(0),
             m_totalTicks(0),
@@ -21,22 +29,20 @@ namespace DX
             m_frameCount(0),
             m_framesPerSecond(0),
             m_framesThisSecond(0),
-            m_qpcSecondCounter(0),
+            m_clockSecondCounter(0),
             m_isFixedTimeStep(false),
-            m_targetElapsedTicks(TicksPerSecond / 60)
+            m_targetElapsedTicks(TicksPerSecond / 60),
+            m_maxUpdatesPerTick(UINT32_MAX),
+            m_maxCatchUpClockTicks(0),
+            m_simulatedTicksThisSecond(0),
+            m_timeDilation(1.0)
         {
-            if (!QueryPerformanceFrequency(&m_qpcFrequency))
-            {
-                throw std::exception( "QueryPerformanceFrequency" );
-            }
+            ResetCatchUpCounters();
 
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception( "QueryPerformanceCounter" );
-            }
+            m_clockLastTime = Clock::now();
 
             // Initialize max delta to 1/10 of a second.
-            m_qpcMaxDelta = static_cast<uint64_t>(m_qpcFrequency.QuadPart / 10);
+            m_clockMaxDelta = static_cast<uint64_t>(ClockFrequency / 10);
         }
 
         // Get elapsed time since the previous Update call.
@@ -53,12 +59,87 @@ namespace DX
         // Get the current framerate.
         uint32_t GetFramesPerSecond() const					{ return m_framesPerSecond; }
 
+        // Get the time left until the next fixed timestep Update is due (0 in variable timestep mode).
+        uint64_t GetTicksUntilNextUpdate() const
+        {
+            if (!m_isFixedTimeStep || m_leftOverTicks >= m_targetElapsedTicks)
+                return 0;
+
+            return m_targetElapsedTicks - m_leftOverTicks;
+        }
+
+        // How far time has run from the latest fixed timestep Update towards the next, as a fraction of a step
+        // (1 in variable timestep mode). Drawing objects blended this far from their state before that Update
+        // to their state after it keeps motion smooth at any update rate.
+        double GetInterpolationAlpha() const
+        {
+            if (!m_isFixedTimeStep)
+                return 1.0;
+
+            return std::min(1.0, static_cast<double>(m_leftOverTicks) / m_targetElapsedTicks);
+        }
+
         // Set whether to use fixed or variable timestep mode.
         void SetFixedTimeStep(bool isFixedTimestep)			{ m_isFixedTimeStep = isFixedTimestep; }
 
         // Set how often to call Update when in fixed timestep mode.
         void SetTargetElapsedTicks(uint64_t targetElapsed)	{ m_targetElapsedTicks = targetElapsed; }
         void SetTargetElapsedSeconds(double targetElapsed)	{ m_targetElapsedTicks = SecondsToTicks(targetElapsed); }
+        double GetTargetElapsedSeconds() const				{ return TicksToSeconds(m_targetElapsedTicks); }
+
+        // Limit the catch-up work one Tick may do in fixed timestep mode, by number of Update calls and by the
+        // wall time spent in them (0 for no time limit). When a Tick hits either limit, the rest of the backlog is
+        // dropped: simulation time falls behind real time (it is dilated) instead of every later Tick trying to
+        // catch up and falling further behind.
+        void SetMaxUpdatesPerTick(uint32_t maxUpdates)		{ m_maxUpdatesPerTick = std::max<uint32_t>(1, maxUpdates); }
+        void SetMaxCatchUpSeconds(double maxSeconds)		{ m_maxCatchUpClockTicks = static_cast<uint64_t>(maxSeconds * ClockFrequency); }
+
+        // Catch-up counters, since the start of the program or the last ResetCatchUpCounters call. How many
+        // updates each Tick ran is in GetCatchUpUpdates.
+        uint64_t GetDroppedUpdates() const					{ return m_droppedUpdates; }	// fixed steps skipped to stay within budget
+        uint64_t GetDilatedTickCount() const				{ return m_dilatedTickCount; }	// Tick calls that dropped steps
+
+        void ResetCatchUpCounters()
+        {
+            m_droppedUpdates = 0;
+            m_dilatedTickCount = 0;
+        }
+
+        // Simulated seconds per real second, measured over the last second (1 when keeping up).
+        double GetTimeDilation() const						{ return m_timeDilation; }
+
+        // Frame time distributions, since the start of the program or the last ResetFrameTimes call. Durations
+        // are in nanoseconds. Tick records how long each Update call took and how many updates each Tick ran (if
+        // any); the timer does not see rendering, so the render loop calls BeginFrame and EndFrame around each
+        // frame it draws to record render durations and the intervals between frames. Histograms may be read
+        // from any thread.
+        const Histogram& GetUpdateDurations() const			{ return m_updateDurations; }
+        const Histogram& GetCatchUpUpdates() const			{ return m_catchUpUpdates; }
+        const Histogram& GetRenderDurations() const			{ return m_renderDurations; }
+        const Histogram& GetFrameIntervals() const			{ return m_frameIntervals; }
+
+        void BeginFrame()
+        {
+            auto now = Clock::now();
+            if (m_frameStart != Clock::time_point())
+            {
+                m_frameIntervals.Record(ToNanoseconds(now - m_frameStart));
+            }
+            m_frameStart = now;
+        }
+
+        void EndFrame()
+        {
+            m_renderDurations.Record(ToNanoseconds(Clock::now() - m_frameStart));
+        }
+
+        void ResetFrameTimes()
+        {
+            m_updateDurations.Reset();
+            m_catchUpUpdates.Reset();
+            m_renderDurations.Reset();
+            m_frameIntervals.Reset();
+        }
 
         // Integer format represents time using 10,000,000 ticks per second.
         static const uint64_t TicksPerSecond = 10000000;
@@ -72,15 +153,13 @@ namespace DX
 
         void ResetElapsedTime()
         {
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception("QueryPerformanceCounter");
-            }
+            m_clockLastTime = Clock::now();
 
             m_leftOverTicks = 0;
             m_framesPerSecond = 0;
             m_framesThisSecond = 0;
-            m_qpcSecondCounter = 0;
+            m_clockSecondCounter = 0;
+            m_simulatedTicksThisSecond = 0;
         }
 
         // Update timer state, calling the specified Update function the appropriate number of times.
@@ -88,27 +167,22 @@ namespace DX
         void Tick(const TUpdate& update)
         {
             // Query the current time.
-            LARGE_INTEGER currentTime;
-
-            if (!QueryPerformanceCounter(&currentTime))
-            {
-                throw std::exception( "QueryPerformanceCounter" );
-            }
+            auto currentTime = Clock::now();
 
-            uint64_t timeDelta = currentTime.QuadPart - m_qpcLastTime.QuadPart;
+            uint64_t timeDelta = static_cast<uint64_t>((currentTime - m_clockLastTime).count());
 
-            m_qpcLastTime = currentTime;
-            m_qpcSecondCounter += timeDelta;
+            m_clockLastTime = currentTime;
+            m_clockSecondCounter += timeDelta;
 
             // Clamp excessively large time deltas (e.g. after paused in the debugger).
-            if (timeDelta > m_qpcMaxDelta)
+            if (timeDelta > m_clockMaxDelta)
             {
-                timeDelta = m_qpcMaxDelta;
+                timeDelta = m_clockMaxDelta;
             }
 
-            // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
+            // Convert clock units into a canonical tick format. This cannot overflow due to the previous clamp.
             timeDelta *= TicksPerSecond;
-            timeDelta /= m_qpcFrequency.QuadPart;
+            timeDelta /= ClockFrequency;
 
             uint32_t lastFrameCount = m_frameCount;
 
@@ -130,14 +204,33 @@ namespace DX
 
                 m_leftOverTicks += timeDelta;
 
+                uint32_t updates = 0;
                 while (m_leftOverTicks >= m_targetElapsedTicks)
                 {
+                    // Stay within the catch-up budget. Dropping whole steps keeps the step size fixed, so
+                    // the simulation just runs slower than real time until it can keep up again.
+                    if (updates >= m_maxUpdatesPerTick ||
+                        (updates > 0 && m_maxCatchUpClockTicks > 0 && static_cast<uint64_t>((Clock::now() - currentTime).count()) >= m_maxCatchUpClockTicks))
+                    {
+                        m_droppedUpdates += m_leftOverTicks / m_targetElapsedTicks;
+                        m_dilatedTickCount++;
+                        m_leftOverTicks %= m_targetElapsedTicks;
+                        break;
+                    }
+
                     m_elapsedTicks = m_targetElapsedTicks;
                     m_totalTicks += m_targetElapsedTicks;
+                    m_simulatedTicksThisSecond += m_targetElapsedTicks;
                     m_leftOverTicks -= m_targetElapsedTicks;
                     m_frameCount++;
+                    updates++;
 
-                    update();
+                    TimedUpdate(update);
+                }
+
+                if (updates > 0)
+                {
+                    m_catchUpUpdates.Record(updates);
                 }
             }
             else
@@ -145,10 +238,11 @@ namespace DX
                 // Variable timestep update logic.
                 m_elapsedTicks = timeDelta;
                 m_totalTicks += timeDelta;
+                m_simulatedTicksThisSecond += timeDelta;
                 m_leftOverTicks = 0;
                 m_frameCount++;
 
-                update();
+                TimedUpdate(update);
             }
 
             // Track the current framerate.
@@ -157,19 +251,35 @@ namespace DX
                 m_framesThisSecond++;
             }
 
-            if (m_qpcSecondCounter >= static_cast<uint64_t>(m_qpcFrequency.QuadPart))
+            if (m_clockSecondCounter >= ClockFrequency)
             {
                 m_framesPerSecond = m_framesThisSecond;
                 m_framesThisSecond = 0;
-                m_qpcSecondCounter %= m_qpcFrequency.QuadPart;
+                m_timeDilation = TicksToSeconds(m_simulatedTicksThisSecond) / (static_cast<double>(m_clockSecondCounter) / ClockFrequency);
+                m_simulatedTicksThisSecond = 0;
+                m_clockSecondCounter %= ClockFrequency;
             }
         }
 
     private:
-        // Source timing data uses QPC units.
-        LARGE_INTEGER m_qpcFrequency;
-        LARGE_INTEGER m_qpcLastTime;
-        uint64_t m_qpcMaxDelta;
+        static uint64_t ToNanoseconds(Clock::duration duration)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+        template<typename TUpdate>
+        void TimedUpdate(const TUpdate& update)
+        {
+            auto start = Clock::now();
+            update();
+            m_updateDurations.Record(ToNanoseconds(Clock::now() - start));
+        }
+
+        // Source timing data uses clock units.
+        static const uint64_t ClockFrequency = static_cast<uint64_t>(Clock::period::den / Clock::period::num);
+
+        Clock::time_point m_clockLastTime;
+        uint64_t m_clockMaxDelta;
 
         // Derived timing data uses a canonical tick format.
         uint64_t m_elapsedTicks;
@@ -180,10 +290,25 @@ namespace DX
         uint32_t m_frameCount;
         uint32_t m_framesPerSecond;
         uint32_t m_framesThisSecond;
-        uint64_t m_qpcSecondCounter;
+        uint64_t m_clockSecondCounter;
 
         // Members for configuring fixed timestep mode.
         bool m_isFixedTimeStep;
         uint64_t m_targetElapsedTicks;
+
+        // Members for the catch-up budget and its counters.
+        uint32_t m_maxUpdatesPerTick;
+        uint64_t m_maxCatchUpClockTicks;
+        uint64_t m_droppedUpdates;
+        uint64_t m_dilatedTickCount;
+        uint64_t m_simulatedTicksThisSecond;
+        double m_timeDilation;
+
+        // Members for the frame time distributions.
+        Histogram m_updateDurations;
+        Histogram m_catchUpUpdates;
+        Histogram m_renderDurations;
+        Histogram m_frameIntervals;
+        Clock::time_point m_frameStart; // of the frame being drawn
     };
 }
@@ -0,0 +1,69 @@
+//
+// TripleBuffer.h - lock-free single-producer, single-consumer handoff of the latest value
+//
+
+#pragma once
+
+#include <atomic>
+
+// Three slots rotate between the producer (writing), the consumer (reading) and the middle (the most recently
+// published value). Publishing and acquiring are single atomic exchanges, so neither side ever waits for the
+// other; the consumer always sees the newest complete value and skips any it was too slow to read.
+//
+// Slots are reused rather than reallocated, so values holding containers keep their capacity between uses.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() :
+        m_middle(1),
+        m_readIndex(2),
+        m_writeIndex(0)
+    {
+    }
+
+    // Producer side: fill the write slot, then publish it.
+    T& GetWriteBuffer() { return m_buffers[m_writeIndex]; }
+
+    void Publish()
+    {
+        auto previous = m_middle.exchange(uint8_t(m_writeIndex | FreshBit), std::memory_order_acq_rel);
+        m_writeIndex = previous & IndexMask;
+    }
+
+    // Consumer side: take the newest published value, if there is one, and return the read slot.
+    // Returns false (and leaves the read slot as it was) when nothing new has been published.
+    bool Acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & FreshBit) == 0)
+            return false;
+
+        auto previous = m_middle.exchange(uint8_t(m_readIndex), std::memory_order_acq_rel);
+        m_readIndex = previous & IndexMask;
+        return true;
+    }
+
+    const T& GetReadBuffer() const { return m_buffers[m_readIndex]; }
+
+    // Return every slot to a default-constructed value. Neither side may be using the buffer.
+    void Reset()
+    {
+        for (auto& buffer : m_buffers)
+        {
+            buffer = T();
+        }
+
+        m_middle = 1;
+        m_readIndex = 2;
+        m_writeIndex = 0;
+    }
+
+private:
+    static const uint8_t IndexMask = 0x3;
+    static const uint8_t FreshBit = 0x4;
+
+    T                       m_buffers[3];
+    std::atomic<uint8_t>    m_middle; // slot index, plus FreshBit while it holds an unread value
+    uint8_t                 m_readIndex;
+    uint8_t                 m_writeIndex;
+};
@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "WicTextureDecoder.h"
+#include "WICTextureLoader.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+WicTextureDecoder::WicTextureDecoder(ID3D11Device2* device) :
+    m_device(device)
+{
+}
+
+bool WicTextureDecoder::Decode(const std::wstring& path, Texture* texture)
+{
+    auto view = std::make_shared<WicTextureView>();
+    ComPtr<ID3D11Resource> resource;
+    if (!m_device || FAILED(CreateWICTextureFromFile(m_device.Get(), path.c_str(), resource.GetAddressOf(), view->shaderResourceView.ReleaseAndGetAddressOf())))
+        return false;
+
+    ComPtr<ID3D11Texture2D> texture2D;
+    if (FAILED(resource.As(&texture2D)))
+        return false;
+
+    CD3D11_TEXTURE2D_DESC textureDesc;
+    texture2D->GetDesc(&textureDesc);
+    texture->view = view;
+    texture->width = textureDesc.Width;
+    texture->height = textureDesc.Height;
+    return true;
+}
+
+ID3D11ShaderResourceView* WicTextureDecoder::GetShaderResourceView(const Texture& texture)
+{
+    auto view = static_cast<const WicTextureView*>(texture.view.get());
+    return view ? view->shaderResourceView.Get() : nullptr;
+}
@@ -0,0 +1,29 @@
+//
+// WicTextureDecoder.h - decodes the game's textures through WIC for a Direct3D device
+//
+
+#pragma once
+
+#include "TextureCache.h"
+
+// The shader resource view WicTextureDecoder creates for a texture.
+class WicTextureView : public TextureView
+{
+public:
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> shaderResourceView;
+};
+
+// Creates views on one device. Give the cache a new decoder when the device is re-created.
+class WicTextureDecoder : public TextureDecoder
+{
+public:
+    explicit WicTextureDecoder(ID3D11Device2* device);
+
+    virtual bool Decode(const std::wstring& path, Texture* texture) override;
+
+    // The view of a texture this decoder created
+    static ID3D11ShaderResourceView* GetShaderResourceView(const Texture& texture);
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11Device2> m_device;
+};
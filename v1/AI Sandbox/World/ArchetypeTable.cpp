@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "ArchetypeTable.h"
+#include "WorldSnapshot.h"
+
+const size_t Archetype::FieldCount;
+const uint16_t ArchetypeTable::DefaultArchetype;
+const uint16_t ArchetypeTable::NoArchetype;
+const char* ArchetypeTable::DefaultName = "Default";
+
+namespace
+{
+const struct
+{
+    const char*         name;
+    float Archetype::*  field;
+} ArchetypeFields[Archetype::FieldCount] =
+{
+    { "coefficientFriction", &Archetype::coefficientFriction },
+    { "coefficientRestitution", &Archetype::coefficientRestitution },
+    { "mass", &Archetype::mass },
+    { "maxAcceleration", &Archetype::maxAcceleration },
+    { "maxAngularVelocity", &Archetype::maxAngularVelocity },
+    { "maxSpeed", &Archetype::maxSpeed },
+    { "radius", &Archetype::radius },
+};
+}
+
+float Archetype::* Archetype::FindField(const std::string& name)
+{
+    for (const auto& entry : ArchetypeFields)
+    {
+        if (name == entry.name)
+            return entry.field;
+    }
+
+    return nullptr;
+}
+
+float Archetype::* Archetype::GetField(size_t index, const char** name)
+{
+    *name = ArchetypeFields[index].name;
+    return ArchetypeFields[index].field;
+}
+
+ArchetypeTable::ArchetypeTable(const Archetype& defaults)
+{
+    Set(DefaultName, defaults);
+}
+
+ArchetypeTable::~ArchetypeTable()
+{
+}
+
+uint16_t ArchetypeTable::Set(const std::string& name, const Archetype& archetype)
+{
+    auto index = Find(name);
+    if (index != NoArchetype)
+    {
+        m_archetypes[index] = archetype;
+        return index;
+    }
+
+    if (m_archetypes.size() >= NoArchetype)
+        return NoArchetype;
+
+    m_archetypes.push_back(archetype);
+    m_names.push_back(name);
+    return uint16_t(m_archetypes.size() - 1);
+}
+
+void ArchetypeTable::Apply(const ArchetypeTable& archetypes)
+{
+    for (uint16_t i = 0; i < archetypes.GetCount(); ++i)
+    {
+        Set(archetypes.GetName(i), archetypes.Get(i));
+    }
+}
+
+uint16_t ArchetypeTable::Find(const std::string& name) const
+{
+    // Tables hold a handful of archetypes; names are only looked up when objects are set up.
+    for (size_t i = 0; i < m_names.size(); ++i)
+    {
+        if (m_names[i] == name)
+            return uint16_t(i);
+    }
+
+    return NoArchetype;
+}
+
+void ArchetypeTable::Save(SnapshotWriter* writer) const
+{
+    writer->Write(GetCount());
+    for (uint16_t i = 0; i < GetCount(); ++i)
+    {
+        writer->WriteArray(m_names[i].data(), m_names[i].size());
+        writer->Write(m_archetypes[i]);
+    }
+}
+
+bool ArchetypeTable::Load(SnapshotReader* reader, std::vector<uint16_t>* indices)
+{
+    uint16_t count;
+    if (!reader->Read(&count))
+        return false;
+
+    indices->resize(count);
+
+    std::vector<char> name;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        Archetype archetype;
+        if (!reader->ReadArray(&name) || !reader->Read(&archetype))
+            return false;
+
+        (*indices)[i] = Set(std::string(name.begin(), name.end()), archetype);
+        if ((*indices)[i] == NoArchetype)
+            return false;
+    }
+
+    return true;
+}
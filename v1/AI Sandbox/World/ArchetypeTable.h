@@ -0,0 +1,61 @@
+#pragma once
+
+#include <deque>
+#include <string>
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// Physical characteristics shared by every game object of one kind. Objects point at their archetype
+// instead of carrying copies, so changing an archetype (see ConfigWatcher) changes every object of that kind.
+struct Archetype
+{
+    float   coefficientFriction;
+    float   coefficientRestitution;
+    float   mass; // kilograms
+    float   maxAcceleration; // meters per second per second
+    float   maxAngularVelocity; // radians per second
+    float   maxSpeed; // meters per second
+    float   radius; // meters; used until a texture provides the object's size
+
+    static const size_t FieldCount = 7;
+
+    // Look up a field by its name in configuration files (for example "maxSpeed").
+    // Returns nullptr if there is no such field.
+    static float Archetype::* FindField(const std::string& name);
+    static float Archetype::* GetField(size_t index, const char** name);
+};
+
+// A world's archetypes, by name and by index. Index 0 is "Default" (the GameObject_Default settings).
+// Archetypes are never removed and keep their index and address, so objects can hold on to them while
+// archetypes are changed or added.
+class ArchetypeTable
+{
+public:
+    static const uint16_t DefaultArchetype = 0;
+    static const uint16_t NoArchetype = UINT16_MAX;
+    static const char* DefaultName;
+
+    explicit ArchetypeTable(const Archetype& defaults);
+    ~ArchetypeTable();
+
+    // Add an archetype, or change the one with that name in place. Returns its index (NoArchetype if the
+    // table is full).
+    uint16_t Set(const std::string& name, const Archetype& archetype);
+
+    // Set every archetype of another table, by name.
+    void Apply(const ArchetypeTable& archetypes);
+
+    uint16_t Find(const std::string& name) const; // NoArchetype if there is none with that name
+    const Archetype& Get(uint16_t index) const { return m_archetypes[index]; }
+    const std::string& GetName(uint16_t index) const { return m_names[index]; }
+    uint16_t GetCount() const { return uint16_t(m_archetypes.size()); }
+
+    // Snapshot support. Load sets every saved archetype and maps saved indices to this table's indices.
+    void Save(SnapshotWriter* writer) const;
+    bool Load(SnapshotReader* reader, std::vector<uint16_t>* indices);
+
+private:
+    std::deque<Archetype>       m_archetypes; // a deque, so growing does not move them
+    std::vector<std::string>    m_names;
+};
@@ -11,6 +11,19 @@ BehaviorModule::~BehaviorModule()
 {
 }
 
-void BehaviorModule::RenderDebugInfo(DirectX::PrimitiveBatch<DirectX::VertexPositionColor>*)
+void BehaviorModule::RenderDebugInfo(DebugGeometry*)
+{
+}
+
+void BehaviorModule::SaveState(SnapshotWriter*) const
+{
+}
+
+bool BehaviorModule::LoadState(SnapshotReader*)
+{
+    return true;
+}
+
+void BehaviorModule::OnWorldEvents(World*, GameObject*, WorldEventType, const WorldEventBus&)
 {
 }
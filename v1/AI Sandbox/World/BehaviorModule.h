@@ -1,7 +1,21 @@
 #pragma once
 
+class DebugGeometry;
 class GameObject;
+class SnapshotReader;
+class SnapshotWriter;
 class World;
+class WorldEventBus;
+enum class WorldEventType : uint8_t;
+
+// Identifies a module's class in a WorldSnapshot, so GameObjectFactory can re-create it.
+enum class BehaviorModuleType : uint8_t
+{
+    Unknown, // not saved in snapshots
+    Follow,
+    PlayerInput,
+    Script      // re-created by the World, on its ScriptScheduler
+};
 
 class BehaviorModule
 {
@@ -11,9 +25,17 @@ public:
 
     // Override functions
     virtual char GetDefaultPriorityLevel() const { return Config::BehaviorModule_DefaultPriorityLevel; }
-    virtual void RenderDebugInfo(DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* primitiveBatch);
+    virtual void RenderDebugInfo(DebugGeometry* debugGeometry);
     virtual void Run(World* world, GameObject* object, float elapsedTime) = 0;
 
+    // Snapshot support: modules with state write it here and read it back in the same order.
+    virtual BehaviorModuleType GetType() const { return BehaviorModuleType::Unknown; }
+    virtual void SaveState(SnapshotWriter* writer) const;
+    virtual bool LoadState(SnapshotReader* reader);
+
+    // Event support: called with a batch of events of a type the module subscribed to (see WorldEventBus).
+    virtual void OnWorldEvents(World* world, GameObject* object, WorldEventType type, const WorldEventBus& events);
+
     // Base class functions
     bool IsEnabled() const { return m_enabled; }
     void SetEnabled(bool enabled) { m_enabled = enabled; }
@@ -0,0 +1,23 @@
+#include "pch.h"
+#include "BehaviorScript.h"
+#include "WorldSnapshot.h"
+
+
+BehaviorScript::BehaviorScript() :
+    m_resumePoint(0)
+{
+}
+
+BehaviorScript::~BehaviorScript()
+{
+}
+
+void BehaviorScript::SaveState(SnapshotWriter* writer) const
+{
+    writer->Write(m_resumePoint);
+}
+
+bool BehaviorScript::LoadState(SnapshotReader* reader)
+{
+    return reader->Read(&m_resumePoint);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+class GameObject;
+class SnapshotReader;
+class SnapshotWriter;
+class World;
+
+// Identifies a script's class in a WorldSnapshot, so ScriptScheduler can re-create it.
+enum class BehaviorScriptType : uint8_t
+{
+    Unknown, // not saved in snapshots
+    MoveWaitFollow
+};
+
+// What a script waits for before it is resumed again.
+enum class ScriptWaitType : uint8_t
+{
+    NextTick,   // resume on the next update
+    Delay,      // resume once the delay has passed; costs nothing while waiting
+    Condition,  // re-check a condition every update (see SCRIPT_AWAIT_UNTIL)
+    Done        // the script has finished
+};
+
+struct ScriptWait
+{
+    ScriptWaitType  type;
+    float           seconds; // Delay only
+
+    static ScriptWait NextTick() { return { ScriptWaitType::NextTick, 0.f }; }
+    static ScriptWait Delay(float seconds) { return { ScriptWaitType::Delay, seconds }; }
+    static ScriptWait Condition() { return { ScriptWaitType::Condition, 0.f }; }
+    static ScriptWait Done() { return { ScriptWaitType::Done, 0.f }; }
+};
+
+struct ScriptContext
+{
+    World*      world;
+    GameObject* object;         // the object the script runs on
+    float       elapsedTime;    // seconds since the previous update
+};
+
+// A sequential behavior ("move there, wait 2 s, then follow") written as straight-line code that suspends
+// itself between updates, instead of as a hand-rolled state machine.
+//
+// C++14 has no coroutines, so scripts are stackless coroutines built on a switch: Resume starts with
+// SCRIPT_BEGIN and ends with SCRIPT_END, and each SCRIPT_AWAIT returns to the scheduler and continues from
+// the same place when the script is resumed. Locals do not survive an await; anything a script needs across
+// one is a member, which makes the script object the coroutine frame. Frames are allocated by the world's
+// ScriptScheduler from its pool, not from the heap. Code between awaits must not declare variables that are
+// still in scope at the next await (the compiler rejects jumping over their initialization).
+class BehaviorScript
+{
+public:
+    virtual ~BehaviorScript();
+
+    virtual ScriptWait Resume(const ScriptContext& context) = 0;
+
+    // Snapshot support: the base class saves where Resume continues from, and scripts add the members they
+    // keep across awaits. Scripts are re-created with their default constructor before LoadState.
+    virtual BehaviorScriptType GetType() const { return BehaviorScriptType::Unknown; }
+    virtual void SaveState(SnapshotWriter* writer) const;
+    virtual bool LoadState(SnapshotReader* reader);
+
+protected:
+    BehaviorScript();
+
+    int m_resumePoint; // where Resume continues from; 0 is the start
+};
+
+#define SCRIPT_BEGIN            switch (m_resumePoint) { case 0:
+#define SCRIPT_AWAIT(wait)      do { m_resumePoint = __LINE__; return (wait); case __LINE__:; } while (false)
+#define SCRIPT_AWAIT_UNTIL(condition) \
+    do { m_resumePoint = __LINE__; case __LINE__: if (!(condition)) return ScriptWait::Condition(); } while (false)
+#define SCRIPT_END              } m_resumePoint = -1; return ScriptWait::Done()
@@ -0,0 +1,479 @@
+#include "pch.h"
+#include "ContactSolver.h"
+#include "GameObject.h"
+#include "ParallelHelper.h"
+#include "Profiler.h"
+#include "WorldSnapshot.h"
+
+using namespace Config;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+// Colors beyond this are lumped into one final batch that is solved serially.
+const uint32_t MaxParallelColors = 64;
+
+// Contacts per parallel batch; smaller colors are solved on the calling thread.
+const size_t MinContactsPerBatch = 64;
+
+// 2D cross products
+inline float Cross(Vector2 a, Vector2 b) { return a.x * b.y - a.y * b.x; }
+inline Vector2 Cross(float w, Vector2 r) { return Vector2(-w * r.y, w * r.x); }
+
+inline void AtomicMax(std::atomic<uint32_t>& bits, float value)
+{
+    uint32_t valueBits;
+    memcpy(&valueBits, &value, sizeof(valueBits));
+
+    auto current = bits.load(std::memory_order_relaxed);
+    while (valueBits > current && !bits.compare_exchange_weak(current, valueBits, std::memory_order_relaxed))
+    {
+    }
+}
+}
+
+ContactSolver::ContactSolver() :
+    m_baumgarteFactor(ContactSolver_BaumgarteFactor),
+    m_maxIterations(ContactSolver_MaxIterations),
+    m_parallelSolve(ContactSolver_ParallelSolve),
+    m_penetrationSlop(ContactSolver_PenetrationSlop),
+    m_residualBits(0),
+    m_residualTolerance(ContactSolver_ResidualTolerance),
+    m_restitutionThreshold(ContactSolver_RestitutionThreshold),
+    m_stats(),
+    m_warmStarting(ContactSolver_WarmStarting)
+{
+}
+
+ContactSolver::~ContactSolver()
+{
+}
+
+void ContactSolver::Solve(GameObject* const* bodies, size_t bodyCount)
+{
+    m_stats = ContactSolverStats();
+
+    {
+        PROFILE_ZONE("Find contacts");
+        GatherBodies(bodies, bodyCount);
+        FindContacts();
+    }
+
+    m_stats.contactCount = m_contacts.size();
+    if (m_contacts.empty())
+    {
+        m_beganContacts.clear();
+        m_cache.clear();
+        return;
+    }
+
+    {
+        PROFILE_ZONE("Color contacts");
+        ColorContacts();
+        m_stats.islandCount = CountIslands();
+    }
+
+    {
+        PROFILE_ZONE("Solve contacts");
+        if (m_warmStarting)
+        {
+            WarmStart();
+        }
+
+        SolveVelocities();
+
+        ForEachColor([this](const Contact& contact) { CorrectPosition(contact); });
+    }
+
+    PROFILE_ZONE("Update contact cache");
+    ScatterBodies(bodies, bodyCount);
+    UpdateCache();
+}
+
+void ContactSolver::ClearCache()
+{
+    m_cache.clear();
+}
+
+void ContactSolver::SaveCache(SnapshotWriter* writer) const
+{
+    writer->WriteArray(m_cache.data(), m_cache.size());
+}
+
+bool ContactSolver::LoadCache(SnapshotReader* reader)
+{
+    return reader->ReadArray(&m_cache);
+}
+
+void ContactSolver::GatherBodies(GameObject* const* bodies, size_t bodyCount)
+{
+    m_bodies.resize(bodyCount);
+    m_positions.resize(bodyCount);
+
+    for (size_t i = 0; i < bodyCount; ++i)
+    {
+        auto object = bodies[i];
+        auto& body = m_bodies[i];
+
+        body.position = object->GetPosition();
+        body.velocity = object->GetVelocity();
+        body.angularVelocity = object->GetAngularVelocity();
+        body.inverseMass = object->GetMass() > 0.f ? 1.f / object->GetMass() : 0.f;
+        body.inverseInertia = object->GetInertia() > 0.f ? 1.f / object->GetInertia() : 0.f;
+        body.radius = object->GetRadius();
+        body.friction = object->GetCoefficientFriction();
+        body.restitution = object->GetCoefficientRestitution();
+        body.id = object->GetId();
+
+        m_positions[i] = body.position;
+    }
+}
+
+void ContactSolver::FindContacts()
+{
+    m_contacts.clear();
+    m_bodyInContact.assign(m_bodies.size(), 0);
+
+    float maxRadius = 0.f;
+    for (const auto& body : m_bodies)
+    {
+        maxRadius = std::max(maxRadius, body.radius);
+    }
+
+    if (m_bodies.size() < 2 || maxRadius <= 0.f)
+        return;
+
+    // Cells twice the largest radius guarantee that touching bodies are in neighboring cells.
+    m_grid.Build(m_positions.data(), m_positions.size(), 2.f * maxRadius);
+
+    for (uint32_t a = 0; a < uint32_t(m_bodies.size()); ++a)
+    {
+        const auto& bodyA = m_bodies[a];
+        auto reach = Vector2(bodyA.radius + maxRadius);
+
+        m_grid.QueryRect(bodyA.position - reach, bodyA.position + reach, [&](size_t index)
+        {
+            auto b = uint32_t(index);
+            if (b <= a)
+                return; // each pair is found once, from its lower index
+
+            const auto& bodyB = m_bodies[b];
+            auto offset = bodyB.position - bodyA.position;
+            auto distanceSquared = offset.LengthSquared();
+            auto radii = bodyA.radius + bodyB.radius;
+            if (distanceSquared >= radii * radii)
+                return;
+
+            Contact contact = {};
+            auto distance = std::sqrt(distanceSquared);
+            contact.normal = distance > 0.0001f ? offset / distance : Vector2(1.f, 0.f);
+            contact.penetration = radii - distance;
+            contact.bodyA = a;
+            contact.bodyB = b;
+
+            auto lowId = std::min(bodyA.id, bodyB.id);
+            auto highId = std::max(bodyA.id, bodyB.id);
+            contact.key = (uint64_t(lowId) << 32) | highId;
+
+            // Circles touch at the end of their radii, so normal impulses apply no torque and the
+            // tangential lever arm is simply the radius.
+            auto inverseMassSum = bodyA.inverseMass + bodyB.inverseMass;
+            contact.normalMass = inverseMassSum > 0.f ? 1.f / inverseMassSum : 0.f;
+
+            auto tangentInverseMass = inverseMassSum +
+                bodyA.radius * bodyA.radius * bodyA.inverseInertia +
+                bodyB.radius * bodyB.radius * bodyB.inverseInertia;
+            contact.tangentMass = tangentInverseMass > 0.f ? 1.f / tangentInverseMass : 0.f;
+
+            contact.friction = std::sqrt(bodyA.friction * bodyB.friction);
+
+            // Bounce only on impacts fast enough to matter, so resting contacts settle instead of jittering.
+            auto relativeVelocity = bodyB.velocity - bodyA.velocity;
+            auto approachSpeed = relativeVelocity.Dot(contact.normal);
+            if (approachSpeed < -m_restitutionThreshold)
+            {
+                contact.velocityBias = -std::max(bodyA.restitution, bodyB.restitution) * approachSpeed;
+            }
+
+            m_stats.maxPenetration = std::max(m_stats.maxPenetration, contact.penetration);
+            m_bodyInContact[a] = 1;
+            m_bodyInContact[b] = 1;
+            m_contacts.push_back(contact);
+        });
+    }
+}
+
+void ContactSolver::WarmStart()
+{
+    for (auto& contact : m_contacts)
+    {
+        CachedImpulse search = { contact.key, 0.f, 0.f };
+        auto it = std::lower_bound(m_cache.cbegin(), m_cache.cend(), search);
+        if (it == m_cache.cend() || it->key != contact.key)
+            continue;
+
+        contact.normalImpulse = it->normalImpulse;
+        contact.tangentImpulse = it->tangentImpulse;
+        ++m_stats.warmStartedContactCount;
+    }
+
+    // Apply the cached impulses color by color, exactly like a solver iteration.
+    ForEachColor([this](const Contact& contact)
+    {
+        auto& bodyA = m_bodies[contact.bodyA];
+        auto& bodyB = m_bodies[contact.bodyB];
+        auto tangent = Vector2(-contact.normal.y, contact.normal.x);
+        auto impulse = contact.normal * contact.normalImpulse + tangent * contact.tangentImpulse;
+        auto armA = contact.normal * bodyA.radius;
+        auto armB = -contact.normal * bodyB.radius;
+
+        bodyA.velocity -= impulse * bodyA.inverseMass;
+        bodyA.angularVelocity -= bodyA.inverseInertia * Cross(armA, impulse);
+        bodyB.velocity += impulse * bodyB.inverseMass;
+        bodyB.angularVelocity += bodyB.inverseInertia * Cross(armB, impulse);
+    });
+}
+
+void ContactSolver::ColorContacts()
+{
+    m_bodyColors.assign(m_bodies.size(), 0);
+    m_contactColors.resize(m_contacts.size());
+    m_colorStart.assign(MaxParallelColors + 2, 0);
+
+    // Greedy coloring: each contact takes the lowest color neither of its bodies uses yet.
+    uint32_t colorCount = 0;
+    for (size_t i = 0; i < m_contacts.size(); ++i)
+    {
+        const auto& contact = m_contacts[i];
+        auto used = m_bodyColors[contact.bodyA] | m_bodyColors[contact.bodyB];
+
+        uint32_t color = 0;
+        while (color < MaxParallelColors && (used & (uint64_t(1) << color)))
+        {
+            ++color;
+        }
+
+        if (color < MaxParallelColors)
+        {
+            m_bodyColors[contact.bodyA] |= uint64_t(1) << color;
+            m_bodyColors[contact.bodyB] |= uint64_t(1) << color;
+        }
+
+        m_contactColors[i] = uint8_t(color);
+        ++m_colorStart[color + 1];
+        colorCount = std::max(colorCount, color + 1);
+    }
+
+    for (uint32_t c = 0; c <= MaxParallelColors; ++c)
+    {
+        m_colorStart[c + 1] += m_colorStart[c];
+    }
+
+    m_colorOrder.resize(m_contacts.size());
+    for (size_t i = 0; i < m_contacts.size(); ++i)
+    {
+        m_colorOrder[m_colorStart[m_contactColors[i]]++] = uint32_t(i);
+    }
+
+    for (auto c = MaxParallelColors + 1; c > 0; --c)
+    {
+        m_colorStart[c] = m_colorStart[c - 1];
+    }
+    m_colorStart[0] = 0;
+
+    m_stats.colorCount = colorCount;
+}
+
+size_t ContactSolver::CountIslands()
+{
+    m_islandParents.resize(m_bodies.size());
+    for (uint32_t i = 0; i < uint32_t(m_islandParents.size()); ++i)
+    {
+        m_islandParents[i] = i;
+    }
+
+    auto find = [this](uint32_t i)
+    {
+        while (m_islandParents[i] != i)
+        {
+            m_islandParents[i] = m_islandParents[m_islandParents[i]];
+            i = m_islandParents[i];
+        }
+        return i;
+    };
+
+    // Every body in contact starts as its own island; each merge of two distinct sets removes one.
+    size_t touchedBodies = 0;
+    for (auto inContact : m_bodyInContact)
+    {
+        touchedBodies += inContact;
+    }
+
+    size_t merges = 0;
+    for (const auto& contact : m_contacts)
+    {
+        auto rootA = find(contact.bodyA);
+        auto rootB = find(contact.bodyB);
+        if (rootA != rootB)
+        {
+            m_islandParents[rootB] = rootA;
+            ++merges;
+        }
+    }
+
+    return touchedBodies - merges;
+}
+
+void ContactSolver::SolveVelocities()
+{
+    for (int iteration = 0; iteration < m_maxIterations; ++iteration)
+    {
+        m_residualBits.store(0, std::memory_order_relaxed);
+
+        ForEachColor([this](Contact& contact)
+        {
+            AtomicMax(m_residualBits, SolveContact(contact));
+        });
+
+        auto residualBits = m_residualBits.load(std::memory_order_relaxed);
+        memcpy(&m_stats.residual, &residualBits, sizeof(m_stats.residual));
+        m_stats.iterations = iteration + 1;
+
+        if (m_stats.residual < m_residualTolerance)
+            break;
+    }
+}
+
+float ContactSolver::SolveContact(Contact& contact)
+{
+    auto& bodyA = m_bodies[contact.bodyA];
+    auto& bodyB = m_bodies[contact.bodyB];
+    auto tangent = Vector2(-contact.normal.y, contact.normal.x);
+    auto armA = contact.normal * bodyA.radius;
+    auto armB = -contact.normal * bodyB.radius;
+
+    // Normal impulse: stop the bodies approaching (plus any restitution bounce), never pull them together.
+    auto relativeVelocity = bodyB.velocity + Cross(bodyB.angularVelocity, armB) - bodyA.velocity - Cross(bodyA.angularVelocity, armA);
+    auto normalSpeed = relativeVelocity.Dot(contact.normal);
+    auto normalImpulse = contact.normalMass * (contact.velocityBias - normalSpeed);
+
+    auto oldNormalImpulse = contact.normalImpulse;
+    contact.normalImpulse = std::max(oldNormalImpulse + normalImpulse, 0.f);
+    normalImpulse = contact.normalImpulse - oldNormalImpulse;
+
+    auto impulse = contact.normal * normalImpulse;
+    bodyA.velocity -= impulse * bodyA.inverseMass;
+    bodyB.velocity += impulse * bodyB.inverseMass;
+
+    // Friction impulse: oppose sliding, limited by the Coulomb cone of the accumulated normal impulse.
+    relativeVelocity = bodyB.velocity + Cross(bodyB.angularVelocity, armB) - bodyA.velocity - Cross(bodyA.angularVelocity, armA);
+    auto tangentSpeed = relativeVelocity.Dot(tangent);
+    auto tangentImpulse = -contact.tangentMass * tangentSpeed;
+
+    auto maxFriction = contact.friction * contact.normalImpulse;
+    auto oldTangentImpulse = contact.tangentImpulse;
+    contact.tangentImpulse = std::max(-maxFriction, std::min(oldTangentImpulse + tangentImpulse, maxFriction));
+    tangentImpulse = contact.tangentImpulse - oldTangentImpulse;
+
+    impulse = tangent * tangentImpulse;
+    bodyA.velocity -= impulse * bodyA.inverseMass;
+    bodyA.angularVelocity -= bodyA.inverseInertia * Cross(armA, impulse);
+    bodyB.velocity += impulse * bodyB.inverseMass;
+    bodyB.angularVelocity += bodyB.inverseInertia * Cross(armB, impulse);
+
+    return std::max(std::abs(normalImpulse), std::abs(tangentImpulse));
+}
+
+void ContactSolver::CorrectPosition(const Contact& contact)
+{
+    auto& bodyA = m_bodies[contact.bodyA];
+    auto& bodyB = m_bodies[contact.bodyB];
+
+    auto inverseMassSum = bodyA.inverseMass + bodyB.inverseMass;
+    if (inverseMassSum <= 0.f)
+        return;
+
+    // Re-measure the overlap, since earlier colors may already have moved these bodies apart.
+    auto offset = bodyB.position - bodyA.position;
+    auto penetration = bodyA.radius + bodyB.radius - offset.Dot(contact.normal);
+    auto correction = std::max(penetration - m_penetrationSlop, 0.f) * m_baumgarteFactor / inverseMassSum;
+
+    bodyA.position -= contact.normal * (correction * bodyA.inverseMass);
+    bodyB.position += contact.normal * (correction * bodyB.inverseMass);
+}
+
+void ContactSolver::ScatterBodies(GameObject* const* bodies, size_t bodyCount)
+{
+    for (size_t i = 0; i < bodyCount; ++i)
+    {
+        if (!m_bodyInContact[i])
+            continue;
+
+        const auto& body = m_bodies[i];
+        bodies[i]->SetPosition(body.position);
+        bodies[i]->SetVelocity(body.velocity);
+        bodies[i]->SetAngularVelocity(body.angularVelocity);
+    }
+}
+
+void ContactSolver::UpdateCache()
+{
+    m_nextCache.resize(m_contacts.size());
+    for (size_t i = 0; i < m_contacts.size(); ++i)
+    {
+        const auto& contact = m_contacts[i];
+        m_nextCache[i] = { contact.key, contact.normalImpulse, contact.tangentImpulse };
+    }
+
+    std::sort(m_nextCache.begin(), m_nextCache.end());
+
+    // Contacts that were not in the previous update began in this one. Both lists are sorted by key.
+    m_beganContacts.clear();
+    auto previous = m_cache.cbegin();
+    for (const auto& cached : m_nextCache)
+    {
+        while (previous != m_cache.cend() && previous->key < cached.key)
+        {
+            ++previous;
+        }
+
+        if (previous == m_cache.cend() || previous->key != cached.key)
+        {
+            m_beganContacts.push_back({ uint32_t(cached.key >> 32), uint32_t(cached.key), cached.normalImpulse });
+        }
+    }
+
+    m_cache.swap(m_nextCache);
+}
+
+template<typename TFunc>
+void ContactSolver::ForEachColor(const TFunc& func)
+{
+    for (uint32_t color = 0; color <= MaxParallelColors; ++color)
+    {
+        auto begin = m_colorStart[color];
+        auto count = m_colorStart[color + 1] - begin;
+        if (count == 0)
+            continue;
+
+        // Contacts within a color share no bodies, so they can be solved in any order or concurrently.
+        // The overflow color has no such guarantee and always runs serially.
+        if (m_parallelSolve && color < MaxParallelColors)
+        {
+            Helper::ParallelFor(count, MinContactsPerBatch, [&](size_t first, size_t last)
+            {
+                for (auto i = first; i < last; ++i)
+                {
+                    func(m_contacts[m_colorOrder[begin + i]]);
+                }
+            });
+        }
+        else
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                func(m_contacts[m_colorOrder[begin + i]]);
+            }
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+
+#include "SpatialGrid.h"
+#include "WorldEventBus.h"
+
+class GameObject;
+class SnapshotReader;
+class SnapshotWriter;
+
+// Results of the most recent ContactSolver::Solve call.
+struct ContactSolverStats
+{
+    size_t  contactCount;
+    size_t  warmStartedContactCount;    // contacts that persisted from the previous update
+    size_t  islandCount;                // groups of bodies connected through contacts
+    size_t  colorCount;                 // contact batches that were solved one after another
+    int     iterations;                 // velocity iterations actually run (may stop early on convergence)
+    float   residual;                   // largest impulse change during the last iteration
+    float   maxPenetration;             // meters, before position correction
+};
+
+// Sequential-impulse solver for circle-vs-circle contacts between game objects.
+//
+// Accumulated impulses are cached per contact pair (keyed by object ids) so that contacts persisting
+// between updates warm-start from the previous solution. Contacts are graph colored so that no two
+// contacts in the same color share a body; each color is then solved in parallel without locking.
+class ContactSolver
+{
+public:
+    ContactSolver();
+    ~ContactSolver();
+
+    // Detect contacts between the given bodies and resolve them, updating velocities and positions.
+    void Solve(GameObject* const* bodies, size_t bodyCount);
+    void ClearCache();
+
+    // Snapshot support: the warm-starting cache, which carries over into the next Solve.
+    void SaveCache(SnapshotWriter* writer) const;
+    bool LoadCache(SnapshotReader* reader);
+
+    const ContactSolverStats& GetStats() const { return m_stats; }
+    const std::vector<CollidedEvent>& GetBeganContacts() const { return m_beganContacts; } // contacts new in the last Solve
+
+    void SetBaumgarteFactor(float factor) { m_baumgarteFactor = factor; }
+    void SetMaxIterations(int iterations) { m_maxIterations = iterations; }
+    void SetParallelSolve(bool parallelSolve) { m_parallelSolve = parallelSolve; }
+    void SetPenetrationSlop(float slop) { m_penetrationSlop = slop; }
+    void SetResidualTolerance(float tolerance) { m_residualTolerance = tolerance; }
+    void SetRestitutionThreshold(float threshold) { m_restitutionThreshold = threshold; }
+    void SetWarmStarting(bool warmStarting) { m_warmStarting = warmStarting; }
+
+private:
+    struct Body
+    {
+        DirectX::SimpleMath::Vector2 position;
+        DirectX::SimpleMath::Vector2 velocity;
+        float angularVelocity;
+        float inverseMass;
+        float inverseInertia;
+        float radius;
+        float friction;
+        float restitution;
+        uint32_t id;
+    };
+
+    struct Contact
+    {
+        uint64_t key; // pair of object ids, smaller id in the high bits
+        uint32_t bodyA;
+        uint32_t bodyB;
+        DirectX::SimpleMath::Vector2 normal; // from A to B
+        float penetration;
+        float normalMass;
+        float tangentMass;
+        float velocityBias;
+        float friction;
+        float normalImpulse;
+        float tangentImpulse;
+    };
+
+    struct CachedImpulse
+    {
+        uint64_t key;
+        float normalImpulse;
+        float tangentImpulse;
+
+        bool operator<(const CachedImpulse& rhs) const { return key < rhs.key; }
+    };
+
+    void GatherBodies(GameObject* const* bodies, size_t bodyCount);
+    void FindContacts();
+    void WarmStart();
+    void ColorContacts();
+    size_t CountIslands();
+    void SolveVelocities();
+    float SolveContact(Contact& contact);
+    void CorrectPosition(const Contact& contact);
+    void ScatterBodies(GameObject* const* bodies, size_t bodyCount);
+    void UpdateCache();
+
+    template<typename TFunc>
+    void ForEachColor(const TFunc& func);
+
+    // Settings
+    float                           m_baumgarteFactor;
+    int                             m_maxIterations;
+    bool                            m_parallelSolve;
+    float                           m_penetrationSlop;
+    float                           m_residualTolerance;
+    float                           m_restitutionThreshold;
+    bool                            m_warmStarting;
+
+    // Per-update working set; kept between updates so steady-state solving does not allocate.
+    std::vector<Body>                           m_bodies;
+    std::vector<DirectX::SimpleMath::Vector2>   m_positions;
+    std::vector<Contact>                        m_contacts;
+    std::vector<uint8_t>                        m_bodyInContact;
+    std::vector<uint64_t>                       m_bodyColors;       // bit c set when the body has a contact of color c
+    std::vector<uint8_t>                        m_contactColors;
+    std::vector<uint32_t>                       m_colorOrder;       // contact indices grouped by color
+    std::vector<uint32_t>                       m_colorStart;       // color c owns m_colorOrder[m_colorStart[c], m_colorStart[c + 1])
+    std::vector<uint32_t>                       m_islandParents;
+    std::atomic<uint32_t>                       m_residualBits;     // float bits; non-negative floats order like integers
+    SpatialGrid                                 m_grid;
+
+    // Accumulated impulses from the previous update, sorted by key.
+    std::vector<CachedImpulse>                  m_cache;
+    std::vector<CachedImpulse>                  m_nextCache;
+    std::vector<CollidedEvent>                  m_beganContacts;
+
+    ContactSolverStats                          m_stats;
+};
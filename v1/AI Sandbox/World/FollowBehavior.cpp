@@ -1,30 +1,53 @@
 #include "pch.h"
+#include "FastMath.h"
+#include "FixedPoint.h"
 #include "FollowBehavior.h"
 #include "GameObject.h"
 #include "World.h"
+#include "WorldSnapshot.h"
 
 using namespace Config;
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
 
 FollowBehavior::FollowBehavior(std::shared_ptr<GameObject> target) :
-    m_followDistance(Follow_DefaultDistance),
-    m_followTarget(target)
+    m_events(nullptr),
+    m_followDistance(0.f),
+    m_followTarget(target),
+    m_followTargetLost(false),
+    m_hasFollowDistance(false)
 {
 }
 
 FollowBehavior::~FollowBehavior()
 {
+    if (m_events)
+    {
+        m_events->Unsubscribe(m_despawnedSubscription);
+    }
 }
 
 void FollowBehavior::Run(World* world, GameObject* object, float elapsedTime)
 {
     UNREFERENCED_PARAMETER(elapsedTime);
 
-    // See if follow target has become invalid.
-    if (m_followTarget && !m_followTarget->IsValidTarget())
+    if (!m_events)
+    {
+        m_events = world->GetEventBus();
+        m_despawnedSubscription = m_events->Subscribe(WorldEventType::Despawned, this, object);
+
+        // The target may have gone before this module subscribed (a target given up front, or restored).
+        if (m_followTarget && !m_followTarget->IsValidTarget())
+        {
+            m_followTargetLost = true;
+        }
+    }
+
+    // See if follow target has despawned.
+    if (m_followTargetLost)
     {
         m_followTarget = nullptr;
+        m_followTargetLost = false;
         object->SetVelocity(object->GetVelocity() * 0.5f); // reduce speed by half
         return; // we'll try to acquire a new target next time
     }
@@ -36,6 +59,7 @@ void FollowBehavior::Run(World* world, GameObject* object, float elapsedTime)
         if (player)
         {
             m_followTarget = player;
+            m_events->Publish(TargetAcquiredEvent{ object->GetId(), player->GetId() });
         }
         else
         {
@@ -43,10 +67,44 @@ void FollowBehavior::Run(World* world, GameObject* object, float elapsedTime)
         }
     }
 
+    auto followDistance = m_hasFollowDistance ? m_followDistance : world->GetParameters().followDistance;
+
+#if defined(FIXED_POINT_SIMULATION)
+    using namespace FixedPoint;
+
+    auto vectorToPlayer = m_followTarget->GetKinematicPosition() - object->GetKinematicPosition();
+    auto newSpeed = Min(Fixed::FromFloat(object->GetMaxSpeed()), Length(vectorToPlayer) - Fixed::FromFloat(followDistance));
+
+    object->SetKinematicVelocity(Normalize(vectorToPlayer) * newSpeed);
+#else
     auto vectorToPlayer = m_followTarget->GetPosition() - object->GetPosition();
-    auto newSpeed = std::min(object->GetMaxSpeed(), vectorToPlayer.Length() - m_followDistance);
+    auto newSpeed = std::min(object->GetMaxSpeed(), FastMath::Length(vectorToPlayer) - followDistance);
 
-    vectorToPlayer.Normalize();
-    vectorToPlayer *= newSpeed;
-    object->SetVelocity(vectorToPlayer);
+    object->SetVelocity(FastMath::Normalize(vectorToPlayer) * newSpeed);
+#endif
+}
+
+void FollowBehavior::SaveState(SnapshotWriter* writer) const
+{
+    writer->Write(m_followDistance);
+    writer->Write(m_hasFollowDistance);
+    writer->WriteObject(m_followTarget.get());
+
+    // A despawned target is written as no object; whether it was lost still matters (before its event is
+    // delivered, too).
+    writer->Write(m_followTargetLost || (m_followTarget && !m_followTarget->IsValidTarget()));
+}
+
+bool FollowBehavior::LoadState(SnapshotReader* reader)
+{
+    return reader->Read(&m_followDistance) && reader->Read(&m_hasFollowDistance) &&
+        reader->ReadObject(&m_followTarget) && reader->Read(&m_followTargetLost);
+}
+
+void FollowBehavior::OnWorldEvents(World*, GameObject*, WorldEventType, const WorldEventBus& events)
+{
+    if (m_followTarget && events.WasDespawned(m_followTarget->GetId()))
+    {
+        m_followTargetLost = true;
+    }
 }
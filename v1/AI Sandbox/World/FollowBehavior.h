@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BehaviorModule.h"
+#include "WorldEventBus.h"
 
 class GameObject;
 class World;
@@ -13,11 +14,21 @@ public:
 
     // Override functions
     virtual void Run(World* world, GameObject* gameObject, float elapsedTime) override;
+    virtual BehaviorModuleType GetType() const override { return BehaviorModuleType::Follow; }
+    virtual void SaveState(SnapshotWriter* writer) const override;
+    virtual bool LoadState(SnapshotReader* reader) override;
+    virtual void OnWorldEvents(World* world, GameObject* object, WorldEventType type, const WorldEventBus& events) override;
 
     // Module-specific functions
-    void SetFollowDistance(float distance) { m_followDistance = distance; }
+    void SetFollowDistance(float distance) { m_followDistance = distance; m_hasFollowDistance = true; } // otherwise the world's followDistance is used
 
 private:
     float m_followDistance;
+    bool m_hasFollowDistance;
     std::shared_ptr<GameObject> m_followTarget;
+    bool m_followTargetLost; // the target despawned; react on the next Run
+
+    // Despawn events replace checking the target every update. Subscribed on the first Run.
+    WorldEventBus* m_events;
+    WorldEventSubscription m_despawnedSubscription;
 };
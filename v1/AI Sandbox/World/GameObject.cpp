@@ -1,39 +1,55 @@
 #include "pch.h"
+#include "FastMath.h"
+#include "FixedPoint.h"
 #include "GameObject.h"
-#include "WICTextureLoader.h"
+#include "Profiler.h"
+#include "RenderSnapshot.h"
 #include "World.h"
 
 using namespace Config;
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
 
-using Microsoft::WRL::ComPtr;
+namespace
+{
+// Profiler zone of each behavior module type
+const char* GetBehaviorZoneName(BehaviorModuleType type)
+{
+    switch (type)
+    {
+    case BehaviorModuleType::Follow:        return "Follow behavior";
+    case BehaviorModuleType::PlayerInput:   return "PlayerInput behavior";
+    default:                                return "Behavior";
+    }
+}
+}
 
-GameObject::GameObject(Vector2 position, ID3D11Device2* device) :
+GameObject::GameObject(Vector2 position, ID3D11Device2* device, const ArchetypeTable& archetypes, uint16_t archetype) :
     m_acceleration(Vector2::Zero),
     m_angularVelocity(0.f),
-    m_coefficientFriction(GameObject_DefaultCoefficientFriction),
-    m_coefficientRestitution(GameObject_DefaultCoefficientRestitution),
+    m_archetype(&archetypes.Get(archetype)),
+    m_archetypeIndex(archetype),
+    m_chunkIndex(UINT32_MAX),
     m_forceAccumulated(Vector2::Zero),
-    m_inertia(0.f),
+    m_id(0),
     m_isValidTarget(true),
-    m_mass(GameObject_DefaultMass),
-    m_maxAcceleration(GameObject_DefaultMaxAcceleration),
-    m_maxAngularVelocity(GameObject_DefaultMaxAngularVelocity),
-    m_maxSpeed(GameObject_DefaultMaxSpeed),
     m_movementCalculation(MovementCalculationType::MovementCalculation_AddForces),
-    m_position(position),
-    m_rotation(0.f),
+    m_position(ToKinematic(position)),
+    m_previousPosition(position),
+    m_previousRotation(0.f),
+    m_radius(archetypes.Get(archetype).radius),
+    m_rotation(ToKinematic(0.f)),
     m_speed(0.f),
     m_teamNumber(0),
-    m_textureOrigin(Vector2::Zero),
     m_textureTint(Colors::White.v),
     m_torqueAccumulated(0.f),
-    m_velocity(Vector2::Zero)
+    m_velocity(ToKinematic(Vector2::Zero))
 {
+    // CreateTexture refines the radius (and so the inertia) from the texture size. Only objects created for a
+    // device are drawn; the others keep the archetype's radius.
     if (device)
     {
-        CreateTexture(device);
+        CreateTexture();
     }
 }
 
@@ -42,34 +58,50 @@ GameObject::~GameObject()
 }
 
 void GameObject::Update(World* world, float elapsedTime)
+{
+    SavePreviousTransform();
+    RunBehaviors(world, elapsedTime);
+
+#if defined(FIXED_POINT_SIMULATION)
+    IntegrateFixedPoint(world, elapsedTime);
+#else
+    IntegrateVelocity(world, elapsedTime, FastMath::Normalize(-m_velocity));
+    IntegratePosition(world, elapsedTime, FastMath::Length(m_velocity), FastMath::Atan2(m_velocity.y, m_velocity.x));
+#endif
+}
+
+size_t GameObject::RunBehaviors(World* world, float elapsedTime)
 {
     // Run behavior modules.
+    size_t count = 0;
     for (const auto& behaviorModuleMapPair : m_behaviorModules)
     {
         auto behaviorModule = behaviorModuleMapPair.second;
         if (behaviorModule->IsEnabled())
         {
+            PROFILE_ZONE(GetBehaviorZoneName(behaviorModule->GetType()));
             behaviorModule->Run(world, this, elapsedTime);
+            ++count;
         }
     }
-    
+    return count;
+}
+
+#if !defined(FIXED_POINT_SIMULATION)
+void GameObject::IntegrateVelocity(World* world, float elapsedTime, Vector2 frictionDirection)
+{
     // Apply friction.
-    auto friction = -m_velocity;
-    friction.Normalize();
-    friction *= world->GetFrictionCoefficient() * m_mass * World_Gravity;
+    auto friction = frictionDirection * (world->GetFrictionCoefficient() * m_archetype->mass * world->GetGravity());
     m_forceAccumulated += friction;
 
     // TODO: verify this "rotational friction" is valid
     m_angularVelocity -= m_angularVelocity * world->GetFrictionCoefficient();
 
-    auto right = Vector2(-std::sinf(m_rotation), std::cosf(m_rotation));
-    auto forward = Vector2(std::cosf(m_rotation), std::sinf(m_rotation));
-
     // ** Update position and velocity using Semi-implicit Euler Method integration (https://en.wikipedia.org/wiki/Semi-implicit_Euler_method)
 
     // Calculate acceleration.
-    m_acceleration = m_forceAccumulated / m_mass;
-    float angularAcceleration = m_torqueAccumulated / m_inertia;
+    m_acceleration = m_forceAccumulated / m_archetype->mass;
+    float angularAcceleration = m_torqueAccumulated / GetInertia();
 
     // Update velocity.
     m_velocity += m_acceleration * elapsedTime;
@@ -78,9 +110,12 @@ void GameObject::Update(World* world, float elapsedTime)
     // Apply drag.
     //auto linearDrag = -m_velocity * (world->GetFrictionCoefficient() * elapsedTime);
     //m_velocity += linearDrag;
+}
 
+void GameObject::IntegratePosition(World* world, float elapsedTime, float speed, float heading)
+{
     // Update speed.
-    m_speed = m_velocity.Length();
+    m_speed = speed;
 
     // Adjust speed and velocity as necessary for min and max threshholds.
     if (m_speed < 0.1f)
@@ -88,18 +123,18 @@ void GameObject::Update(World* world, float elapsedTime)
         m_speed = 0.f;
         m_velocity = Vector2::Zero;
     }
-    else if (m_speed > m_maxSpeed)
+    else if (m_speed > m_archetype->maxSpeed)
     {
-        m_velocity *= m_maxSpeed / m_speed;
+        m_velocity *= m_archetype->maxSpeed / m_speed;
     }
 
     if (std::abs(m_angularVelocity) < 0.001f)
     {
         m_angularVelocity = 0.f;
     }
-    else if (m_angularVelocity > m_maxAngularVelocity)
+    else if (m_angularVelocity > m_archetype->maxAngularVelocity)
     {
-        m_angularVelocity *= m_maxAngularVelocity / m_angularVelocity;
+        m_angularVelocity *= m_archetype->maxAngularVelocity / m_angularVelocity;
     }
 
     // Update position.
@@ -111,32 +146,40 @@ void GameObject::Update(World* world, float elapsedTime)
     // Turn the object towards its velocity. (TODO: TO BE REPLACED)
     if (m_speed > 0.f)
     {
-        m_rotation = std::atan2f(m_velocity.y, m_velocity.x);
+        m_rotation = heading;
     }
     // TODO: limit turn amount based on max angular rotation speed.
 
+    FinishIntegration(world);
+}
+#endif
+
+void GameObject::FinishIntegration(World* world)
+{
     // TODO: move this boundary check into World Update() under collision detection / resolution
     // Check boundaries and reflect off walls if necessary.
-    auto worldRect = world->GetWorldBoundary();
+    // Works on the kinematic types, so it is exact in both builds: reflecting off a wall negates one component.
+    auto worldRect = ToKinematic(world->GetWorldBoundary());
+    auto zero = KinematicScalar();
     if (m_position.x > worldRect.x)
     {
         m_position.x = worldRect.x;
-        m_velocity = Vector2::Reflect(m_velocity, Vector2(-1, 0));
+        m_velocity.x = -m_velocity.x;
     }
-    else if (m_position.x < 0)
+    else if (m_position.x < zero)
     {
-        m_position.x = 0.f;
-        m_velocity = Vector2::Reflect(m_velocity, Vector2(1, 0));
+        m_position.x = zero;
+        m_velocity.x = -m_velocity.x;
     }
     else if (m_position.y > worldRect.y)
     {
         m_position.y = worldRect.y;
-        m_velocity = Vector2::Reflect(m_velocity, Vector2(0, -1));
+        m_velocity.y = -m_velocity.y;
     }
-    else if (m_position.y < 0)
+    else if (m_position.y < zero)
     {
-        m_position.y = 0.f;
-        m_velocity = Vector2::Reflect(m_velocity, Vector2(0, 1));
+        m_position.y = zero;
+        m_velocity.y = -m_velocity.y;
     }
 
     // Reset accumulated forces in preparation for the next frame.
@@ -144,28 +187,138 @@ void GameObject::Update(World* world, float elapsedTime)
     m_torqueAccumulated = 0.f;
 }
 
-void GameObject::Render(SpriteBatch* spriteBatch)
+#if defined(FIXED_POINT_SIMULATION)
+void GameObject::IntegrateFixedPoint(World* world, float elapsedTime)
 {
-    spriteBatch->Draw(m_texture.Get(), m_position, nullptr, m_textureTint, m_rotation, m_textureOrigin);
+    using namespace FixedPoint;
+
+    // Same steps as IntegrateVelocity and IntegratePosition, but every operation is done in Q16.16 so the
+    // result does not depend on the compiler, instruction set or math library. Position, velocity and
+    // rotation are kept in Q16.16; only the other inputs are quantized on the way in.
+    auto dt = Fixed::FromFloat(elapsedTime);
+    auto frictionCoefficient = Fixed::FromFloat(world->GetFrictionCoefficient());
+    auto mass = Fixed::FromFloat(m_archetype->mass);
+    auto inertia = Fixed::FromFloat(GetInertia());
+    auto maxSpeed = Fixed::FromFloat(m_archetype->maxSpeed);
+    auto maxAngularVelocity = Fixed::FromFloat(m_archetype->maxAngularVelocity);
+
+    auto position = m_position;
+    auto velocity = m_velocity;
+    FixedVector2 force(m_forceAccumulated);
+    auto rotation = m_rotation;
+    auto angularVelocity = Fixed::FromFloat(m_angularVelocity);
+    auto torque = Fixed::FromFloat(m_torqueAccumulated);
+
+    // Apply friction.
+    force += Normalize(-velocity) * (frictionCoefficient * mass * Fixed::FromFloat(world->GetGravity()));
+    angularVelocity -= angularVelocity * frictionCoefficient;
+
+    // Calculate acceleration.
+    auto acceleration = force / mass;
+    auto angularAcceleration = inertia.raw != 0 ? torque / inertia : Fixed();
+
+    // Update velocity.
+    velocity += acceleration * dt;
+    angularVelocity += angularAcceleration * dt;
+
+    // Update speed, and adjust speed and velocity as necessary for min and max threshholds.
+    auto speed = Length(velocity);
+    if (speed < Fixed::FromFloat(0.1f))
+    {
+        speed = Fixed();
+        velocity = FixedVector2();
+    }
+    else if (speed > maxSpeed)
+    {
+        velocity *= maxSpeed / speed;
+    }
+
+    if (Abs(angularVelocity) < Fixed::FromFloat(0.001f))
+    {
+        angularVelocity = Fixed();
+    }
+    else if (angularVelocity > maxAngularVelocity)
+    {
+        angularVelocity = maxAngularVelocity;
+    }
+
+    // Update position.
+    position += velocity * dt;
+    rotation += angularVelocity * dt;
+
+    // Turn the object towards its velocity. (TODO: TO BE REPLACED)
+    if (speed.raw > 0)
+    {
+        rotation = Atan2(velocity.y, velocity.x);
+    }
+
+    m_acceleration = acceleration.ToVector2();
+    m_angularVelocity = angularVelocity.ToFloat();
+    m_position = position;
+    m_rotation = rotation;
+    m_speed = speed.ToFloat();
+    m_velocity = velocity;
+
+    FinishIntegration(world);
 }
+#endif
 
-void GameObject::RenderDebugInfo(PrimitiveBatch<VertexPositionColor>* primitiveBatch)
+void GameObject::Render(SpriteInstance* sprite)
 {
-    VertexPositionColor pos;
+    sprite->position = GetPosition();
+    sprite->previousPosition = m_previousPosition;
+    sprite->rotation = GetRotation();
+    sprite->previousRotation = m_previousRotation;
+    sprite->tint = PackColor(m_textureTint);
+    sprite->texture = m_texture ? m_texture->index : SpriteInstance::NoTexture;
+}
 
-    VertexPositionColor velocity(m_position + m_velocity, Colors::Green);
-    VertexPositionColor acceleration(m_position + m_acceleration, Colors::Red);
+void GameObject::RenderDebugInfo(DebugGeometry* debugGeometry)
+{
+    auto position = GetPosition();
+    auto velocity = GetVelocity();
 
-    pos = VertexPositionColor(m_position, Colors::Green);
-    primitiveBatch->DrawLine(pos, velocity);
-    pos = VertexPositionColor(m_position, Colors::Red);
-    primitiveBatch->DrawLine(pos, acceleration);
+    // Everything the object draws itself lies within this distance of it, so it is culled as a whole.
+    auto reach = std::max(std::max(velocity.Length(), m_acceleration.Length()), m_radius);
+    if (debugGeometry->IsVisible(position - Vector2(reach), position + Vector2(reach)))
+    {
+        // Drawn where the sprite is, between updates.
+        debugGeometry->SetMove(position - m_previousPosition);
 
-    // Render debug info from behavior modules.
-    for (const auto& behaviorModuleMapPair : m_behaviorModules)
+        if (debugGeometry->IsEnabled(DebugCategory_Velocity))
+        {
+            debugGeometry->DrawLine(VertexPositionColor(position, Colors::Green), VertexPositionColor(position + velocity, Colors::Green));
+        }
+
+        if (debugGeometry->IsEnabled(DebugCategory_Acceleration))
+        {
+            debugGeometry->DrawLine(VertexPositionColor(position, Colors::Red), VertexPositionColor(position + m_acceleration, Colors::Red));
+        }
+
+        if (debugGeometry->IsEnabled(DebugCategory_Sensors))
+        {
+            // Collision radius, as an octagon.
+            const int Sides = 8;
+            auto previous = position + Vector2(m_radius, 0.f);
+            for (int i = 1; i <= Sides; ++i)
+            {
+                auto angle = float(i) * XM_2PI / Sides;
+                auto next = position + Vector2(std::cos(angle), std::sin(angle)) * m_radius;
+                debugGeometry->DrawLine(VertexPositionColor(previous, Colors::Yellow), VertexPositionColor(next, Colors::Yellow));
+                previous = next;
+            }
+        }
+
+        debugGeometry->SetMove(Vector2::Zero);
+    }
+
+    // Behavior modules draw targets (and cull them) themselves.
+    if (debugGeometry->IsEnabled(DebugCategory_Targets))
     {
-        auto behaviorModule = behaviorModuleMapPair.second;
-        behaviorModule->RenderDebugInfo(primitiveBatch);
+        for (const auto& behaviorModuleMapPair : m_behaviorModules)
+        {
+            behaviorModuleMapPair.second->RenderDebugInfo(debugGeometry);
+        }
     }
 }
 
@@ -179,31 +332,60 @@ void GameObject::AddBehaviorModule(std::shared_ptr<BehaviorModule> behaviorModul
     m_behaviorModules.insert(std::pair<char, std::shared_ptr<BehaviorModule>>(priority, behaviorModule));
 }
 
-void GameObject::CreateTexture(ID3D11Device2* device)
+void GameObject::SaveState(GameObjectState* state) const
 {
-    ComPtr<ID3D11Resource> resource;
-    DX::ThrowIfFailed(
-        CreateWICTextureFromFile(device, GameObject_DefaultTextureFile, resource.GetAddressOf(), m_texture.ReleaseAndGetAddressOf())
-    );
-
-    ComPtr<ID3D11Texture2D> texture;
-    DX::ThrowIfFailed(resource.As(&texture));
+    state->position = m_position;
+    state->velocity = m_velocity;
+    state->acceleration = m_acceleration;
+    state->forceAccumulated = m_forceAccumulated;
+    state->textureTint = m_textureTint;
+    state->rotation = m_rotation;
+    state->angularVelocity = m_angularVelocity;
+    state->speed = m_speed;
+    state->torqueAccumulated = m_torqueAccumulated;
+    state->radius = m_radius;
+    state->id = m_id;
+    state->archetype = m_archetypeIndex;
+    state->movementCalculation = uint8_t(m_movementCalculation);
+    state->isValidTarget = m_isValidTarget ? 1 : 0;
+}
 
-    CD3D11_TEXTURE2D_DESC textureDesc;
-    texture->GetDesc(&textureDesc);
+void GameObject::LoadState(const GameObjectState& state, const ArchetypeTable& archetypes)
+{
+    m_position = state.position;
+    m_velocity = state.velocity;
+    m_acceleration = state.acceleration;
+    m_forceAccumulated = state.forceAccumulated;
+    m_textureTint = state.textureTint;
+    m_rotation = state.rotation;
+    m_angularVelocity = state.angularVelocity;
+    m_speed = state.speed;
+    m_torqueAccumulated = state.torqueAccumulated;
+    m_radius = state.radius;
+    m_id = state.id;
+    SetArchetype(archetypes, state.archetype);
+    m_movementCalculation = MovementCalculationType(state.movementCalculation);
+    m_isValidTarget = state.isValidTarget != 0;
+
+    // Nothing to blend from across a restore.
+    SavePreviousTransform();
+}
 
-    m_textureOrigin.x = float(textureDesc.Width / 2);
-    m_textureOrigin.y = float(textureDesc.Height / 2);
+void GameObject::CreateTexture()
+{
+    m_texture = TextureCache::Default().Get(GameObject_DefaultTextureFile);
 
-    // Calculate inertia based on object mass and texture width (assume circular shape)
+    // Collision bounds (and so inertia) from the texture size
     // TODO: also use Shape to calculate inertia
-    auto radius = m_textureOrigin.x;
-    m_inertia = 0.5f * m_mass * radius * radius;
+    if (m_texture)
+    {
+        m_radius = m_texture->radius;
+    }
 }
 
 void GameObject::ResetTexture()
 {
-    m_texture.Reset();
+    m_texture.reset();
 }
 
 void GameObject::AddForceAtPosition(Vector2 force, Vector2 position)
@@ -214,7 +396,8 @@ void GameObject::AddForceAtPosition(Vector2 force, Vector2 position)
 
 void GameObject::AddImpulseAtPosition(Vector2 impulse, Vector2 position)
 {
-    m_velocity += impulse * m_mass;
-    m_speed = m_velocity.Length();
-    m_angularVelocity += position.Cross(impulse).Length() * m_inertia;
+    auto velocity = GetVelocity() + impulse * m_archetype->mass;
+    SetVelocity(velocity);
+    m_speed = velocity.Length();
+    m_angularVelocity += position.Cross(impulse).Length() * GetInertia();
 }
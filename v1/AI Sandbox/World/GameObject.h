@@ -1,6 +1,9 @@
 #pragma once
 
+#include "ArchetypeTable.h"
 #include "BehaviorModule.h"
+#include "FixedPoint.h"
+#include "TextureCache.h"
 
 enum class MovementCalculationType
 {
@@ -21,25 +24,93 @@ enum class MovementCalculationType
 //    }
 //};
 
+struct SpriteInstance;
 class World;
 
+// Types of the kinematic state the integration advances: Q16.16 when built with FIXED_POINT_SIMULATION, so
+// the state is exactly what the deterministic integration computed rather than rounded through float every
+// update, and float otherwise. Code outside the integration reads and writes it as float (collisions and
+// dormant chunks, so only the objects they touch are rounded).
+#if defined(FIXED_POINT_SIMULATION)
+typedef FixedPoint::FixedVector2        KinematicVector2;
+typedef FixedPoint::Fixed               KinematicScalar;
+
+inline KinematicVector2 ToKinematic(DirectX::SimpleMath::Vector2 value) { return FixedPoint::FixedVector2(value); }
+inline KinematicScalar ToKinematic(float value) { return FixedPoint::Fixed::FromFloat(value); }
+inline DirectX::SimpleMath::Vector2 FromKinematic(const KinematicVector2& value) { return value.ToVector2(); }
+inline float FromKinematic(KinematicScalar value) { return value.ToFloat(); }
+#else
+typedef DirectX::SimpleMath::Vector2    KinematicVector2;
+typedef float                           KinematicScalar;
+
+inline KinematicVector2 ToKinematic(DirectX::SimpleMath::Vector2 value) { return value; }
+inline KinematicScalar ToKinematic(float value) { return value; }
+inline DirectX::SimpleMath::Vector2 FromKinematic(const KinematicVector2& value) { return value; }
+inline float FromKinematic(KinematicScalar value) { return value; }
+#endif
+
+typedef std::multimap<char, std::shared_ptr<BehaviorModule>> BehaviorModules;
+
+// Everything about a game object that the simulation changes or reads, as plain data that can be copied in
+// bulk (see World::SaveSnapshot). Behaviors, the texture and world bookkeeping are kept elsewhere, and
+// characteristics shared with other objects are in the archetype.
+struct GameObjectState
+{
+    KinematicVector2                position;
+    KinematicVector2                velocity;
+    DirectX::SimpleMath::Vector2    acceleration;
+    DirectX::SimpleMath::Vector2    forceAccumulated;
+    DirectX::SimpleMath::Color      textureTint;
+    KinematicScalar                 rotation;
+    float                           angularVelocity;
+    float                           speed;
+    float                           torqueAccumulated;
+    float                           radius;
+    uint32_t                        id;
+    uint16_t                        archetype; // index in the world's ArchetypeTable
+    uint8_t                         movementCalculation;
+    uint8_t                         isValidTarget;
+};
+
 class GameObject
 {
 public:
-    GameObject(DirectX::SimpleMath::Vector2 position, ID3D11Device2* device);
+    // The table must outlive the object (it is normally the world's, see World::GetArchetypes).
+    GameObject(DirectX::SimpleMath::Vector2 position, ID3D11Device2* device, const ArchetypeTable& archetypes,
+        uint16_t archetype = ArchetypeTable::DefaultArchetype);
     virtual ~GameObject();
 
     // Common functions
     void Update(World* world, float elapsedTime);
-    void Render(DirectX::SpriteBatch* spriteBatch);
-    virtual void RenderDebugInfo(DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* primitiveBatch);
+    void Render(SpriteInstance* sprite);
+    virtual void RenderDebugInfo(DebugGeometry* debugGeometry);
+
+    // Update phases, for callers that update many objects at once (see World::Update). Update() runs them in turn.
+    size_t RunBehaviors(World* world, float elapsedTime); // returns the number of modules run
+#if defined(FIXED_POINT_SIMULATION)
+    void IntegrateFixedPoint(World* world, float elapsedTime); // deterministic replacement for both Integrate phases
+#else
+    void IntegrateVelocity(World* world, float elapsedTime, DirectX::SimpleMath::Vector2 frictionDirection);
+    void IntegratePosition(World* world, float elapsedTime, float speed, float heading); // speed and heading of the integrated velocity
+#endif
+
+    // Keep the current position and rotation as the previous ones, which drawing blends from. Called before
+    // each update changes them.
+    void SavePreviousTransform() { m_previousPosition = GetPosition(); m_previousRotation = GetRotation(); }
+    DirectX::SimpleMath::Vector2 GetPreviousPosition() const { return m_previousPosition; }
 
     // Behavior control
     void AddBehaviorModule(std::shared_ptr<BehaviorModule> behaviorModule); // use default priority level for this BehaviorModule
     void AddBehaviorModule(std::shared_ptr<BehaviorModule> behaviorModule, char priority);
+    const BehaviorModules& GetBehaviorModules() { return m_behaviorModules; }
+    void RemoveAllBehaviorModules() { m_behaviorModules.clear(); }
+
+    // Snapshot support
+    void SaveState(GameObjectState* state) const;
+    void LoadState(const GameObjectState& state, const ArchetypeTable& archetypes); // state.archetype must be in the table
 
     // Texture control
-    void CreateTexture(ID3D11Device2* device);
+    void CreateTexture(); // through TextureCache::Default(), with the decoder the game gave it
     void ResetTexture();
 
     // World control
@@ -49,61 +120,83 @@ public:
     void AddTorque(float torque) { m_torqueAccumulated += torque; }
 
     DirectX::SimpleMath::Vector2 GetAcceleration() { return m_acceleration; }
-    float GetRotation() { return m_rotation; }
-    float GetMaxAcceleration() { return m_maxAcceleration; }
-    float GetMaxSpeed() { return m_maxSpeed; }
-    DirectX::SimpleMath::Vector2 GetPosition() { return m_position; } 
+    float GetAngularVelocity() { return m_angularVelocity; }
+    uint16_t GetArchetypeIndex() { return m_archetypeIndex; }
+    float GetCoefficientFriction() { return m_archetype->coefficientFriction; }
+    float GetCoefficientRestitution() { return m_archetype->coefficientRestitution; }
+    uint32_t GetChunkIndex() { return m_chunkIndex; }
+    uint32_t GetId() { return m_id; }
+    float GetInertia() { return 0.5f * m_archetype->mass * m_radius * m_radius; } // assume circular shape
+    float GetMass() { return m_archetype->mass; }
+    float GetRadius() { return m_radius; }
+    float GetRotation() { return FromKinematic(m_rotation); }
+    float GetMaxAcceleration() { return m_archetype->maxAcceleration; }
+    float GetMaxAngularVelocity() { return m_archetype->maxAngularVelocity; }
+    float GetMaxSpeed() { return m_archetype->maxSpeed; }
+    DirectX::SimpleMath::Vector2 GetPosition() { return FromKinematic(m_position); }
     float GetSpeed() { return m_speed; }
     size_t GetTeamNumber() { return m_teamNumber; }
-    DirectX::SimpleMath::Vector2 GetVelocity() { return m_velocity; }
+    DirectX::SimpleMath::Vector2 GetVelocity() { return FromKinematic(m_velocity); }
+
+    // The kinematic state as stored, for steering that works in the integration's own types
+    const KinematicVector2& GetKinematicPosition() { return m_position; }
+    const KinematicVector2& GetKinematicVelocity() { return m_velocity; }
+    void SetKinematicVelocity(const KinematicVector2& velocity) { m_velocity = velocity; }
 
     bool IsValidTarget() { return m_isValidTarget; }
 
-    void SetRotation(float rotation) { m_rotation = rotation; }
-    void SetPosition(DirectX::SimpleMath::Vector2 position) { m_position = position; }
+    void SetAngularVelocity(float angularVelocity) { m_angularVelocity = angularVelocity; }
+    void SetArchetype(const ArchetypeTable& archetypes, uint16_t archetype) { m_archetype = &archetypes.Get(archetype); m_archetypeIndex = archetype; }
+    void SetChunkIndex(uint32_t chunkIndex) { m_chunkIndex = chunkIndex; } // normally should only be used by World methods
+    void SetId(uint32_t id) { m_id = id; } // normally should only be used by World methods
+    void SetRotation(float rotation) { m_rotation = ToKinematic(rotation); }
+    void SetPosition(DirectX::SimpleMath::Vector2 position) { m_position = ToKinematic(position); }
     void SetTeamNumber(size_t teamNumber) { m_teamNumber = teamNumber; } // normally should only be used by World methods
     void SetTextureTint(DirectX::SimpleMath::Color tint) { m_textureTint = tint; }
     void SetValidTarget(bool isValidTarget) { m_isValidTarget = isValidTarget; }
-    void SetVelocity(DirectX::SimpleMath::Vector2 velocity) { m_velocity = velocity; }
+    void SetVelocity(DirectX::SimpleMath::Vector2 velocity) { m_velocity = ToKinematic(velocity); }
 
     MovementCalculationType m_movementCalculation;
 
 private:
-    // Position
-    DirectX::SimpleMath::Vector2 m_position;
-    float m_rotation; // radians
+    // Keep the object inside the world and clear this update's forces.
+    void FinishIntegration(World* world);
+
+    // Position, and the rest of what drawing reads: together, so the sprite stream (which visits every active
+    // object each frame) touches as few cache lines as possible
+    KinematicVector2 m_position;
+    KinematicScalar m_rotation; // radians
+    TextureHandle m_texture; // shared with every object drawn with it (see TextureCache)
+    DirectX::SimpleMath::Color m_textureTint;
+    DirectX::SimpleMath::Vector2 m_previousPosition; // before the latest update
+    float m_previousRotation; // radians
 
     // Velocity
     float m_angularVelocity; // radians per second
-    float m_maxAngularVelocity; // radians per second
-    float m_maxSpeed; // meters per second
     float m_speed; // meters per second
-    DirectX::SimpleMath::Vector2 m_velocity; // meters per second
+    KinematicVector2 m_velocity; // meters per second
 
     // Acceleration
     DirectX::SimpleMath::Vector2 m_acceleration; // meters per second per second
-    float m_maxAcceleration; // meters per second per second
 
     // Forces
     DirectX::SimpleMath::Vector2 m_forceAccumulated; // Newtons
     float m_torqueAccumulated;
 
-    // Mass
-    float m_mass; // kilograms
-    float m_inertia;
+    // Mass, limits and material characteristics
+    const Archetype* m_archetype;
+    uint16_t m_archetypeIndex;
 
-    // Shape, Texture, and Other Material Characteristics
-    float m_coefficientFriction;
-    float m_coefficientRestitution;
+    // Shape
+    float m_radius; // collision bounds (assume circular shape)
     // Shape m_shape; // TODO: includes functions for calculating inertia, getting collision bounds
-    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_texture;
-    DirectX::SimpleMath::Vector2 m_textureOrigin;
-    DirectX::SimpleMath::Color m_textureTint;
 
     // Behavior
-    std::multimap<char, std::shared_ptr<BehaviorModule>> m_behaviorModules;
+    BehaviorModules m_behaviorModules;
 
     // Other
+    uint32_t m_chunkIndex; // WorldPartition chunk that owns the object
+    uint32_t m_id; // unique within the object's world
     bool m_isValidTarget;
     size_t m_teamNumber;
 };
@@ -1,11 +1,39 @@
 #include "pch.h"
+#include "GameObject.h"
 #include "GameObjectFactory.h"
 
+// Behavior modules
+#include "FollowBehavior.h"
+#include "PlayerInput.h"
 
-GameObjectFactory::GameObjectFactory()
+using namespace DirectX::SimpleMath;
+
+GameObjectFactory::GameObjectFactory(ID3D11Device2* device, InputResources* inputResources) :
+    m_device(device),
+    m_inputResources(inputResources)
 {
 }
 
 GameObjectFactory::~GameObjectFactory()
 {
 }
+
+std::shared_ptr<GameObject> GameObjectFactory::CreateGameObject(Vector2 position, const ArchetypeTable& archetypes, uint16_t archetype) const
+{
+    return std::make_shared<GameObject>(position, m_device, archetypes, archetype);
+}
+
+std::shared_ptr<BehaviorModule> GameObjectFactory::CreateBehaviorModule(BehaviorModuleType type) const
+{
+    switch (type)
+    {
+    case BehaviorModuleType::Follow:
+        return std::make_shared<FollowBehavior>();
+
+    case BehaviorModuleType::PlayerInput:
+        return std::make_shared<PlayerInput>(m_inputResources);
+
+    default:
+        return nullptr;
+    }
+}
@@ -1,8 +1,27 @@
 #pragma once
 
+#include "ArchetypeTable.h"
+#include "BehaviorModule.h"
+
+class GameObject;
+class InputResources;
+
+// Creates game objects and behavior modules for code that knows what to create but not how to set it up,
+// such as World::RestoreSnapshot re-creating objects that no longer exist.
 class GameObjectFactory
 {
 public:
-    GameObjectFactory();
+    // device may be null (no textures); inputResources is handed to PlayerInput modules.
+    GameObjectFactory(ID3D11Device2* device, InputResources* inputResources);
     ~GameObjectFactory();
+
+    std::shared_ptr<GameObject> CreateGameObject(DirectX::SimpleMath::Vector2 position, const ArchetypeTable& archetypes,
+        uint16_t archetype = ArchetypeTable::DefaultArchetype) const;
+
+    // Returns null for BehaviorModuleType::Unknown, and for Script (the World creates those on its scheduler).
+    std::shared_ptr<BehaviorModule> CreateBehaviorModule(BehaviorModuleType type) const;
+
+private:
+    ID3D11Device2*  m_device;
+    InputResources* m_inputResources;
 };
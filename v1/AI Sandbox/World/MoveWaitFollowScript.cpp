@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "FastMath.h"
+#include "FixedPoint.h"
+#include "GameObject.h"
+#include "MoveWaitFollowScript.h"
+#include "World.h"
+#include "WorldSnapshot.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+// Steering slows down on approach and friction stops an object a little short, so arriving is "close enough".
+const float ArrivalTolerance = 1.f;
+}
+
+MoveWaitFollowScript::MoveWaitFollowScript(Vector2 destination, float waitSeconds) :
+    m_destination(destination),
+    m_followTarget(nullptr),
+    m_waitSeconds(waitSeconds)
+{
+}
+
+MoveWaitFollowScript::~MoveWaitFollowScript()
+{
+}
+
+ScriptWait MoveWaitFollowScript::Resume(const ScriptContext& context)
+{
+    auto object = context.object;
+
+    SCRIPT_BEGIN;
+
+    while (!SteerTowards(object, ToKinematic(m_destination), object->GetRadius()))
+    {
+        SCRIPT_AWAIT(ScriptWait::NextTick());
+    }
+
+    object->SetVelocity(Vector2::Zero);
+    SCRIPT_AWAIT(ScriptWait::Delay(m_waitSeconds));
+
+    SCRIPT_AWAIT_UNTIL((m_followTarget = context.world->GetPlayer(0, 0)) != nullptr);
+    while (m_followTarget && m_followTarget->IsValidTarget()) // a target gone from the world is restored as none
+    {
+        SteerTowards(object, m_followTarget->GetKinematicPosition(), context.world->GetParameters().followDistance);
+        SCRIPT_AWAIT(ScriptWait::NextTick());
+    }
+
+    m_followTarget = nullptr;
+    object->SetVelocity(object->GetVelocity() * 0.5f);
+
+    SCRIPT_END;
+}
+
+void MoveWaitFollowScript::SaveState(SnapshotWriter* writer) const
+{
+    BehaviorScript::SaveState(writer);
+    writer->Write(m_destination);
+    writer->Write(m_waitSeconds);
+    writer->WriteObject(m_followTarget.get());
+}
+
+bool MoveWaitFollowScript::LoadState(SnapshotReader* reader)
+{
+    return BehaviorScript::LoadState(reader) && reader->Read(&m_destination) && reader->Read(&m_waitSeconds) &&
+        reader->ReadObject(&m_followTarget);
+}
+
+bool MoveWaitFollowScript::SteerTowards(GameObject* object, const KinematicVector2& position, float distance)
+{
+#if defined(FIXED_POINT_SIMULATION)
+    using namespace FixedPoint;
+
+    auto vectorToPosition = position - object->GetKinematicPosition();
+    auto remaining = Length(vectorToPosition) - Fixed::FromFloat(distance);
+    if (remaining <= Fixed::FromFloat(ArrivalTolerance))
+        return true;
+
+    object->SetKinematicVelocity(Normalize(vectorToPosition) * Min(Fixed::FromFloat(object->GetMaxSpeed()), remaining));
+#else
+    auto vectorToPosition = position - object->GetPosition();
+    auto remaining = FastMath::Length(vectorToPosition) - distance;
+    if (remaining <= ArrivalTolerance)
+        return true;
+
+    object->SetVelocity(FastMath::Normalize(vectorToPosition) * std::min(object->GetMaxSpeed(), remaining));
+#endif
+    return false;
+}
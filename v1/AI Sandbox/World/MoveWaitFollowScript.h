@@ -0,0 +1,27 @@
+#pragma once
+
+#include "BehaviorScript.h"
+#include "GameObject.h"
+
+// Move to a point, wait there, then follow the first player on team 0 (the human-controlled player) for as
+// long as it stays in the world.
+class MoveWaitFollowScript : public BehaviorScript
+{
+public:
+    MoveWaitFollowScript(DirectX::SimpleMath::Vector2 destination = DirectX::SimpleMath::Vector2::Zero, float waitSeconds = 0.f);
+    virtual ~MoveWaitFollowScript();
+
+    virtual ScriptWait Resume(const ScriptContext& context) override;
+    virtual BehaviorScriptType GetType() const override { return BehaviorScriptType::MoveWaitFollow; }
+    virtual void SaveState(SnapshotWriter* writer) const override;
+    virtual bool LoadState(SnapshotReader* reader) override;
+
+private:
+    // Set object's velocity toward position, to stop distance short of it. Returns true once there. Steering
+    // is in the object's kinematic types, so it is exact with FIXED_POINT_SIMULATION.
+    static bool SteerTowards(GameObject* object, const KinematicVector2& position, float distance);
+
+    DirectX::SimpleMath::Vector2    m_destination;
+    std::shared_ptr<GameObject>     m_followTarget;
+    float                           m_waitSeconds;
+};
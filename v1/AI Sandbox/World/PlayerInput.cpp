@@ -1,7 +1,9 @@
 #include "pch.h"
+#include "DebugGeometry.h"
 #include "GameObject.h"
 #include "PlayerInput.h"
 #include "World.h"
+#include "WorldSnapshot.h"
 
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
@@ -17,16 +19,16 @@ PlayerInput::~PlayerInput()
 {
 }
 
-void PlayerInput::RenderDebugInfo(DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* primitiveBatch)
+void PlayerInput::RenderDebugInfo(DebugGeometry* debugGeometry)
 {
-    if (m_useMoveTarget)
+    if (m_useMoveTarget && debugGeometry->IsVisible(m_moveTarget - Vector2(2.f), m_moveTarget + Vector2(2.f)))
     {
         // Draw triangle at target position.
         Vector2 targetPosition = m_moveTarget;
         VertexPositionColor v1(Vector3(targetPosition.x, targetPosition.y - 2.f, 0.f), Colors::White);
         VertexPositionColor v2(Vector3(targetPosition.x + 2.f, targetPosition.y + 2.f, 0.f), Colors::White);
         VertexPositionColor v3(Vector3(targetPosition.x - 2.f, targetPosition.y + 2.f, 0.f), Colors::White);
-        primitiveBatch->DrawTriangle(v1, v2, v3);
+        debugGeometry->DrawTriangle(v1, v2, v3);
     }
 }
 
@@ -42,7 +44,7 @@ void PlayerInput::Run(World* world, GameObject* object, float elapsedTime)
         if (mouseTracker.leftButton == ButtonState::PRESSED)
         {
             auto mouseState = mouseTracker.GetLastState();
-            m_moveTarget = Vector2(float(mouseState.x), float(mouseState.y));
+            m_moveTarget = world->ScreenToWorld(Vector2(float(mouseState.x), float(mouseState.y)));
             m_useMoveTarget = true;
         }
     }
@@ -110,3 +112,14 @@ void PlayerInput::Run(World* world, GameObject* object, float elapsedTime)
         }
     }
 }
+
+void PlayerInput::SaveState(SnapshotWriter* writer) const
+{
+    writer->Write(m_moveTarget);
+    writer->Write(m_useMoveTarget);
+}
+
+bool PlayerInput::LoadState(SnapshotReader* reader)
+{
+    return reader->Read(&m_moveTarget) && reader->Read(&m_useMoveTarget);
+}
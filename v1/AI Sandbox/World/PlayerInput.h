@@ -20,8 +20,11 @@ public:
 
     // Override functions
     virtual char GetDefaultPriorityLevel() const override { return Config::PlayerInput_DefaultPriorityLevel; }
-    virtual void RenderDebugInfo(DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* primitiveBatch) override;
+    virtual void RenderDebugInfo(DebugGeometry* debugGeometry) override;
     virtual void Run(World* world, GameObject* object, float elapsedTime) override;
+    virtual BehaviorModuleType GetType() const override { return BehaviorModuleType::PlayerInput; }
+    virtual void SaveState(SnapshotWriter* writer) const override;
+    virtual bool LoadState(SnapshotReader* reader) override;
 
 private:
     InputResources* m_inputResources;
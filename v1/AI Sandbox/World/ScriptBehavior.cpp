@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "ScriptBehavior.h"
+#include "WorldSnapshot.h"
+
+
+ScriptBehavior::ScriptBehavior(ScriptScheduler* scheduler, ScriptHandle script) :
+    m_scheduler(scheduler),
+    m_script(script)
+{
+    m_scheduler->SetOwner(m_script, this);
+}
+
+ScriptBehavior::ScriptBehavior(ScriptScheduler* scheduler) :
+    m_scheduler(scheduler),
+    m_script{ ScriptScheduler::NoSlot, 0 }
+{
+}
+
+ScriptBehavior::~ScriptBehavior()
+{
+    m_scheduler->Stop(m_script);
+}
+
+void ScriptBehavior::Run(World*, GameObject*, float)
+{
+}
+
+void ScriptBehavior::SaveState(SnapshotWriter* writer) const
+{
+    writer->Write(IsRunning() ? m_script.slot : ScriptScheduler::NoSlot);
+}
+
+bool ScriptBehavior::LoadState(SnapshotReader* reader)
+{
+    uint32_t slot;
+    if (!reader->Read(&slot))
+        return false;
+
+    m_script = m_scheduler->GetRestoredScript(slot);
+    m_scheduler->SetOwner(m_script, this);
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "BehaviorModule.h"
+#include "ScriptScheduler.h"
+
+// Attaches a script started on the world's ScriptScheduler to an object. The scheduler resumes the script, so
+// Run does nothing; the module ties the script's lifetime to the object's and stops it when removed.
+// Disabling the module pauses the script. Scripts run while their object is dormant too (movement they set on
+// a dormant object is overwritten by the WorldPartition). In a WorldSnapshot the scheduler saves the script and
+// the module saves which one it is.
+class ScriptBehavior : public BehaviorModule
+{
+public:
+    // The scheduler must outlive the module (both belong to the same World).
+    ScriptBehavior(ScriptScheduler* scheduler, ScriptHandle script);
+    explicit ScriptBehavior(ScriptScheduler* scheduler); // with no script until LoadState finds its restored one
+    virtual ~ScriptBehavior();
+
+    // Override functions
+    virtual void Run(World* world, GameObject* object, float elapsedTime) override;
+    virtual BehaviorModuleType GetType() const override { return BehaviorModuleType::Script; }
+    virtual void SaveState(SnapshotWriter* writer) const override;
+    virtual bool LoadState(SnapshotReader* reader) override;
+
+    // Module-specific functions
+    bool IsRunning() const { return m_scheduler->IsRunning(m_script); }
+
+private:
+    ScriptScheduler*    m_scheduler;
+    ScriptHandle        m_script;
+};
@@ -0,0 +1,391 @@
+#include "pch.h"
+#include "BehaviorModule.h"
+#include "GameObject.h"
+#include "ScriptScheduler.h"
+#include "WorldSnapshot.h"
+
+// Scripts
+#include "MoveWaitFollowScript.h"
+
+namespace
+{
+// Re-create a script from a snapshot, in a frame from the pool.
+template<typename TScript>
+BehaviorScript* CreateScript(ScriptFramePool* framePool, size_t* frameSize)
+{
+    *frameSize = sizeof(TScript);
+    return new (framePool->Allocate(sizeof(TScript))) TScript();
+}
+}
+
+const size_t ScriptFramePool::SizeClassCount;
+const size_t ScriptFramePool::MinFrameSize;
+const size_t ScriptFramePool::FramesPerBlock;
+const uint32_t ScriptScheduler::NoSlot;
+
+ScriptFramePool::ScriptFramePool() :
+    m_reservedBytes(0)
+{
+    std::fill(std::begin(m_freeFrames), std::end(m_freeFrames), nullptr);
+}
+
+ScriptFramePool::~ScriptFramePool()
+{
+}
+
+size_t ScriptFramePool::GetSizeClass(size_t size)
+{
+    size_t sizeClass = 0;
+    for (auto frameSize = MinFrameSize; frameSize < size && sizeClass < SizeClassCount; frameSize *= 2)
+    {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+void* ScriptFramePool::Allocate(size_t size)
+{
+    auto sizeClass = GetSizeClass(size);
+    if (sizeClass == SizeClassCount)
+        return ::operator new(size);
+
+    if (!m_freeFrames[sizeClass])
+    {
+        // Carve a new block into frames of this class.
+        auto frameSize = MinFrameSize << sizeClass;
+        m_blocks.emplace_back(new uint8_t[frameSize * FramesPerBlock]);
+        m_reservedBytes += frameSize * FramesPerBlock;
+
+        auto block = m_blocks.back().get();
+        for (size_t i = FramesPerBlock; i-- > 0;)
+        {
+            auto frame = reinterpret_cast<FreeFrame*>(block + i * frameSize);
+            frame->next = m_freeFrames[sizeClass];
+            m_freeFrames[sizeClass] = frame;
+        }
+    }
+
+    auto frame = m_freeFrames[sizeClass];
+    m_freeFrames[sizeClass] = frame->next;
+    return frame;
+}
+
+void ScriptFramePool::Free(void* frame, size_t size)
+{
+    auto sizeClass = GetSizeClass(size);
+    if (sizeClass == SizeClassCount)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    auto freeFrame = static_cast<FreeFrame*>(frame);
+    freeFrame->next = m_freeFrames[sizeClass];
+    m_freeFrames[sizeClass] = freeFrame;
+}
+
+ScriptScheduler::ScriptScheduler() :
+    m_resumingSlot(NoSlot),
+    m_sequence(0),
+    m_time(0.0)
+{
+}
+
+ScriptScheduler::~ScriptScheduler()
+{
+    StopAll();
+}
+
+ScriptHandle ScriptScheduler::Add(BehaviorScript* script, size_t frameSize, GameObject* object)
+{
+    uint32_t slot;
+    if (m_freeSlots.empty())
+    {
+        slot = uint32_t(m_slots.size());
+        m_slots.push_back({ nullptr, nullptr, nullptr, 0, 0 });
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    auto& entry = m_slots[slot];
+    entry.script = script;
+    entry.object = object;
+    entry.owner = nullptr;
+    entry.frameSize = frameSize;
+
+    Schedule(slot, ScriptWait::NextTick());
+    return { slot, entry.generation };
+}
+
+void ScriptScheduler::Release(uint32_t slot)
+{
+    auto& entry = m_slots[slot];
+    entry.script->~BehaviorScript();
+    m_framePool.Free(entry.script, entry.frameSize);
+    entry.script = nullptr;
+    entry.object = nullptr;
+    entry.owner = nullptr;
+    m_freeSlots.push_back(slot);
+}
+
+void ScriptScheduler::Stop(ScriptHandle handle)
+{
+    if (!IsRunning(handle))
+        return;
+
+    // Queued wakes for the old generation are skipped from now on.
+    ++m_slots[handle.slot].generation;
+
+    // A running script is released once it returns.
+    if (handle.slot != m_resumingSlot)
+    {
+        Release(handle.slot);
+    }
+}
+
+void ScriptScheduler::StopAll()
+{
+    for (uint32_t slot = 0; slot < uint32_t(m_slots.size()); ++slot)
+    {
+        if (m_slots[slot].script)
+        {
+            ++m_slots[slot].generation;
+            if (slot != m_resumingSlot)
+            {
+                Release(slot);
+            }
+        }
+    }
+
+    m_delayed.clear();
+    m_polled.clear();
+}
+
+bool ScriptScheduler::IsRunning(ScriptHandle handle) const
+{
+    return handle.slot < m_slots.size() && m_slots[handle.slot].script &&
+        m_slots[handle.slot].generation == handle.generation;
+}
+
+void ScriptScheduler::SetOwner(ScriptHandle handle, const BehaviorModule* owner)
+{
+    if (IsRunning(handle))
+    {
+        m_slots[handle.slot].owner = owner;
+    }
+}
+
+void ScriptScheduler::Schedule(uint32_t slot, ScriptWait wait)
+{
+    Wake wake = { m_time, m_sequence++, slot, m_slots[slot].generation };
+    if (wait.type == ScriptWaitType::Delay)
+    {
+        wake.time += wait.seconds;
+        m_delayed.push_back(wake);
+        std::push_heap(m_delayed.begin(), m_delayed.end(), WakesLater());
+    }
+    else
+    {
+        m_polled.push_back(wake);
+    }
+}
+
+void ScriptScheduler::Update(World* world, float elapsedTime)
+{
+    m_time += elapsedTime;
+
+    // Due this update: everything polled, then delays that end before the middle of the update (so a delay
+    // that is a whole number of updates is not pushed back one by rounding).
+    m_resuming.swap(m_polled);
+    auto dueTime = m_time + elapsedTime * 0.5;
+    while (!m_delayed.empty() && m_delayed.front().time <= dueTime)
+    {
+        std::pop_heap(m_delayed.begin(), m_delayed.end(), WakesLater());
+        m_resuming.push_back(m_delayed.back());
+        m_delayed.pop_back();
+    }
+
+    for (const auto& wake : m_resuming)
+    {
+        const auto& slot = m_slots[wake.slot];
+        if (!slot.script || slot.generation != wake.generation)
+            continue; // stopped since
+
+        if (slot.owner && !slot.owner->IsEnabled())
+        {
+            Schedule(wake.slot, ScriptWait::NextTick());
+            continue;
+        }
+
+        // Resuming may start scripts (growing m_slots) or stop this one.
+        ScriptContext context = { world, slot.object, elapsedTime };
+        m_resumingSlot = wake.slot;
+        auto wait = slot.script->Resume(context);
+        m_resumingSlot = NoSlot;
+
+        if (m_slots[wake.slot].generation != wake.generation)
+        {
+            Release(wake.slot);
+        }
+        else if (wait.type == ScriptWaitType::Done)
+        {
+            ++m_slots[wake.slot].generation;
+            Release(wake.slot);
+        }
+        else
+        {
+            Schedule(wake.slot, wait);
+        }
+    }
+
+    m_resuming.clear();
+}
+
+bool ScriptScheduler::IsSaved(const Slot& slot, const SnapshotWriter& writer)
+{
+    return slot.script && slot.script->GetType() != BehaviorScriptType::Unknown &&
+        writer.GetObjectIndex(slot.object) != SnapshotWriter::NoObject;
+}
+
+void ScriptScheduler::SaveState(SnapshotWriter* writer)
+{
+    writer->Write(m_time);
+    writer->Write(m_sequence);
+    writer->Write(uint32_t(m_slots.size()));
+
+    uint32_t scriptCount = 0;
+    for (const auto& slot : m_slots)
+    {
+        if (IsSaved(slot, *writer))
+        {
+            ++scriptCount;
+        }
+    }
+
+    writer->Write(scriptCount);
+    for (uint32_t slot = 0; slot < uint32_t(m_slots.size()); ++slot)
+    {
+        const auto& entry = m_slots[slot];
+        if (IsSaved(entry, *writer))
+        {
+            writer->Write(slot);
+            writer->WriteObject(entry.object);
+            writer->Write(entry.script->GetType());
+            entry.script->SaveState(writer);
+        }
+    }
+
+    // Wakes of saved scripts only; their generations are re-assigned on load.
+    auto saveWakes = [&](const std::vector<Wake>& wakes)
+    {
+        m_resuming.clear();
+        for (const auto& wake : wakes)
+        {
+            const auto& entry = m_slots[wake.slot];
+            if (entry.generation == wake.generation && IsSaved(entry, *writer))
+            {
+                m_resuming.push_back({ wake.time, wake.sequence, wake.slot, 0 });
+            }
+        }
+        writer->WriteArray(m_resuming.data(), m_resuming.size());
+    };
+    saveWakes(m_polled);
+    saveWakes(m_delayed);
+    m_resuming.clear();
+}
+
+bool ScriptScheduler::LoadState(SnapshotReader* reader)
+{
+    StopAll();
+
+    auto loaded = ReadState(reader);
+    if (!loaded)
+    {
+        StopAll();
+    }
+
+    // Every slot without a script is free (StopAll has listed some of them already).
+    m_freeSlots.clear();
+    for (auto slot = uint32_t(m_slots.size()); slot-- > 0;)
+    {
+        if (!m_slots[slot].script)
+        {
+            m_freeSlots.push_back(slot);
+        }
+    }
+
+    return loaded;
+}
+
+bool ScriptScheduler::ReadState(SnapshotReader* reader)
+{
+    uint32_t slotCount, scriptCount;
+    if (!reader->Read(&m_time) || !reader->Read(&m_sequence) || !reader->Read(&slotCount) || !reader->Read(&scriptCount) ||
+        scriptCount > slotCount)
+        return false;
+
+    if (m_slots.size() < slotCount)
+    {
+        m_slots.resize(slotCount, { nullptr, nullptr, nullptr, 0, 0 });
+    }
+
+    // Restored scripts keep their slots but take the slots' current generations, which StopAll has moved past
+    // every handle given out before: modules dropped by the restore cannot stop them.
+    for (uint32_t i = 0; i < scriptCount; ++i)
+    {
+        uint32_t slot;
+        std::shared_ptr<GameObject> object;
+        BehaviorScriptType type;
+        if (!reader->Read(&slot) || !reader->ReadObject(&object) || !reader->Read(&type) ||
+            slot >= slotCount || m_slots[slot].script || !object)
+            return false;
+
+        auto& entry = m_slots[slot];
+        switch (type)
+        {
+        case BehaviorScriptType::MoveWaitFollow:
+            entry.script = CreateScript<MoveWaitFollowScript>(&m_framePool, &entry.frameSize);
+            break;
+
+        default:
+            return false;
+        }
+
+        entry.object = object.get();
+        entry.owner = nullptr;
+        if (!entry.script->LoadState(reader))
+            return false;
+    }
+
+    if (!ReadWakes(reader, &m_polled) || !ReadWakes(reader, &m_delayed))
+        return false;
+
+    std::make_heap(m_delayed.begin(), m_delayed.end(), WakesLater());
+    return true;
+}
+
+bool ScriptScheduler::ReadWakes(SnapshotReader* reader, std::vector<Wake>* wakes) const
+{
+    if (!reader->ReadArray(wakes))
+        return false;
+
+    for (auto& wake : *wakes)
+    {
+        if (wake.slot >= m_slots.size() || !m_slots[wake.slot].script)
+            return false;
+
+        wake.generation = m_slots[wake.slot].generation;
+    }
+    return true;
+}
+
+ScriptHandle ScriptScheduler::GetRestoredScript(uint32_t slot) const
+{
+    if (slot >= m_slots.size() || !m_slots[slot].script)
+        return { NoSlot, 0 };
+
+    return { slot, m_slots[slot].generation };
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+
+#include "BehaviorScript.h"
+
+class BehaviorModule;
+class SnapshotReader;
+class SnapshotWriter;
+
+// Identifies a running script. Handles of finished or stopped scripts stay safe to use: they refer to nothing.
+struct ScriptHandle
+{
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// Fixed-size blocks for script frames, in a few size classes, recycled through free lists. Frames larger than
+// the biggest class come from the heap.
+class ScriptFramePool
+{
+public:
+    ScriptFramePool();
+    ~ScriptFramePool();
+
+    void* Allocate(size_t size);
+    void Free(void* frame, size_t size);
+
+    size_t GetReservedBytes() const { return m_reservedBytes; }
+
+private:
+    static const size_t SizeClassCount = 5;
+    static const size_t MinFrameSize = 64;      // bytes; each class doubles the previous one
+    static const size_t FramesPerBlock = 64;
+
+    struct FreeFrame
+    {
+        FreeFrame* next;
+    };
+
+    static size_t GetSizeClass(size_t size);    // SizeClassCount if too large for the pool
+
+    std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
+    FreeFrame*                              m_freeFrames[SizeClassCount];
+    size_t                                  m_reservedBytes;
+};
+
+// Runs the scripts of one world. Scripts waiting on a delay sit in a queue ordered by wake time and are not
+// touched until they are due; only scripts waiting for the next update or on a condition are resumed every
+// update. Scripts are resumed in a fixed order (per-update scripts first, in the order they started waiting,
+// then expired delays by wake time), so a simulation with scripts stays reproducible.
+class ScriptScheduler
+{
+public:
+    ScriptScheduler();
+    ~ScriptScheduler();
+
+    // Start a script on object. It is first resumed on the next Update.
+    template<typename TScript, typename... TArgs>
+    ScriptHandle Start(GameObject* object, TArgs&&... args)
+    {
+        static_assert(std::is_base_of<BehaviorScript, TScript>::value, "scripts derive from BehaviorScript");
+        static_assert(alignof(TScript) <= alignof(std::max_align_t), "script frames are max_align_t aligned");
+
+        auto frame = m_framePool.Allocate(sizeof(TScript));
+        return Add(new (frame) TScript(std::forward<TArgs>(args)...), sizeof(TScript), object);
+    }
+
+    // Stop a script and free its frame. A script may stop itself (or have its object removed) while it runs.
+    void Stop(ScriptHandle handle);
+    void StopAll();
+    bool IsRunning(ScriptHandle handle) const;
+
+    // Scripts of a disabled owner module are not resumed until it is enabled again.
+    void SetOwner(ScriptHandle handle, const BehaviorModule* owner);
+
+    // Resume every script that is due.
+    void Update(World* world, float elapsedTime);
+
+    size_t GetScriptCount() const { return m_slots.size() - m_freeSlots.size(); }
+    size_t GetReservedFrameBytes() const { return m_framePool.GetReservedBytes(); }
+
+    // Snapshot support: the clock, every script with its slot, object and state, and the wake queues, so
+    // scripts resume in the same order after a restore. Scripts of an Unknown type, or on an object no longer
+    // in the world, are left out. LoadState stops every running script first; owner modules then find their
+    // scripts again by slot with GetRestoredScript (a handle to nothing if that slot was not restored).
+    void SaveState(SnapshotWriter* writer);
+    bool LoadState(SnapshotReader* reader);
+    ScriptHandle GetRestoredScript(uint32_t slot) const;
+
+    static const uint32_t NoSlot = UINT32_MAX;
+
+private:
+    struct Slot
+    {
+        BehaviorScript*         script;
+        GameObject*             object;
+        const BehaviorModule*   owner;
+        size_t                  frameSize;
+        uint32_t                generation;
+    };
+
+    struct Wake
+    {
+        double      time;
+        uint64_t    sequence;
+        uint32_t    slot;
+        uint32_t    generation;
+    };
+
+    struct WakesLater
+    {
+        bool operator()(const Wake& a, const Wake& b) const
+        {
+            return a.time > b.time || (a.time == b.time && a.sequence > b.sequence);
+        }
+    };
+
+    ScriptHandle Add(BehaviorScript* script, size_t frameSize, GameObject* object);
+    void Release(uint32_t slot);
+    void Schedule(uint32_t slot, ScriptWait wait);
+
+    // LoadState without the cleanup after a malformed snapshot
+    bool ReadState(SnapshotReader* reader);
+    static bool IsSaved(const Slot& slot, const SnapshotWriter& writer);
+    bool ReadWakes(SnapshotReader* reader, std::vector<Wake>* wakes) const;
+
+    ScriptFramePool         m_framePool;
+    std::vector<Slot>       m_slots;
+    std::vector<uint32_t>   m_freeSlots;
+
+    std::vector<Wake>       m_delayed;      // min-heap on wake time
+    std::vector<Wake>       m_polled;       // resumed on the next update
+    std::vector<Wake>       m_resuming;     // scratch for Update and SaveState
+    uint32_t                m_resumingSlot; // script currently running, if any
+    uint64_t                m_sequence;
+    double                  m_time;         // seconds of updates so far
+};
@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "SpatialGrid.h"
+
+using namespace DirectX::SimpleMath;
+
+SpatialGrid::SpatialGrid() :
+    m_bucketMask(0),
+    m_cellSize(1.f),
+    m_inverseCellSize(1.f)
+{
+}
+
+SpatialGrid::~SpatialGrid()
+{
+}
+
+void SpatialGrid::Build(const Vector2* positions, size_t count, float cellSize)
+{
+    m_cellSize = std::max(cellSize, 0.001f);
+    m_inverseCellSize = 1.f / m_cellSize;
+
+    // Use roughly two buckets per point, rounded up to a power of two so hashing is a mask.
+    uint32_t bucketCount = 16;
+    while (bucketCount < count * 2)
+    {
+        bucketCount <<= 1;
+    }
+    m_bucketMask = bucketCount - 1;
+
+    m_unsortedEntries.resize(count);
+    m_entries.resize(count);
+    m_bucketStart.assign(size_t(bucketCount) + 1, 0);
+
+    // Count entries per bucket...
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& entry = m_unsortedEntries[i];
+        entry.cellX = CellCoordinate(positions[i].x);
+        entry.cellY = CellCoordinate(positions[i].y);
+        entry.index = uint32_t(i);
+        ++m_bucketStart[HashCell(entry.cellX, entry.cellY) + 1];
+    }
+
+    // ...turn the counts into start offsets...
+    for (uint32_t b = 0; b < bucketCount; ++b)
+    {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    // ...and scatter, keeping input order within each bucket.
+    for (const auto& entry : m_unsortedEntries)
+    {
+        auto bucket = HashCell(entry.cellX, entry.cellY);
+        m_entries[m_bucketStart[bucket]++] = entry;
+    }
+
+    // Scattering advanced each start offset to the next bucket's start; shift them back.
+    for (auto b = bucketCount; b > 0; --b)
+    {
+        m_bucketStart[b] = m_bucketStart[b - 1];
+    }
+    m_bucketStart[0] = 0;
+}
+
+void SpatialGrid::Clear()
+{
+    m_entries.clear();
+    m_unsortedEntries.clear();
+    m_bucketStart.clear();
+}
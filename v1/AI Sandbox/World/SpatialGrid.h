@@ -0,0 +1,80 @@
+#pragma once
+
+// Uniform grid over an unbounded plane, stored as a hashed, counting-sorted array of entries so that
+// rebuilding it every update does not allocate once its buffers have grown to the population size.
+class SpatialGrid
+{
+public:
+    SpatialGrid();
+    ~SpatialGrid();
+
+    // Rebuild the grid from a set of points; the callbacks below report indices into this array.
+    void Build(const DirectX::SimpleMath::Vector2* positions, size_t count, float cellSize);
+    void Clear();
+
+    float GetCellSize() const { return m_cellSize; }
+    size_t GetCount() const { return m_entries.size(); }
+
+    // Call callback(index) once for every point whose cell overlaps the rectangle [minCorner,maxCorner].
+    // Points are reported by cell, so callers that need exact bounds must still test the position.
+    template<typename TCallback>
+    void QueryRect(DirectX::SimpleMath::Vector2 minCorner, DirectX::SimpleMath::Vector2 maxCorner, const TCallback& callback) const
+    {
+        if (m_entries.empty())
+            return;
+
+        auto minX = CellCoordinate(minCorner.x);
+        auto minY = CellCoordinate(minCorner.y);
+        auto maxX = CellCoordinate(maxCorner.x);
+        auto maxY = CellCoordinate(maxCorner.y);
+
+        auto cellCount = (int64_t(maxX) - minX + 1) * (int64_t(maxY) - minY + 1);
+        if (cellCount > int64_t(m_entries.size()))
+        {
+            // Large queries are cheaper as a straight scan than as a walk over mostly empty cells.
+            for (const auto& entry : m_entries)
+            {
+                if (entry.cellX >= minX && entry.cellX <= maxX && entry.cellY >= minY && entry.cellY <= maxY)
+                {
+                    callback(size_t(entry.index));
+                }
+            }
+            return;
+        }
+
+        for (auto y = minY; y <= maxY; ++y)
+        {
+            for (auto x = minX; x <= maxX; ++x)
+            {
+                auto bucket = HashCell(x, y);
+                for (auto i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i)
+                {
+                    // Several cells can share a bucket, so filter on the exact cell.
+                    const auto& entry = m_entries[i];
+                    if (entry.cellX == x && entry.cellY == y)
+                    {
+                        callback(size_t(entry.index));
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        int32_t cellX;
+        int32_t cellY;
+        uint32_t index;
+    };
+
+    int32_t CellCoordinate(float value) const { return int32_t(std::floor(value * m_inverseCellSize)); }
+    uint32_t HashCell(int32_t x, int32_t y) const { return ((uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u)) & m_bucketMask; }
+
+    float                   m_cellSize;
+    float                   m_inverseCellSize;
+    uint32_t                m_bucketMask;
+    std::vector<uint32_t>   m_bucketStart; // bucket b holds entries [m_bucketStart[b], m_bucketStart[b + 1])
+    std::vector<Entry>      m_entries;
+    std::vector<Entry>      m_unsortedEntries;
+};
@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "TextureCache.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+TextureCache::TextureCache(std::unique_ptr<TextureDecoder> decoder) :
+    m_decodeCount(0),
+    m_decoder(std::move(decoder))
+{
+}
+
+TextureCache::~TextureCache()
+{
+}
+
+void TextureCache::SetDecoder(std::unique_ptr<TextureDecoder> decoder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoder = std::move(decoder);
+    m_textures.clear();
+    m_texturesByIndex.clear();
+}
+
+TextureHandle TextureCache::Get(const std::wstring& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_textures.find(path);
+    if (it != m_textures.end())
+        return it->second;
+
+    if (!m_decoder)
+        return nullptr;
+
+    auto texture = std::make_shared<Texture>();
+    texture->width = 0;
+    texture->height = 0;
+    texture->index = uint32_t(m_texturesByIndex.size());
+    ++m_decodeCount;
+
+    // Failures are not kept: they may be passing (a file being replaced, a device not created yet).
+    if (!m_decoder->Decode(path, texture.get()))
+        return nullptr;
+
+    texture->origin = Vector2(float(texture->width / 2), float(texture->height / 2));
+    texture->radius = texture->origin.x;
+
+    TextureHandle handle = texture;
+    m_textures[path] = handle;
+    m_texturesByIndex.push_back(handle);
+    return handle;
+}
+
+void TextureCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_textures.clear();
+    m_texturesByIndex.clear();
+}
+
+size_t TextureCache::GetDecodeCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_decodeCount;
+}
+
+void TextureCache::GetTextures(std::vector<TextureHandle>* textures) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    textures->assign(m_texturesByIndex.begin(), m_texturesByIndex.end());
+}
+
+TextureCache& TextureCache::Default()
+{
+    static TextureCache cache(nullptr);
+    return cache;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What a decoder creates on the GPU for a texture. Only the renderer that gave the cache its decoder knows the
+// concrete type (see WicTextureDecoder), so the cache itself needs no graphics API.
+class TextureView
+{
+public:
+    virtual ~TextureView() {}
+};
+
+// A decoded texture, with what objects drawn with it derive from its size.
+struct Texture
+{
+    std::shared_ptr<const TextureView>  view; // null from decoders that create none
+    uint32_t                            width; // pixels
+    uint32_t                            height; // pixels
+    DirectX::SimpleMath::Vector2        origin; // center, in pixels
+    float                               radius; // collision bounds of an object drawn with it (assume circular shape)
+    uint32_t                            index; // in its cache, for references that must not count (see SpriteInstance)
+};
+
+// Shared by every object drawn with the texture; cheap to copy.
+typedef std::shared_ptr<const Texture> TextureHandle;
+
+// Turns an image file into a texture, filling in view, width and height.
+class TextureDecoder
+{
+public:
+    virtual ~TextureDecoder() {}
+
+    // Returns false if the file could not be decoded.
+    virtual bool Decode(const std::wstring& path, Texture* texture) = 0;
+};
+
+// Textures by path, each decoded once and then handed out to every object that asks for it. The views belong
+// to the decoder's device: replace the decoder when the device changes, which clears the cache (handles
+// already given out keep their textures alive until released). Thread-safe.
+class TextureCache
+{
+public:
+    explicit TextureCache(std::unique_ptr<TextureDecoder> decoder);
+    ~TextureCache();
+
+    // Clear the cache and decode with decoder from now on. With no decoder, Get returns nullptr.
+    void SetDecoder(std::unique_ptr<TextureDecoder> decoder);
+
+    // The texture at path, decoded on first use. nullptr if it could not be decoded; a failure is not
+    // remembered, so the path is tried again by the next call.
+    TextureHandle Get(const std::wstring& path);
+
+    void Clear();
+
+    // Every texture decoded since the cache was last cleared, by index.
+    void GetTextures(std::vector<TextureHandle>* textures) const;
+
+    // Decodes attempted since the cache was created, failed ones included.
+    size_t GetDecodeCount() const;
+
+    // Process-wide cache the game's objects load their textures through. It has no decoder until the game
+    // gives it one for its device.
+    static TextureCache& Default();
+
+private:
+    std::unique_ptr<TextureDecoder>         m_decoder;
+    size_t                                  m_decodeCount;
+    mutable std::mutex                      m_mutex;
+    std::map<std::wstring, TextureHandle>   m_textures;
+    std::vector<TextureHandle>              m_texturesByIndex;
+};
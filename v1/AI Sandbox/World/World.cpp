@@ -1,51 +1,728 @@
 #include "pch.h"
 #include "World.h"
+#include "AllocationTracker.h"
+#include "FastMath.h"
+#include "FixedPoint.h"
+#include "GameObjectFactory.h"
+#include "ParallelHelper.h"
+#include "Profiler.h"
+#include "RenderSnapshot.h"
+#include "ScriptBehavior.h"
+#include "WorldSnapshot.h"
 
 using namespace Config;
 using namespace DirectX;
+using namespace DirectX::SimpleMath;
 
-World::World() :
-    m_frictionCoefficient(World_FrictionCoefficient)
+namespace
 {
+// Identifies a behavior module in a snapshot; module state follows once every header of the object is written.
+struct BehaviorModuleHeader
+{
+    BehaviorModuleType  type;
+    char                priority;
+    uint8_t             isEnabled;
+};
+
+const size_t MaxSavedBehaviorModules = 255;
+
+// Active players per block of debug geometry recorded in parallel.
+const size_t DebugGeometryBlockSize = 256;
+
+// Fewest active players per batch when the sprite stream is written in parallel.
+const size_t SpriteInstanceBatchSize = 4096;
+
+// State is hashed as raw bytes, so it must have no padding.
+static_assert(sizeof(HashedObjectState) == 7 * sizeof(uint32_t), "HashedObjectState has padding");
+}
+
+World::World(const WorldParameters& parameters, MetricsRegistry* metrics) :
+    m_archetypes(parameters.GetDefaultArchetype()),
+    m_hasUpdated(false),
+    m_metricsRegistry(metrics),
+    m_nextObjectId(1),
+    m_parameters(parameters),
+    m_previousViewOrigin(Vector2::Zero),
+    m_rollingHash(0),
+    m_tickHash(0),
+    m_tickHashing(false),
+    m_updateViewOrigin(Vector2::Zero),
+    m_viewOrigin(Vector2::Zero),
+    m_viewSize(Vector2::Zero),
+    m_worldBoundary(parameters.width, parameters.height)
+{
+    ApplyParameters();
+    m_partition.Resize(m_worldBoundary, m_parameters.chunkSize);
+
+    if (!m_metricsRegistry)
+    {
+        m_ownMetricsRegistry = std::make_unique<MetricsRegistry>();
+        m_metricsRegistry = m_ownMetricsRegistry.get();
+    }
+
+    auto& registry = *m_metricsRegistry;
+    m_metrics.behaviorsExecuted = registry.GetCounter("world.behaviors.executed");
+    m_metrics.contactColors = registry.GetHistogram("world.contacts.colors");
+    m_metrics.contactIslands = registry.GetHistogram("world.contacts.islands");
+    m_metrics.contactIterations = registry.GetHistogram("world.contacts.iterations");
+    m_metrics.contactResidual = registry.GetHistogram("world.contacts.residual");
+    m_metrics.despawns = registry.GetCounter("world.despawns");
+    m_metrics.spawns = registry.GetCounter("world.spawns");
+    m_metrics.totalAgents = registry.GetGauge("world.render.agents.total");
+    m_metrics.visibleAgents = registry.GetGauge("world.render.agents.visible");
+    m_metrics.updateAllocations = registry.GetHistogram("world.update.allocations");
+    m_metrics.updateTime = registry.GetHistogram("world.update.ns");
+    m_metrics.behaviorsTime = registry.GetHistogram("world.update.behaviors.ns");
+    m_metrics.collisionTime = registry.GetHistogram("world.update.collision.ns");
+    m_metrics.eventsTime = registry.GetHistogram("world.update.events.ns");
+    m_metrics.integrationTime = registry.GetHistogram("world.update.integration.ns");
+    m_metrics.partitionTime = registry.GetHistogram("world.update.partition.ns");
+    m_metrics.scriptsTime = registry.GetHistogram("world.update.scripts.ns");
 }
 
 World::~World()
 {
 }
 
+void World::ApplyParameters()
+{
+    m_contactSolver.SetBaumgarteFactor(m_parameters.contactBaumgarteFactor);
+    m_contactSolver.SetMaxIterations(m_parameters.contactMaxIterations);
+    m_contactSolver.SetParallelSolve(m_parameters.contactParallelSolve);
+    m_contactSolver.SetPenetrationSlop(m_parameters.contactPenetrationSlop);
+    m_contactSolver.SetResidualTolerance(m_parameters.contactResidualTolerance);
+    m_contactSolver.SetRestitutionThreshold(m_parameters.contactRestitutionThreshold);
+    m_contactSolver.SetWarmStarting(m_parameters.contactWarmStarting);
+
+    m_partition.SetActivationRadius(m_parameters.activationRadius);
+    m_partition.SetDormantUpdateInterval(m_parameters.dormantUpdateInterval);
+    m_partition.SetFrictionDeceleration(m_parameters.frictionCoefficient * m_parameters.gravity);
+}
+
+void World::SetParameters(const WorldParameters& parameters)
+{
+    auto previous = m_parameters;
+    m_parameters = parameters;
+    ApplyParameters();
+    m_archetypes.Set(ArchetypeTable::DefaultName, m_parameters.GetDefaultArchetype());
+
+    if (parameters.width != previous.width || parameters.height != previous.height ||
+        parameters.chunkSize != previous.chunkSize)
+    {
+        SetWorldBoundary(Vector2(parameters.width, parameters.height));
+    }
+}
+
 void World::Update(float elapsedTime)
 {
-    // Update all players.
-    for (const auto& team : m_playerTeams)
+    PROFILE_ZONE("World::Update");
+    AllocationTracker::Scope updateAllocationScope("World::Update");
+    ScopedHistogramTimer updateTimer(m_metrics.updateTime);
+    auto allocations = AllocationTracker::GetThreadAllocationCount();
+
+    // Deliver the events of the previous update (and of changes made since), before anything reacts to them.
     {
-        for (const auto& teamPlayer : team)
+        PROFILE_ZONE("Deliver events");
+        AllocationTracker::Scope allocationScope("Deliver events");
+        ScopedHistogramTimer timer(m_metrics.eventsTime);
+        m_events.Deliver(this);
+    }
+
+    // Only players in chunks near team 0 (human-controlled players) or under the view are updated in full.
+    m_activationPoints.clear();
+    if (!m_playerTeams.empty())
+    {
+        for (const auto& teamPlayer : m_playerTeams[0])
+        {
+            m_activationPoints.push_back(teamPlayer->GetPosition());
+        }
+    }
+
+    {
+        PROFILE_ZONE("Partition");
+        AllocationTracker::Scope allocationScope("Partition");
+        ScopedHistogramTimer timer(m_metrics.partitionTime);
+        m_partition.Update(m_activationPoints.data(), m_activationPoints.size(), m_viewOrigin, m_viewOrigin + m_viewSize,
+            elapsedTime, m_updatePlayers);
+    }
+
+    // Keep where the players and the view were before this update, for drawing blended between updates.
+    for (auto player : m_updatePlayers)
+    {
+        player->SavePreviousTransform();
+    }
+    m_previousViewOrigin = m_hasUpdated ? m_updateViewOrigin : m_viewOrigin;
+    m_updateViewOrigin = m_viewOrigin;
+    m_hasUpdated = true;
+
+    // Wake scripts that are due, ahead of behaviors, so they steer from the same snapshot of the world.
+    {
+        PROFILE_ZONE("Scripts");
+        AllocationTracker::Scope allocationScope("Scripts");
+        ScopedHistogramTimer timer(m_metrics.scriptsTime);
+        m_scripts.Update(this, elapsedTime);
+    }
+
+    // Run all behaviors first, so every player steers from the same snapshot of the world.
+    {
+        PROFILE_ZONE("Behaviors");
+        AllocationTracker::Scope allocationScope("Behaviors");
+        ScopedHistogramTimer timer(m_metrics.behaviorsTime);
+        size_t behaviorsExecuted = 0;
+        for (auto player : m_updatePlayers)
         {
-            teamPlayer->Update(this, elapsedTime);
+            behaviorsExecuted += player->RunBehaviors(this, elapsedTime);
         }
+        m_metrics.behaviorsExecuted->Add(behaviorsExecuted);
+    }
+
+    // Integrate all players.
+    {
+        PROFILE_ZONE("Integration");
+        AllocationTracker::Scope allocationScope("Integration");
+        ScopedHistogramTimer timer(m_metrics.integrationTime);
+#if defined(FIXED_POINT_SIMULATION)
+        for (auto player : m_updatePlayers)
+        {
+            player->IntegrateFixedPoint(this, elapsedTime);
+        }
+#else
+        IntegratePlayers(elapsedTime);
+#endif
     }
 
     // Detect and resolve collisions.
-    // TODO
+    {
+        PROFILE_ZONE("Collision");
+        AllocationTracker::Scope allocationScope("Collision");
+        ScopedHistogramTimer timer(m_metrics.collisionTime);
+        m_contactSolver.Solve(m_updatePlayers.data(), m_updatePlayers.size());
+    }
+
+    const auto& contactStats = m_contactSolver.GetStats();
+    if (contactStats.contactCount > 0)
+    {
+        m_metrics.contactColors->Record(contactStats.colorCount);
+        m_metrics.contactIslands->Record(contactStats.islandCount);
+        m_metrics.contactIterations->Record(uint64_t(contactStats.iterations));
+        m_metrics.contactResidual->Record(uint64_t(std::max(contactStats.residual, 0.f) * 1e6f + 0.5f));
+    }
+
+    const auto& beganContacts = m_contactSolver.GetBeganContacts();
+    m_events.Publish(beganContacts.data(), beganContacts.size());
+
+    if (m_tickHashing)
+    {
+        PROFILE_ZONE("State hash");
+        AllocationTracker::Scope allocationScope("State hash");
+        uint64_t hashes[2] = { m_rollingHash, ComputeStateHash() };
+        m_tickHash = hashes[1];
+        m_rollingHash = FixedPoint::Hash(hashes, sizeof(hashes));
+    }
+
+    UpdateTeamMetrics();
+    m_metrics.updateAllocations->Record(AllocationTracker::GetThreadAllocationCount() - allocations);
 }
 
-void World::Render(SpriteBatch* spriteBatch)
+void World::UpdateTeamMetrics()
 {
+    // Gauges for new teams are looked up as teams appear, not every update.
+    while (m_metrics.teamAgents.size() < m_playerTeams.size())
+    {
+        auto name = "world.team" + std::to_string(m_metrics.teamAgents.size()) + ".agents";
+        m_metrics.teamAgents.push_back(m_metricsRegistry->GetGauge(name));
+    }
+
+    for (size_t i = 0; i < m_playerTeams.size(); ++i)
+    {
+        m_metrics.teamAgents[i]->Set(double(m_playerTeams[i].size()));
+    }
+}
+
+#if !defined(FIXED_POINT_SIMULATION)
+void World::IntegratePlayers(float elapsedTime)
+{
+    auto count = m_updatePlayers.size();
+    m_integrationX.resize(count);
+    m_integrationY.resize(count);
+    m_integrationSpeed.resize(count);
+    m_integrationHeading.resize(count);
+
+    // Friction opposes the current velocity.
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto velocity = m_updatePlayers[i]->GetVelocity();
+        m_integrationX[i] = -velocity.x;
+        m_integrationY[i] = -velocity.y;
+    }
+
+    FastMath::NormalizeBatch(m_integrationX.data(), m_integrationY.data(), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_updatePlayers[i]->IntegrateVelocity(this, elapsedTime, Vector2(m_integrationX[i], m_integrationY[i]));
+    }
+
+    // Speed and heading of the new velocities.
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto velocity = m_updatePlayers[i]->GetVelocity();
+        m_integrationX[i] = velocity.x;
+        m_integrationY[i] = velocity.y;
+    }
+
+    FastMath::LengthBatch(m_integrationX.data(), m_integrationY.data(), m_integrationSpeed.data(), count);
+    FastMath::Atan2Batch(m_integrationY.data(), m_integrationX.data(), m_integrationHeading.data(), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_updatePlayers[i]->IntegratePosition(this, elapsedTime, m_integrationSpeed[i], m_integrationHeading[i]);
+    }
+}
+#endif
+
+void World::Render(RenderSnapshot* snapshot)
+{
+    PROFILE_ZONE("World::Render");
+
+    // Only players under the view are drawn (dormant chunks never are). Each writes its own entry of the
+    // stream, so it comes out in the same order on any number of threads.
+    const auto& players = GetVisiblePlayers(m_viewOrigin, m_viewOrigin + m_viewSize);
+    snapshot->sprites.resize(players.size());
+    Helper::ParallelFor(players.size(), SpriteInstanceBatchSize, [&](size_t begin, size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            players[i]->Render(&snapshot->sprites[i]);
+        }
+    });
+
+    TextureCache::Default().GetTextures(&snapshot->textures);
+
+    snapshot->partitionStats = m_partition.GetStats();
+    snapshot->viewOrigin = m_viewOrigin;
+    snapshot->previousViewOrigin = m_previousViewOrigin;
+    snapshot->viewSize = m_viewSize;
+    snapshot->visibleObjectCount = players.size();
+
+    const auto& stats = snapshot->partitionStats;
+    m_metrics.totalAgents->Set(double(stats.activeObjectCount + stats.dormantObjectCount));
+    m_metrics.visibleAgents->Set(double(players.size()));
+}
+
+void World::RenderDebugInfo(DebugGeometry* debugGeometry)
+{
+    PROFILE_ZONE("World::RenderDebugInfo");
+
+    // Blocks are recorded in parallel and then appended in order, so the vertices come out the same on any
+    // number of threads. Each block keeps its arrays, so recording stops allocating once they have grown.
+    const auto& players = GetVisiblePlayers(debugGeometry->GetCullMin(), debugGeometry->GetCullMax());
+    auto blockCount = (players.size() + DebugGeometryBlockSize - 1) / DebugGeometryBlockSize;
+    if (m_debugGeometryBlocks.size() < blockCount)
+    {
+        m_debugGeometryBlocks.resize(blockCount);
+    }
+
+    Helper::ParallelFor(blockCount, 1, [&](size_t firstBlock, size_t lastBlock)
+    {
+        for (auto block = firstBlock; block < lastBlock; ++block)
+        {
+            auto& blockGeometry = m_debugGeometryBlocks[block];
+            blockGeometry.Clear();
+            blockGeometry.CopyFilter(*debugGeometry);
+
+            auto end = std::min(players.size(), (block + 1) * DebugGeometryBlockSize);
+            for (auto i = block * DebugGeometryBlockSize; i < end; ++i)
+            {
+                players[i]->RenderDebugInfo(&blockGeometry);
+            }
+        }
+    });
+
+    auto lineVertexCount = debugGeometry->GetLineVertices().size();
+    auto triangleVertexCount = debugGeometry->GetTriangleVertices().size();
+    for (size_t block = 0; block < blockCount; ++block)
+    {
+        lineVertexCount += m_debugGeometryBlocks[block].GetLineVertices().size();
+        triangleVertexCount += m_debugGeometryBlocks[block].GetTriangleVertices().size();
+    }
+
+    debugGeometry->Reserve(lineVertexCount, triangleVertexCount);
+    for (size_t block = 0; block < blockCount; ++block)
+    {
+        debugGeometry->Append(m_debugGeometryBlocks[block]);
+    }
+}
+
+const std::vector<GameObject*>& World::GetVisiblePlayers(Vector2 min, Vector2 max)
+{
+    m_visiblePlayers.clear();
+    auto margin = Vector2(m_parameters.viewCullMargin);
+    m_partition.GetActiveObjectsIn(min - margin, max + margin, &m_visiblePlayers);
+    return m_visiblePlayers;
+}
+
+void World::CenterView(Vector2 size)
+{
+    auto origin = m_viewOrigin;
+
+    auto player = GetPlayer(0, 0);
+    if (player)
+    {
+        origin = player->GetPosition() - size / 2.f;
+    }
+
+    auto maxOrigin = Vector2::Max(Vector2::Zero, m_worldBoundary - size);
+    SetView(Vector2::Min(maxOrigin, Vector2::Max(Vector2::Zero, origin)), size);
+}
+
+void World::SetWorldBoundary(Vector2 boundary)
+{
+    m_worldBoundary = boundary;
+    m_partition.Resize(boundary, m_parameters.chunkSize);
+}
+
+uint64_t World::ComputeStateHash()
+{
+    using namespace FixedPoint;
+
+    // Players' kinematic state is hashed as stored (it is already fixed point in the fixed-point build).
+    auto quantize = [](HashedObjectState* state, const FixedVector2& position, const FixedVector2& velocity)
+    {
+        state->positionX = position.x.raw;
+        state->positionY = position.y.raw;
+        state->velocityX = velocity.x.raw;
+        state->velocityY = velocity.y.raw;
+    };
+
+    m_hashedState.clear();
+    m_hashedStateIndices.resize(m_nextObjectId);
+    for (size_t teamNumber = 0; teamNumber < m_playerTeams.size(); ++teamNumber)
+    {
+        for (const auto& teamPlayer : m_playerTeams[teamNumber])
+        {
+            HashedObjectState state;
+            state.id = teamPlayer->GetId();
+            state.teamNumber = uint32_t(teamNumber);
+            quantize(&state, FixedVector2(teamPlayer->GetKinematicPosition()), FixedVector2(teamPlayer->GetKinematicVelocity()));
+            state.rotation = Fixed::FromFloat(teamPlayer->GetRotation()).raw;
+
+            m_hashedStateIndices[state.id] = uint32_t(m_hashedState.size());
+            m_hashedState.push_back(state);
+        }
+    }
+
+    // Dormant objects' state lives in the partition until it is written back.
+    m_partition.ForEachDormantObject([&](GameObject* object, Vector2 position, Vector2 velocity)
+    {
+        quantize(&m_hashedState[m_hashedStateIndices[object->GetId()]], FixedVector2(position), FixedVector2(velocity));
+    });
+
+    return Hash(m_hashedState.data(), m_hashedState.size() * sizeof(HashedObjectState));
+}
+
+void World::SetTickHashing(bool enabled)
+{
+    m_tickHashing = enabled;
+    m_rollingHash = 0;
+    m_tickHash = 0;
+}
+
+void World::SaveSnapshot(WorldSnapshot* snapshot)
+{
+    // Dormant objects' state lives in the partition until it is written back.
+    m_partition.SyncDormantObjects();
+
+    // Objects are saved in team order, so team membership is implicit. Kinematic state goes in one array.
+    size_t objectCount = 0;
+    std::vector<uint64_t> teamSizes;
     for (const auto& team : m_playerTeams)
     {
+        teamSizes.push_back(uint64_t(team.size()));
+        objectCount += team.size();
+    }
+
+    m_snapshotIndices.assign(m_nextObjectId, SnapshotWriter::NoObject);
+    m_snapshotStates.resize(objectCount);
+    m_snapshotModuleCounts.resize(objectCount);
+    m_snapshotModules.clear();
+
+    // One pass over the objects gathers everything, so the behavior pass below does not chase them again.
+    uint32_t index = 0;
+    for (const auto& team : m_playerTeams)
+    {
+        for (const auto& teamPlayer : team)
+        {
+            m_snapshotIndices[teamPlayer->GetId()] = index;
+            teamPlayer->SaveState(&m_snapshotStates[index]);
+
+            const auto& behaviorModules = teamPlayer->GetBehaviorModules();
+            m_snapshotModuleCounts[index] = uint32_t(behaviorModules.size());
+            for (const auto& behaviorModuleMapPair : behaviorModules)
+            {
+                m_snapshotModules.emplace_back(behaviorModuleMapPair.first, behaviorModuleMapPair.second.get());
+            }
+            ++index;
+        }
+    }
+
+    snapshot->Clear();
+    SnapshotWriter writer(snapshot, &m_snapshotIndices);
+    writer.Reserve(objectCount * (sizeof(GameObjectState) + 32));
+
+    writer.Write(m_nextObjectId);
+    writer.Write(m_worldBoundary);
+    writer.Write(m_parameters.chunkSize);
+    writer.Write(m_viewOrigin);
+    writer.Write(m_viewSize);
+    writer.WriteArray(teamSizes.data(), teamSizes.size());
+    m_archetypes.Save(&writer);
+    writer.WriteArray(m_snapshotStates.data(), m_snapshotStates.size());
+
+    // Scripts come before the behaviors, so script modules find theirs when they are restored.
+    m_scripts.SaveState(&writer);
+
+    // Behaviors, per object: module count, module headers, then each module's state.
+    auto module = m_snapshotModules.cbegin();
+    for (auto moduleCount : m_snapshotModuleCounts)
+    {
+        auto modulesEnd = module + moduleCount;
+
+        uint8_t savedCount = 0;
+        for (auto it = module; it != modulesEnd; ++it)
+        {
+            if (it->second->GetType() != BehaviorModuleType::Unknown && savedCount < MaxSavedBehaviorModules)
+            {
+                ++savedCount;
+            }
+        }
+
+        writer.Write(savedCount);
+        auto saved = savedCount;
+        for (auto it = module; it != modulesEnd && saved > 0; ++it)
+        {
+            if (it->second->GetType() != BehaviorModuleType::Unknown)
+            {
+                writer.Write(BehaviorModuleHeader{ it->second->GetType(), it->first, uint8_t(it->second->IsEnabled() ? 1 : 0) });
+                --saved;
+            }
+        }
+        for (saved = savedCount; module != modulesEnd; ++module)
+        {
+            if (saved > 0 && module->second->GetType() != BehaviorModuleType::Unknown)
+            {
+                module->second->SaveState(&writer);
+                --saved;
+            }
+        }
+    }
+
+    m_partition.SaveLayout(&writer);
+    m_contactSolver.SaveCache(&writer);
+    m_events.SavePending(&writer);
+}
+
+bool World::RestoreSnapshot(const WorldSnapshot& snapshot, const GameObjectFactory& factory)
+{
+    bool restored = ReadSnapshot(snapshot, factory);
+    if (!restored)
+    {
+        // The snapshot may have been rejected after objects were replaced or partly re-homed, so the partition
+        // can hold objects the world no longer owns. Rebuild it from the teams as they are now.
+        m_partition.Clear();
+        m_updatePlayers.clear();
+        for (const auto& team : m_playerTeams)
+        {
+            for (const auto& teamPlayer : team)
+            {
+                m_partition.Insert(teamPlayer.get());
+            }
+        }
+    }
+
+    // Keep nothing alive on behalf of the snapshot.
+    m_snapshotObjects.clear();
+    m_snapshotObjectsById.clear();
+
+    return restored;
+}
+
+bool World::ReadSnapshot(const WorldSnapshot& snapshot, const GameObjectFactory& factory)
+{
+    SnapshotReader reader(snapshot);
+
+    uint32_t nextObjectId;
+    Vector2 worldBoundary;
+    float chunkSize;
+    std::vector<uint64_t> teamSizes;
+    std::vector<uint16_t> archetypeIndices;
+    if (!reader.Read(&nextObjectId) || !reader.Read(&worldBoundary) || !reader.Read(&chunkSize) ||
+        !reader.Read(&m_viewOrigin) || !reader.Read(&m_viewSize) || !reader.ReadArray(&teamSizes) ||
+        !m_archetypes.Load(&reader, &archetypeIndices) || !reader.ReadArray(&m_snapshotStates))
+        return false;
+
+    size_t objectCount = 0;
+    for (auto teamSize : teamSizes)
+    {
+        objectCount += size_t(teamSize);
+    }
+    if (objectCount != m_snapshotStates.size() || chunkSize <= 0.f)
+        return false;
+
+    // Nothing to blend from across a restore.
+    m_hasUpdated = false;
+
+    // Re-create the chunk grid if it changed. This must come first: it writes dormant state back to objects.
+    if (worldBoundary != m_worldBoundary || chunkSize != m_parameters.chunkSize)
+    {
+        m_parameters.chunkSize = chunkSize;
+        SetWorldBoundary(worldBoundary);
+    }
+
+    // Find the existing objects by id, noting whether the teams hold exactly the snapshot's objects.
+    auto idCount = std::max(m_nextObjectId, nextObjectId);
+    m_snapshotObjectsById.assign(idCount, nullptr);
+
+    bool sameTeams = m_playerTeams.size() == teamSizes.size();
+    size_t index = 0;
+    for (size_t teamNumber = 0; teamNumber < m_playerTeams.size(); ++teamNumber)
+    {
+        const auto& team = m_playerTeams[teamNumber];
+        sameTeams = sameTeams && team.size() == teamSizes[teamNumber];
+
         for (const auto& teamPlayer : team)
         {
-            teamPlayer->Render(spriteBatch);
+            m_snapshotObjectsById[teamPlayer->GetId()] = &teamPlayer;
+            sameTeams = sameTeams && index < objectCount && m_snapshotStates[index].id == teamPlayer->GetId();
+            ++index;
         }
     }
+
+    // Objects in snapshot order, reusing existing ones.
+    m_snapshotObjects.resize(objectCount);
+    index = 0;
+    for (size_t teamNumber = 0; teamNumber < teamSizes.size(); ++teamNumber)
+    {
+        for (uint64_t i = 0; i < teamSizes[teamNumber]; ++i, ++index)
+        {
+            auto& state = m_snapshotStates[index];
+            if (state.id >= idCount || state.archetype >= archetypeIndices.size())
+                return false;
+
+            state.archetype = archetypeIndices[state.archetype];
+
+            auto& object = m_snapshotObjects[index];
+            if (m_snapshotObjectsById[state.id])
+            {
+                object = *m_snapshotObjectsById[state.id];
+                m_snapshotObjectsById[state.id] = nullptr; // each id is used once
+            }
+            else
+            {
+                object = factory.CreateGameObject(FromKinematic(state.position), m_archetypes, state.archetype);
+            }
+
+            object->LoadState(state, m_archetypes);
+            object->SetTeamNumber(teamNumber);
+        }
+    }
+
+    if (!sameTeams)
+    {
+        // Objects left over are no longer in the world.
+        for (auto existing : m_snapshotObjectsById)
+        {
+            if (existing)
+            {
+                (*existing)->SetValidTarget(false);
+            }
+        }
+
+        Teams teams(teamSizes.size());
+        index = 0;
+        for (size_t teamNumber = 0; teamNumber < teams.size(); ++teamNumber)
+        {
+            for (uint64_t i = 0; i < teamSizes[teamNumber]; ++i)
+            {
+                teams[teamNumber].push_back(m_snapshotObjects[index++]);
+            }
+        }
+        m_playerTeams.swap(teams);
+    }
+
+    m_nextObjectId = nextObjectId;
+
+    // Scripts, then behaviors. Modules are restored in place when the object has the same modules; otherwise
+    // they are re-created (modules that snapshots do not cover are dropped in that case).
+    reader.SetObjects(&m_snapshotObjects);
+    if (!m_scripts.LoadState(&reader))
+        return false;
+
+    BehaviorModuleHeader headers[MaxSavedBehaviorModules];
+    BehaviorModule* modules[MaxSavedBehaviorModules];
+    for (const auto& object : m_snapshotObjects)
+    {
+        uint8_t moduleCount;
+        if (!reader.Read(&moduleCount))
+            return false;
+
+        for (uint8_t i = 0; i < moduleCount; ++i)
+        {
+            if (!reader.Read(&headers[i]))
+                return false;
+        }
+
+        uint8_t matchingCount = 0;
+        for (const auto& behaviorModuleMapPair : object->GetBehaviorModules())
+        {
+            const auto& behaviorModule = behaviorModuleMapPair.second;
+            if (behaviorModule->GetType() == BehaviorModuleType::Unknown)
+                continue;
+
+            if (matchingCount == moduleCount || headers[matchingCount].type != behaviorModule->GetType() ||
+                headers[matchingCount].priority != behaviorModuleMapPair.first)
+            {
+                matchingCount = UINT8_MAX;
+                break;
+            }
+
+            modules[matchingCount++] = behaviorModule.get();
+        }
+
+        if (matchingCount != moduleCount)
+        {
+            object->RemoveAllBehaviorModules();
+            for (uint8_t i = 0; i < moduleCount; ++i)
+            {
+                auto behaviorModule = headers[i].type == BehaviorModuleType::Script ?
+                    std::make_shared<ScriptBehavior>(&m_scripts) : factory.CreateBehaviorModule(headers[i].type);
+                if (!behaviorModule)
+                    return false;
+
+                object->AddBehaviorModule(behaviorModule, headers[i].priority);
+                modules[i] = behaviorModule.get();
+            }
+        }
+
+        for (uint8_t i = 0; i < moduleCount; ++i)
+        {
+            modules[i]->SetEnabled(headers[i].isEnabled != 0);
+            if (!modules[i]->LoadState(&reader))
+                return false;
+        }
+    }
+
+    return m_partition.RestoreLayout(&reader) && m_contactSolver.LoadCache(&reader) &&
+        m_events.LoadPending(&reader) && reader.IsAtEnd();
 }
 
-void World::CreateAllTextures(ID3D11Device2* device)
+void World::CreateAllTextures()
 {
     for (const auto& team : m_playerTeams)
     {
         for (const auto& teamPlayer : team)
         {
-            teamPlayer->CreateTexture(device);
+            teamPlayer->CreateTexture();
         }
     }
 }
@@ -73,8 +750,11 @@ void World::AddPlayer(std::shared_ptr<GameObject> player, size_t teamNumber)
 
     if (teamNumber < m_playerTeams.size())
     {
+        player->SetId(m_nextObjectId++);
         player->SetTeamNumber(teamNumber);
         m_playerTeams[teamNumber].push_back(player);
+        m_partition.Insert(player.get());
+        m_metrics.spawns->Add();
     }
 }
 
@@ -94,6 +774,30 @@ std::shared_ptr<GameObject> World::GetPlayer(size_t teamNumber, size_t playerNum
     return nullptr;
 }
 
+void World::MovePlayer(std::shared_ptr<GameObject> player, size_t newTeamNumber)
+{
+    if (!player || newTeamNumber >= m_playerTeams.size())
+        return;
+
+    auto teamNumber = player->GetTeamNumber();
+    if (teamNumber < m_playerTeams.size() && teamNumber != newTeamNumber)
+    {
+        auto& team = m_playerTeams[teamNumber];
+        for (auto it = team.cbegin(); it != team.cend(); ++it)
+        {
+            if (*it == player)
+            {
+                // Keeps its id and its place in the partition.
+                team.erase(it);
+                player->SetTeamNumber(newTeamNumber);
+                m_playerTeams[newTeamNumber].push_back(player);
+                m_events.Publish(TeamChangedEvent{ player->GetId(), uint32_t(teamNumber), uint32_t(newTeamNumber) });
+                break;
+            }
+        }
+    }
+}
+
 void World::RemoveAllPlayers(size_t teamNumber)
 {
     if (teamNumber < m_playerTeams.size())
@@ -102,8 +806,11 @@ void World::RemoveAllPlayers(size_t teamNumber)
         for (auto& player : team)
         {
             player->SetValidTarget(false);
+            m_partition.Remove(player.get());
+            m_events.Publish(DespawnedEvent{ player->GetId(), uint32_t(teamNumber) });
         }
 
+        m_metrics.despawns->Add(team.size());
         m_playerTeams[teamNumber].clear();
     }
 }
@@ -123,7 +830,10 @@ void World::RemovePlayer(std::shared_ptr<GameObject> player)
         {
             if (*it == player)
             {
+                m_partition.Remove(player.get());
                 team.erase(it);
+                m_events.Publish(DespawnedEvent{ player->GetId(), uint32_t(teamNumber) });
+                m_metrics.despawns->Add();
                 break;
             }
         }
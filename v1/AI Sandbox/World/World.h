@@ -1,28 +1,101 @@
 #pragma once
 
+#include "ContactSolver.h"
+#include "DebugGeometry.h"
 #include "GameObject.h"
+#include "Metrics.h"
+#include "ScriptScheduler.h"
+#include "WorldEventBus.h"
+#include "WorldParameters.h"
+#include "WorldPartition.h"
+
+class GameObjectFactory;
+struct RenderSnapshot;
+class WorldSnapshot;
 
 typedef std::list<std::shared_ptr<GameObject>> Team;
 typedef std::vector<Team> Teams;
 
+// Kinematic state of one player as World::ComputeStateHash hashes it, quantized to FixedPoint raw values.
+struct HashedObjectState
+{
+    uint32_t    id;
+    uint32_t    teamNumber;
+    int32_t     positionX;
+    int32_t     positionY;
+    int32_t     velocityX;
+    int32_t     velocityY;
+    int32_t     rotation;
+};
+
 class World
 {
 public:
-    World();
+    // The world reports its metrics to the given registry, or to one of its own if none is given, so worlds
+    // running side by side keep them apart. Only the interactive world reports to MetricsRegistry::Default().
+    World(const WorldParameters& parameters = WorldParameters(), MetricsRegistry* metrics = nullptr);
     ~World();
 
     // Common functions
     void Update(float elapsedTime);
-    void Render(DirectX::SpriteBatch* spriteBatch);
+    void Render(RenderSnapshot* snapshot); // record what is visible, for drawing after the update
+    void RenderDebugInfo(DebugGeometry* debugGeometry); // every visible player's, as debugGeometry's filter allows
 
     // World attributes
-    float GetFrictionCoefficient() { return m_frictionCoefficient; }
+    const ContactSolverStats& GetContactSolverStats() { return m_contactSolver.GetStats(); }
+    float GetFrictionCoefficient() { return m_parameters.frictionCoefficient; }
+    float GetGravity() { return m_parameters.gravity; }
+    ArchetypeTable* GetArchetypes() { return &m_archetypes; }
+    MetricsRegistry* GetMetricsRegistry() { return m_metricsRegistry; }
+    const WorldParameters& GetParameters() { return m_parameters; }
     DirectX::SimpleMath::Vector2 GetWorldBoundary() { return m_worldBoundary; }
+    const WorldPartitionStats& GetWorldPartitionStats() { return m_partition.GetStats(); }
+    WorldEventBus* GetEventBus() { return &m_events; }
+    ScriptScheduler* GetScriptScheduler() { return &m_scripts; }
+
+    void SetWorldBoundary(DirectX::SimpleMath::Vector2 boundary);
+
+    // Change the world's parameters between updates (for example when the configuration file is reloaded).
+    // The Default archetype changes with them; a new size or chunk size re-creates the chunk grid.
+    void SetParameters(const WorldParameters& parameters);
 
-    void SetWorldBoundary(DirectX::SimpleMath::Vector2 boundary) { m_worldBoundary = boundary; }
+    // View (the part of the world shown on screen). Chunks under the view are always simulated.
+    DirectX::SimpleMath::Vector2 GetViewOrigin() { return m_viewOrigin; }
+    DirectX::SimpleMath::Vector2 GetViewSize() { return m_viewSize; }
+    DirectX::SimpleMath::Vector2 ScreenToWorld(DirectX::SimpleMath::Vector2 screenPosition) { return screenPosition + m_viewOrigin; }
+
+    void CenterView(DirectX::SimpleMath::Vector2 size); // on the human player, keeping the view inside the world
+    void SetView(DirectX::SimpleMath::Vector2 origin, DirectX::SimpleMath::Vector2 size) { m_viewOrigin = origin; m_viewSize = size; }
+
+    // Active players in the chunks overlapping [min,max] widened by the view cull margin, found through the
+    // partition's chunk grid. Whole chunks are taken, so some players lie just outside. The list is reused
+    // by the next call.
+    const std::vector<GameObject*>& GetVisiblePlayers(DirectX::SimpleMath::Vector2 min, DirectX::SimpleMath::Vector2 max);
+
+    // Hash of the quantized kinematic state of every player, in team and slot order. Identical
+    // simulations give identical hashes on any machine when built with FIXED_POINT_SIMULATION. Dormant
+    // objects are read from the partition without being written back, so hashing never changes the
+    // simulation. GetHashedState returns what the last hash covered, for finding where two worlds differ.
+    uint64_t ComputeStateHash();
+    const std::vector<HashedObjectState>& GetHashedState() { return m_hashedState; }
+
+    // Hash the state at the end of every update (off by default). The tick hash is the state hash after the
+    // last update; the rolling hash folds in every tick hash since hashing was turned on.
+    void SetTickHashing(bool enabled);
+    uint64_t GetTickHash() { return m_tickHash; }
+    uint64_t GetRollingHash() { return m_rollingHash; }
+
+    // Save everything needed to continue the simulation exactly as it would have gone on: objects, their
+    // behaviors and scripts, the partition layout, the contact cache and undelivered events. Restoring reuses
+    // the objects (and behavior modules) that still exist with the same ids, so rewinding a world to an
+    // earlier snapshot of itself allocates nothing per object; objects that no longer exist are created with
+    // the factory. Restore returns false if the snapshot is malformed; the world is then still safe to update
+    // and render, but what it holds is unspecified.
+    void SaveSnapshot(WorldSnapshot* snapshot);
+    bool RestoreSnapshot(const WorldSnapshot& snapshot, const GameObjectFactory& factory);
 
     // World object functions
-    void CreateAllTextures(ID3D11Device2* device);
+    void CreateAllTextures();
     void ResetAllTextures();
 
     // Team functions
@@ -40,10 +113,94 @@ public:
     void RemovePlayer(std::shared_ptr<GameObject> player);
 
 private:
+    void ApplyParameters();
+
+    // RestoreSnapshot without the recovery from a malformed snapshot
+    bool ReadSnapshot(const WorldSnapshot& snapshot, const GameObjectFactory& factory);
+
+#if !defined(FIXED_POINT_SIMULATION)
+    // Batched integration of m_updatePlayers (floating-point build)
+    void IntegratePlayers(float elapsedTime);
+#endif
+
+    // Agents per team, into m_metrics
+    void UpdateTeamMetrics();
+
+    // Events and scripts (declared first: players' behavior modules unsubscribe and stop scripts when destroyed)
+    WorldEventBus   m_events;
+    ScriptScheduler m_scripts;
+
     // World objects
     Teams m_playerTeams; // "all the world's a stage, and [we are] merely players"
+    uint32_t m_nextObjectId;
+
+    // Chunks, and the players in active chunks
+    WorldPartition                              m_partition;
+    std::vector<DirectX::SimpleMath::Vector2>   m_activationPoints;
+    std::vector<GameObject*>                    m_updatePlayers;
+
+    // Snapshot scratch, reused between snapshots
+    std::vector<GameObjectState>                    m_snapshotStates;
+    std::vector<uint32_t>                           m_snapshotIndices;      // by object id
+    std::vector<std::shared_ptr<GameObject>>        m_snapshotObjects;      // in snapshot order
+    std::vector<const std::shared_ptr<GameObject>*> m_snapshotObjectsById;
+    std::vector<std::pair<char, BehaviorModule*>>   m_snapshotModules;      // priority and module, for every object in order
+    std::vector<uint32_t>                           m_snapshotModuleCounts; // per object
+
+    // State hashing
+    std::vector<HashedObjectState>  m_hashedState;
+    std::vector<uint32_t>           m_hashedStateIndices;   // by object id
+    uint64_t                        m_rollingHash;
+    uint64_t                        m_tickHash;
+    bool                            m_tickHashing;
+
+    // Drawing: debug geometry, recorded in blocks of visible players in parallel, and the visible players,
+    // reused between calls
+    std::vector<DebugGeometry>      m_debugGeometryBlocks;
+    std::vector<GameObject*>        m_visiblePlayers;
+
+    // Per-update scratch, reused between updates
+    std::vector<float>          m_integrationHeading;
+    std::vector<float>          m_integrationSpeed;
+    std::vector<float>          m_integrationX;
+    std::vector<float>          m_integrationY;
+
+    // Collision resolution
+    ContactSolver               m_contactSolver;
+
+    // Metrics (in m_metricsRegistry), looked up once
+    struct Metrics
+    {
+        Counter*            behaviorsExecuted;
+        Histogram*          contactColors; // per update with contacts, from the contact solver's stats:
+        Histogram*          contactIslands;
+        Histogram*          contactIterations;
+        Histogram*          contactResidual; // millionths of an impulse unit (kg m/s)
+        Counter*            despawns;
+        Counter*            spawns;
+        std::vector<Gauge*> teamAgents; // by team
+        Gauge*              totalAgents; // in the world, and of them drawn by the latest Render:
+        Gauge*              visibleAgents;
+        Histogram*          updateAllocations; // by the updating thread, and pool workers for it
+        Histogram*          updateTime; // nanoseconds, and per phase:
+        Histogram*          behaviorsTime;
+        Histogram*          collisionTime;
+        Histogram*          eventsTime;
+        Histogram*          integrationTime;
+        Histogram*          partitionTime;
+        Histogram*          scriptsTime;
+    };
+    Metrics                             m_metrics;
+    MetricsRegistry*                    m_metricsRegistry;
+    std::unique_ptr<MetricsRegistry>    m_ownMetricsRegistry; // when none was given
 
     // World characteristics
-    float                           m_frictionCoefficient;
+    ArchetypeTable                  m_archetypes;
+    WorldParameters                 m_parameters;
+    DirectX::SimpleMath::Vector2    m_viewOrigin;
+    DirectX::SimpleMath::Vector2    m_viewSize;
+    DirectX::SimpleMath::Vector2    m_updateViewOrigin; // the view origin during the latest update, and
+    DirectX::SimpleMath::Vector2    m_previousViewOrigin; // during the one before, which drawing blends from
+    bool                            m_hasUpdated; // false until the first update, which has no previous view
     DirectX::SimpleMath::Vector2    m_worldBoundary;
 };
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "BehaviorModule.h"
+#include "WorldEventBus.h"
+#include "WorldSnapshot.h"
+
+namespace
+{
+// Pending events are saved as raw bytes, so they must have no padding.
+static_assert(sizeof(DespawnedEvent) == 2 * sizeof(uint32_t), "DespawnedEvent has padding");
+static_assert(sizeof(TeamChangedEvent) == 3 * sizeof(uint32_t), "TeamChangedEvent has padding");
+static_assert(sizeof(CollidedEvent) == 3 * sizeof(uint32_t), "CollidedEvent has padding");
+static_assert(sizeof(TargetAcquiredEvent) == 2 * sizeof(uint32_t), "TargetAcquiredEvent has padding");
+}
+
+WorldEventBus::WorldEventBus()
+{
+}
+
+WorldEventBus::~WorldEventBus()
+{
+}
+
+bool WorldEventBus::Queues::IsEmpty(WorldEventType type) const
+{
+    switch (type)
+    {
+    case WorldEventType::Despawned:         return despawned.empty();
+    case WorldEventType::TeamChanged:       return teamChanged.empty();
+    case WorldEventType::Collided:          return collided.empty();
+    case WorldEventType::TargetAcquired:    return targetAcquired.empty();
+    }
+    return true;
+}
+
+void WorldEventBus::Queues::Clear()
+{
+    despawned.clear();
+    teamChanged.clear();
+    collided.clear();
+    targetAcquired.clear();
+}
+
+WorldEventSubscription WorldEventBus::Subscribe(WorldEventType type, BehaviorModule* module, GameObject* object)
+{
+    auto& list = m_subscriberLists[size_t(type)];
+
+    uint32_t index;
+    if (list.freeSlots.empty())
+    {
+        index = uint32_t(list.subscribers.size());
+        list.subscribers.push_back({ module, object });
+    }
+    else
+    {
+        index = list.freeSlots.back();
+        list.freeSlots.pop_back();
+        list.subscribers[index] = { module, object };
+    }
+
+    return { type, index };
+}
+
+void WorldEventBus::Unsubscribe(const WorldEventSubscription& subscription)
+{
+    auto& list = m_subscriberLists[size_t(subscription.type)];
+    if (subscription.index < list.subscribers.size() && list.subscribers[subscription.index].module)
+    {
+        list.subscribers[subscription.index] = { nullptr, nullptr };
+        list.freeSlots.push_back(subscription.index);
+    }
+}
+
+void WorldEventBus::Publish(const CollidedEvent* events, size_t count)
+{
+    // Grow geometrically: inserting a range into an empty vector reserves just that range, so the queues
+    // would reallocate on almost every batch larger than the last one.
+    auto& collided = m_pending.collided;
+    if (collided.size() + count > collided.capacity())
+    {
+        collided.reserve(std::max(collided.size() + count, 2 * collided.capacity()));
+    }
+    collided.insert(collided.end(), events, events + count);
+}
+
+void WorldEventBus::Deliver(World* world)
+{
+    // Anything published while delivering goes out with the next batch.
+    m_delivering.Clear();
+    std::swap(m_delivering, m_pending);
+
+    m_despawnedIds.clear();
+    for (const auto& event : m_delivering.despawned)
+    {
+        m_despawnedIds.push_back(event.objectId);
+    }
+    std::sort(m_despawnedIds.begin(), m_despawnedIds.end());
+
+    for (size_t type = 0; type < WorldEventTypeCount; ++type)
+    {
+        if (m_delivering.IsEmpty(WorldEventType(type)))
+            continue;
+
+        // Subscribers added during delivery wait for the next batch; removed ones are skipped.
+        const auto& subscribers = m_subscriberLists[type].subscribers;
+        for (size_t i = 0, count = subscribers.size(); i < count; ++i)
+        {
+            auto subscriber = subscribers[i];
+            if (subscriber.module)
+            {
+                subscriber.module->OnWorldEvents(world, subscriber.object, WorldEventType(type), *this);
+            }
+        }
+    }
+}
+
+void WorldEventBus::Clear()
+{
+    m_delivering.Clear();
+    m_pending.Clear();
+    m_despawnedIds.clear();
+}
+
+bool WorldEventBus::WasDespawned(uint32_t objectId) const
+{
+    return std::binary_search(m_despawnedIds.cbegin(), m_despawnedIds.cend(), objectId);
+}
+
+void WorldEventBus::SavePending(SnapshotWriter* writer) const
+{
+    writer->WriteArray(m_pending.despawned.data(), m_pending.despawned.size());
+    writer->WriteArray(m_pending.teamChanged.data(), m_pending.teamChanged.size());
+    writer->WriteArray(m_pending.collided.data(), m_pending.collided.size());
+    writer->WriteArray(m_pending.targetAcquired.data(), m_pending.targetAcquired.size());
+}
+
+bool WorldEventBus::LoadPending(SnapshotReader* reader)
+{
+    m_delivering.Clear();
+    m_despawnedIds.clear();
+    return reader->ReadArray(&m_pending.despawned) && reader->ReadArray(&m_pending.teamChanged) &&
+        reader->ReadArray(&m_pending.collided) && reader->ReadArray(&m_pending.targetAcquired);
+}
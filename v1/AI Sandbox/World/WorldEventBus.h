@@ -0,0 +1,116 @@
+#pragma once
+
+class BehaviorModule;
+class GameObject;
+class SnapshotReader;
+class SnapshotWriter;
+class World;
+
+enum class WorldEventType : uint8_t
+{
+    Despawned,
+    TeamChanged,
+    Collided,
+    TargetAcquired
+};
+
+const size_t WorldEventTypeCount = 4;
+
+// Events refer to objects by id, so they stay valid after the objects are gone. Snapshots save them as raw
+// bytes, so they are built from fixed-size fields with no padding.
+struct DespawnedEvent
+{
+    uint32_t    objectId;
+    uint32_t    teamNumber;
+};
+
+struct TeamChangedEvent
+{
+    uint32_t    objectId;
+    uint32_t    previousTeamNumber;
+    uint32_t    teamNumber;
+};
+
+// A contact that began this update (it did not exist in the previous one).
+struct CollidedEvent
+{
+    uint32_t    objectIdA;
+    uint32_t    objectIdB;
+    float       normalImpulse;
+};
+
+struct TargetAcquiredEvent
+{
+    uint32_t    objectId;
+    uint32_t    targetId;
+};
+
+struct WorldEventSubscription
+{
+    WorldEventType  type;
+    uint32_t        index;
+};
+
+// Queues the world's events by type and delivers each type's queue in one batch to the behavior modules
+// subscribed to it, once per update at the start of World::Update. Events published during an update (or
+// between updates) are delivered at the next one, so every subscriber sees the same batch no matter when it
+// runs. Nothing is delivered, and nothing runs, for a type with no events.
+class WorldEventBus
+{
+public:
+    WorldEventBus();
+    ~WorldEventBus();
+
+    void Publish(const DespawnedEvent& event) { m_pending.despawned.push_back(event); }
+    void Publish(const TeamChangedEvent& event) { m_pending.teamChanged.push_back(event); }
+    void Publish(const CollidedEvent* events, size_t count);
+    void Publish(const TargetAcquiredEvent& event) { m_pending.targetAcquired.push_back(event); }
+
+    // The module's OnWorldEvents is called with object for every batch of this type, until unsubscribed
+    // (modules unsubscribe when destroyed).
+    WorldEventSubscription Subscribe(WorldEventType type, BehaviorModule* module, GameObject* object);
+    void Unsubscribe(const WorldEventSubscription& subscription);
+
+    void Deliver(World* world);
+    void Clear();
+
+    // The batch being delivered.
+    const std::vector<DespawnedEvent>& GetDespawnedEvents() const { return m_delivering.despawned; }
+    const std::vector<TeamChangedEvent>& GetTeamChangedEvents() const { return m_delivering.teamChanged; }
+    const std::vector<CollidedEvent>& GetCollidedEvents() const { return m_delivering.collided; }
+    const std::vector<TargetAcquiredEvent>& GetTargetAcquiredEvents() const { return m_delivering.targetAcquired; }
+    bool WasDespawned(uint32_t objectId) const; // in the batch being delivered
+
+    // Snapshot support: events not delivered yet.
+    void SavePending(SnapshotWriter* writer) const;
+    bool LoadPending(SnapshotReader* reader);
+
+private:
+    struct Queues
+    {
+        std::vector<DespawnedEvent>         despawned;
+        std::vector<TeamChangedEvent>       teamChanged;
+        std::vector<CollidedEvent>          collided;
+        std::vector<TargetAcquiredEvent>    targetAcquired;
+
+        bool IsEmpty(WorldEventType type) const;
+        void Clear();
+    };
+
+    struct Subscriber
+    {
+        BehaviorModule* module; // null when the slot is free
+        GameObject*     object;
+    };
+
+    struct SubscriberList
+    {
+        std::vector<Subscriber> subscribers;
+        std::vector<uint32_t>   freeSlots;
+    };
+
+    Queues                  m_delivering;
+    std::vector<uint32_t>   m_despawnedIds; // sorted, for WasDespawned
+    Queues                  m_pending;
+    SubscriberList          m_subscriberLists[WorldEventTypeCount];
+};
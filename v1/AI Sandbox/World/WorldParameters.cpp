@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "WorldParameters.h"
+
+using namespace Config;
+
+WorldParameters::WorldParameters() :
+    activationRadius(World_ActivationRadius),
+    chunkSize(World_ChunkSize),
+    contactBaumgarteFactor(ContactSolver_BaumgarteFactor),
+    contactMaxIterations(ContactSolver_MaxIterations),
+    contactParallelSolve(ContactSolver_ParallelSolve),
+    contactPenetrationSlop(ContactSolver_PenetrationSlop),
+    contactResidualTolerance(ContactSolver_ResidualTolerance),
+    contactRestitutionThreshold(ContactSolver_RestitutionThreshold),
+    contactWarmStarting(ContactSolver_WarmStarting),
+    dormantUpdateInterval(World_DormantUpdateInterval),
+    followDistance(Follow_DefaultDistance),
+    frictionCoefficient(World_FrictionCoefficient),
+    gravity(World_Gravity),
+    height(World_Height),
+    objectCoefficientFriction(GameObject_DefaultCoefficientFriction),
+    objectCoefficientRestitution(GameObject_DefaultCoefficientRestitution),
+    objectMass(GameObject_DefaultMass),
+    objectMaxAcceleration(GameObject_DefaultMaxAcceleration),
+    objectMaxAngularVelocity(GameObject_DefaultMaxAngularVelocity),
+    objectMaxSpeed(GameObject_DefaultMaxSpeed),
+    objectRadius(GameObject_DefaultRadius),
+    viewCullMargin(World_ViewCullMargin),
+    width(World_Width)
+{
+}
+
+Archetype WorldParameters::GetDefaultArchetype() const
+{
+    Archetype archetype;
+    archetype.coefficientFriction = objectCoefficientFriction;
+    archetype.coefficientRestitution = objectCoefficientRestitution;
+    archetype.mass = objectMass;
+    archetype.maxAcceleration = objectMaxAcceleration;
+    archetype.maxAngularVelocity = objectMaxAngularVelocity;
+    archetype.maxSpeed = objectMaxSpeed;
+    archetype.radius = objectRadius;
+    return archetype;
+}
+
+float WorldParameters::* WorldParameters::FindFloatParameter(const std::string& name)
+{
+    static const struct
+    {
+        const char*             name;
+        float WorldParameters::* parameter;
+    } parameters[] =
+    {
+        { "ContactSolver_BaumgarteFactor", &WorldParameters::contactBaumgarteFactor },
+        { "ContactSolver_PenetrationSlop", &WorldParameters::contactPenetrationSlop },
+        { "ContactSolver_ResidualTolerance", &WorldParameters::contactResidualTolerance },
+        { "ContactSolver_RestitutionThreshold", &WorldParameters::contactRestitutionThreshold },
+        { "Follow_DefaultDistance", &WorldParameters::followDistance },
+        { "GameObject_DefaultCoefficientFriction", &WorldParameters::objectCoefficientFriction },
+        { "GameObject_DefaultCoefficientRestitution", &WorldParameters::objectCoefficientRestitution },
+        { "GameObject_DefaultMass", &WorldParameters::objectMass },
+        { "GameObject_DefaultMaxAcceleration", &WorldParameters::objectMaxAcceleration },
+        { "GameObject_DefaultMaxAngularVelocity", &WorldParameters::objectMaxAngularVelocity },
+        { "GameObject_DefaultMaxSpeed", &WorldParameters::objectMaxSpeed },
+        { "GameObject_DefaultRadius", &WorldParameters::objectRadius },
+        { "World_ActivationRadius", &WorldParameters::activationRadius },
+        { "World_ChunkSize", &WorldParameters::chunkSize },
+        { "World_FrictionCoefficient", &WorldParameters::frictionCoefficient },
+        { "World_Gravity", &WorldParameters::gravity },
+        { "World_Height", &WorldParameters::height },
+        { "World_Width", &WorldParameters::width },
+    };
+
+    for (const auto& entry : parameters)
+    {
+        if (name == entry.name)
+            return entry.parameter;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+#include "ArchetypeTable.h"
+
+// Simulation settings owned by one World. They start from the Config values current at construction, then
+// belong to the world, so worlds with different settings can run side by side in one process (see
+// ParameterSweep). Objects and behaviors read them through World::GetParameters.
+struct WorldParameters
+{
+    WorldParameters();
+
+    // Look up a float parameter by its Config name (for example "World_FrictionCoefficient").
+    // Returns nullptr if there is no float parameter with that name.
+    static float WorldParameters::* FindFloatParameter(const std::string& name);
+
+    // The world's Default archetype, from the object parameters.
+    Archetype GetDefaultArchetype() const;
+
+    // Collision resolution
+    float   contactBaumgarteFactor; // fraction of remaining penetration corrected per update
+    int     contactMaxIterations;
+    bool    contactParallelSolve;
+    float   contactPenetrationSlop; // meters
+    float   contactResidualTolerance; // Newton-seconds
+    float   contactRestitutionThreshold; // meters per second
+    bool    contactWarmStarting;
+
+    // Behavior modules
+    float   followDistance; // meters
+
+    // Drawing
+    float   viewCullMargin; // meters around the view within which objects are still drawn
+
+    // Default archetype of game objects in this world
+    float   objectCoefficientFriction;
+    float   objectCoefficientRestitution;
+    float   objectMass; // kilograms
+    float   objectMaxAcceleration; // meters per second per second
+    float   objectMaxAngularVelocity; // radians per second
+    float   objectMaxSpeed; // meters per second
+    float   objectRadius; // meters
+
+    // World attributes
+    float   activationRadius; // meters
+    float   chunkSize; // meters
+    int     dormantUpdateInterval; // updates
+    float   frictionCoefficient;
+    float   gravity; // meters per second per second
+    float   height; // meters
+    float   width; // meters
+};
@@ -0,0 +1,600 @@
+#include "pch.h"
+#include "FastMath.h"
+#include "GameObject.h"
+#include "WorldPartition.h"
+#include "WorldSnapshot.h"
+
+using namespace Config;
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+const uint32_t NoChunk = UINT32_MAX;
+
+// Chunk flags in a saved layout
+const uint32_t ChunkActive = 0x1;
+const uint32_t ChunkMoving = 0x2;
+}
+
+WorldPartition::WorldPartition() :
+    m_activationRadius(World_ActivationRadius),
+    m_activationStamp(0),
+    m_chunkSize(World_ChunkSize),
+    m_columns(0),
+    m_dormantUpdateCounter(0),
+    m_dormantUpdateInterval(std::max(1, World_DormantUpdateInterval)),
+    m_frictionDeceleration(World_FrictionCoefficient * World_Gravity),
+    m_rows(0),
+    m_stats()
+{
+}
+
+WorldPartition::~WorldPartition()
+{
+}
+
+void WorldPartition::Resize(Vector2 extent, float chunkSize)
+{
+    // Collect everything currently in the partition, with up-to-date state.
+    SyncDormantObjects();
+
+    auto objects = m_activeObjects;
+    for (const auto& chunk : m_chunks)
+    {
+        objects.insert(objects.end(), chunk.dormant.objects.begin(), chunk.dormant.objects.end());
+    }
+
+    m_chunkSize = chunkSize;
+    m_columns = std::max(1, int32_t(std::ceil(extent.x / chunkSize)));
+    m_rows = std::max(1, int32_t(std::ceil(extent.y / chunkSize)));
+
+    m_chunks.clear();
+    m_chunks.resize(size_t(m_columns) * m_rows);
+    m_activeChunks.clear();
+    m_activeObjects.clear();
+    m_movingChunks.clear();
+    m_stats.dormantObjectCount = 0;
+
+    // Everything starts out dormant; the next Update activates the chunks around the activation points.
+    for (auto object : objects)
+    {
+        object->SetChunkIndex(NoChunk);
+        Insert(object);
+    }
+}
+
+void WorldPartition::Clear()
+{
+    // Empty every chunk, keeping the storage for reuse. The objects themselves are not touched: they may
+    // already be gone.
+    for (auto& chunk : m_chunks)
+    {
+        chunk.dormant.objects.clear();
+        chunk.dormant.positionX.clear();
+        chunk.dormant.positionY.clear();
+        chunk.dormant.velocityX.clear();
+        chunk.dormant.velocityY.clear();
+        chunk.activationStamp = 0;
+        chunk.activeBegin = 0;
+        chunk.activeCount = 0;
+        chunk.isActive = false;
+        chunk.isMoving = false;
+    }
+
+    m_activeChunks.clear();
+    m_activeObjects.clear();
+    m_activatedObjects.clear();
+    m_movingChunks.clear();
+    m_activationStamp = 0;
+    m_stats.dormantObjectCount = 0;
+}
+
+void WorldPartition::Insert(GameObject* object)
+{
+    if (!object || m_chunks.empty())
+        return;
+
+    InsertIntoChunk(object, ChunkIndexAt(object->GetPosition()));
+}
+
+void WorldPartition::Remove(GameObject* object)
+{
+    if (!object || object->GetChunkIndex() >= m_chunks.size())
+        return;
+
+    auto chunkIndex = object->GetChunkIndex();
+    auto& chunk = m_chunks[chunkIndex];
+    object->SetChunkIndex(NoChunk);
+
+    if (chunk.isActive)
+    {
+        auto begin = m_activeObjects.begin() + chunk.activeBegin;
+        auto it = std::find(begin, begin + chunk.activeCount, object);
+        if (it != begin + chunk.activeCount)
+        {
+            m_activeObjects.erase(it);
+            --chunk.activeCount;
+            ShiftActiveRanges(chunkIndex, -1);
+        }
+        return;
+    }
+
+    auto& dormant = chunk.dormant;
+    auto dormantIt = std::find(dormant.objects.begin(), dormant.objects.end(), object);
+    if (dormantIt != dormant.objects.end())
+    {
+        // Write back what the object missed while it was paged out, then swap-remove it.
+        auto i = size_t(dormantIt - dormant.objects.begin());
+        object->SetPosition(Vector2(dormant.positionX[i], dormant.positionY[i]));
+        object->SetVelocity(Vector2(dormant.velocityX[i], dormant.velocityY[i]));
+
+        auto last = dormant.objects.size() - 1;
+        dormant.objects[i] = dormant.objects[last];
+        dormant.positionX[i] = dormant.positionX[last];
+        dormant.positionY[i] = dormant.positionY[last];
+        dormant.velocityX[i] = dormant.velocityX[last];
+        dormant.velocityY[i] = dormant.velocityY[last];
+        dormant.objects.pop_back();
+        dormant.positionX.pop_back();
+        dormant.positionY.pop_back();
+        dormant.velocityX.pop_back();
+        dormant.velocityY.pop_back();
+        --m_stats.dormantObjectCount;
+    }
+}
+
+void WorldPartition::Update(const Vector2* activationPoints, size_t activationPointCount,
+    Vector2 activationMin, Vector2 activationMax, float elapsedTime, std::vector<GameObject*>& activeObjects)
+{
+    activeObjects.clear();
+    if (m_chunks.empty())
+        return;
+
+    // Find the chunks that overlap a circle around any activation point, or the activation rectangle.
+    ++m_activationStamp;
+    m_nextActiveChunks.clear();
+
+    auto radiusSquared = m_activationRadius * m_activationRadius;
+    for (size_t i = 0; i < activationPointCount; ++i)
+    {
+        auto point = activationPoints[i];
+        auto minX = std::max(0, int32_t(std::floor((point.x - m_activationRadius) / m_chunkSize)));
+        auto minY = std::max(0, int32_t(std::floor((point.y - m_activationRadius) / m_chunkSize)));
+        auto maxX = std::min(m_columns - 1, int32_t(std::floor((point.x + m_activationRadius) / m_chunkSize)));
+        auto maxY = std::min(m_rows - 1, int32_t(std::floor((point.y + m_activationRadius) / m_chunkSize)));
+
+        for (auto y = minY; y <= maxY; ++y)
+        {
+            for (auto x = minX; x <= maxX; ++x)
+            {
+                // Distance from the point to the closest point of the chunk.
+                auto dx = point.x - std::min(std::max(point.x, x * m_chunkSize), (x + 1) * m_chunkSize);
+                auto dy = point.y - std::min(std::max(point.y, y * m_chunkSize), (y + 1) * m_chunkSize);
+                if (dx * dx + dy * dy <= radiusSquared)
+                {
+                    MarkActive(x, y);
+                }
+            }
+        }
+    }
+
+    if (activationMax.x > activationMin.x && activationMax.y > activationMin.y)
+    {
+        auto minIndex = ChunkIndexAt(activationMin);
+        auto maxIndex = ChunkIndexAt(activationMax);
+        for (auto y = int32_t(minIndex / m_columns); y <= int32_t(maxIndex / m_columns); ++y)
+        {
+            for (auto x = int32_t(minIndex % m_columns); x <= int32_t(maxIndex % m_columns); ++x)
+            {
+                MarkActive(x, y);
+            }
+        }
+    }
+
+    std::sort(m_nextActiveChunks.begin(), m_nextActiveChunks.end());
+
+    for (auto chunkIndex : m_activeChunks)
+    {
+        if (m_chunks[chunkIndex].activationStamp != m_activationStamp)
+        {
+            Deactivate(chunkIndex);
+        }
+    }
+
+    for (auto chunkIndex : m_nextActiveChunks)
+    {
+        if (!m_chunks[chunkIndex].isActive)
+        {
+            Activate(chunkIndex);
+        }
+    }
+
+    std::swap(m_activeChunks, m_nextActiveChunks);
+
+    // Aggregate update of dormant chunks that are still settling, a few ticks' worth at a time.
+    if (++m_dormantUpdateCounter >= uint32_t(m_dormantUpdateInterval))
+    {
+        m_dormantUpdateCounter = 0;
+
+        size_t stillMoving = 0;
+        for (auto chunkIndex : m_movingChunks)
+        {
+            UpdateDormantChunk(chunkIndex, elapsedTime * m_dormantUpdateInterval);
+            if (m_chunks[chunkIndex].isMoving)
+            {
+                m_movingChunks[stillMoving++] = chunkIndex;
+            }
+        }
+        m_movingChunks.resize(stillMoving);
+    }
+
+    RegroupActiveObjects();
+    activeObjects.assign(m_activeObjects.begin(), m_activeObjects.end());
+
+    m_stats.chunkCount = m_chunks.size();
+    m_stats.activeChunkCount = m_activeChunks.size();
+    m_stats.activeObjectCount = activeObjects.size();
+    m_stats.movingDormantChunkCount = m_movingChunks.size();
+}
+
+void WorldPartition::GetActiveObjectsIn(Vector2 min, Vector2 max, std::vector<GameObject*>* objects) const
+{
+    if (m_chunks.empty() || max.x < 0.f || max.y < 0.f || min.x > m_columns * m_chunkSize || min.y > m_rows * m_chunkSize)
+        return;
+
+    // Clamped as floats first, so unbounded rectangles do not overflow the conversion.
+    auto toColumn = [&](float x) { return int32_t(std::min(std::max(x / m_chunkSize, 0.f), float(m_columns - 1))); };
+    auto toRow = [&](float y) { return int32_t(std::min(std::max(y / m_chunkSize, 0.f), float(m_rows - 1))); };
+    auto minX = toColumn(min.x);
+    auto maxX = toColumn(max.x);
+    auto maxY = toRow(max.y);
+
+    for (auto y = toRow(min.y); y <= maxY; ++y)
+    {
+        for (auto x = minX; x <= maxX; ++x)
+        {
+            const auto& chunk = m_chunks[y * m_columns + x];
+            if (chunk.isActive)
+            {
+                objects->insert(objects->end(), m_activeObjects.begin() + chunk.activeBegin,
+                    m_activeObjects.begin() + chunk.activeBegin + chunk.activeCount);
+            }
+        }
+    }
+}
+
+void WorldPartition::SyncDormantObjects()
+{
+    for (auto& chunk : m_chunks)
+    {
+        const auto& dormant = chunk.dormant;
+        for (size_t i = 0; i < dormant.objects.size(); ++i)
+        {
+            dormant.objects[i]->SetPosition(Vector2(dormant.positionX[i], dormant.positionY[i]));
+            dormant.objects[i]->SetVelocity(Vector2(dormant.velocityX[i], dormant.velocityY[i]));
+        }
+    }
+}
+
+void WorldPartition::SaveLayout(SnapshotWriter* writer)
+{
+    // Per chunk that is not empty and idle: index, flags, object count, then the objects' snapshot indices.
+    m_layout.clear();
+    for (uint32_t chunkIndex = 0; chunkIndex < uint32_t(m_chunks.size()); ++chunkIndex)
+    {
+        const auto& chunk = m_chunks[chunkIndex];
+        auto objects = chunk.isActive ? m_activeObjects.data() + chunk.activeBegin : chunk.dormant.objects.data();
+        auto objectCount = chunk.isActive ? chunk.activeCount : uint32_t(chunk.dormant.objects.size());
+        if (objectCount == 0 && !chunk.isActive && !chunk.isMoving)
+            continue;
+
+        m_layout.push_back(chunkIndex);
+        m_layout.push_back((chunk.isActive ? ChunkActive : 0) | (chunk.isMoving ? ChunkMoving : 0));
+        m_layout.push_back(objectCount);
+        for (uint32_t i = 0; i < objectCount; ++i)
+        {
+            m_layout.push_back(writer->GetObjectIndex(objects[i]));
+        }
+    }
+
+    writer->Write(uint64_t(m_chunks.size()));
+    writer->Write(m_dormantUpdateCounter);
+    writer->WriteArray(m_layout.data(), m_layout.size());
+}
+
+bool WorldPartition::RestoreLayout(SnapshotReader* reader)
+{
+    uint64_t chunkCount;
+    if (!reader->Read(&chunkCount) || chunkCount != m_chunks.size() ||
+        !reader->Read(&m_dormantUpdateCounter) || !reader->ReadArray(&m_layout))
+        return false;
+
+    Clear();
+
+    for (size_t i = 0; i + 3 <= m_layout.size();)
+    {
+        auto chunkIndex = m_layout[i];
+        auto flags = m_layout[i + 1];
+        auto objectCount = m_layout[i + 2];
+        i += 3;
+
+        // Chunks must come in order, so active objects are grouped as Update leaves them.
+        if (chunkIndex >= m_chunks.size() || (!m_activeChunks.empty() && chunkIndex <= m_activeChunks.back()) ||
+            objectCount > m_layout.size() - i)
+            return false;
+
+        auto& chunk = m_chunks[chunkIndex];
+        chunk.isActive = (flags & ChunkActive) != 0;
+        chunk.isMoving = (flags & ChunkMoving) != 0;
+        if (chunk.isActive)
+        {
+            chunk.activeBegin = uint32_t(m_activeObjects.size());
+            m_activeChunks.push_back(chunkIndex);
+        }
+        if (chunk.isMoving)
+        {
+            m_movingChunks.push_back(chunkIndex);
+        }
+
+        for (uint32_t end = uint32_t(i) + objectCount; i < end; ++i)
+        {
+            auto object = reader->GetObjectAt(m_layout[i]);
+            if (!object)
+                return false;
+
+            object->SetChunkIndex(chunkIndex);
+            if (chunk.isActive)
+            {
+                m_activeObjects.push_back(object);
+                ++chunk.activeCount;
+                continue;
+            }
+
+            auto position = object->GetPosition();
+            auto velocity = object->GetVelocity();
+            chunk.dormant.objects.push_back(object);
+            chunk.dormant.positionX.push_back(position.x);
+            chunk.dormant.positionY.push_back(position.y);
+            chunk.dormant.velocityX.push_back(velocity.x);
+            chunk.dormant.velocityY.push_back(velocity.y);
+            ++m_stats.dormantObjectCount;
+        }
+    }
+
+    return true;
+}
+
+uint32_t WorldPartition::ChunkIndexAt(Vector2 position) const
+{
+    auto x = std::min(m_columns - 1, std::max(0, int32_t(std::floor(position.x / m_chunkSize))));
+    auto y = std::min(m_rows - 1, std::max(0, int32_t(std::floor(position.y / m_chunkSize))));
+    return uint32_t(y * m_columns + x);
+}
+
+void WorldPartition::MarkActive(int32_t x, int32_t y)
+{
+    auto chunkIndex = uint32_t(y * m_columns + x);
+    auto& chunk = m_chunks[chunkIndex];
+    if (chunk.activationStamp != m_activationStamp)
+    {
+        chunk.activationStamp = m_activationStamp;
+        m_nextActiveChunks.push_back(chunkIndex);
+    }
+}
+
+void WorldPartition::InsertIntoChunk(GameObject* object, uint32_t chunkIndex)
+{
+    auto& chunk = m_chunks[chunkIndex];
+    object->SetChunkIndex(chunkIndex);
+
+    if (chunk.isActive)
+    {
+        // Joins the end of the chunk's group (only between updates: Update regroups everything itself).
+        m_activeObjects.insert(m_activeObjects.begin() + chunk.activeBegin + chunk.activeCount, object);
+        ++chunk.activeCount;
+        ShiftActiveRanges(chunkIndex, 1);
+        return;
+    }
+
+    PageOut(object, chunkIndex);
+}
+
+void WorldPartition::PageOut(GameObject* object, uint32_t chunkIndex)
+{
+    auto& chunk = m_chunks[chunkIndex];
+    object->SetChunkIndex(chunkIndex);
+
+    auto position = object->GetPosition();
+    auto velocity = object->GetVelocity();
+    auto& dormant = chunk.dormant;
+    dormant.objects.push_back(object);
+    dormant.positionX.push_back(position.x);
+    dormant.positionY.push_back(position.y);
+    dormant.velocityX.push_back(velocity.x);
+    dormant.velocityY.push_back(velocity.y);
+    ++m_stats.dormantObjectCount;
+
+    if (!chunk.isMoving && velocity != Vector2::Zero)
+    {
+        chunk.isMoving = true;
+        m_movingChunks.push_back(chunkIndex);
+    }
+}
+
+void WorldPartition::Activate(uint32_t chunkIndex)
+{
+    auto& chunk = m_chunks[chunkIndex];
+    auto& dormant = chunk.dormant;
+
+    // Page the objects back in.
+    for (size_t i = 0; i < dormant.objects.size(); ++i)
+    {
+        auto object = dormant.objects[i];
+        object->SetPosition(Vector2(dormant.positionX[i], dormant.positionY[i]));
+        object->SetVelocity(Vector2(dormant.velocityX[i], dormant.velocityY[i]));
+        m_activatedObjects.push_back(object);
+    }
+    m_stats.dormantObjectCount -= dormant.objects.size();
+
+    dormant.objects.clear();
+    dormant.positionX.clear();
+    dormant.positionY.clear();
+    dormant.velocityX.clear();
+    dormant.velocityY.clear();
+
+    if (chunk.isMoving)
+    {
+        m_movingChunks.erase(std::find(m_movingChunks.begin(), m_movingChunks.end(), chunkIndex));
+        chunk.isMoving = false;
+    }
+    chunk.activeCount = 0;
+    chunk.isActive = true;
+}
+
+void WorldPartition::Deactivate(uint32_t chunkIndex)
+{
+    auto& chunk = m_chunks[chunkIndex];
+    chunk.isActive = false;
+
+    // Page the objects out, each to the chunk it is in now: it may have crossed into another since the last
+    // regroup, and paged out here it would be clamped back into this one. Objects that crossed into a chunk
+    // that stays active keep their place in m_activeObjects for RegroupActiveObjects to group; the rest stay
+    // there until it drops them.
+    for (uint32_t i = 0; i < chunk.activeCount; ++i)
+    {
+        auto object = m_activeObjects[chunk.activeBegin + i];
+        auto targetIndex = ChunkIndexAt(object->GetPosition());
+        if (targetIndex != chunkIndex && m_chunks[targetIndex].activationStamp == m_activationStamp)
+        {
+            object->SetChunkIndex(targetIndex);
+        }
+        else
+        {
+            PageOut(object, targetIndex);
+        }
+    }
+    chunk.activeCount = 0;
+}
+
+void WorldPartition::RegroupActiveObjects()
+{
+    // Objects that crossed into another chunk since the last update move with it: into the new chunk's group
+    // if it is active, out to its dormant state if not. Objects of chunks deactivated this update are dropped.
+    for (auto chunkIndex : m_activeChunks)
+    {
+        m_chunks[chunkIndex].activeCount = 0;
+    }
+
+    m_regroupObjects.clear();
+    auto regroup = [&](GameObject* object)
+    {
+        auto chunkIndex = object->GetChunkIndex();
+        if (!m_chunks[chunkIndex].isActive)
+            return;
+
+        auto targetIndex = ChunkIndexAt(object->GetPosition());
+        if (targetIndex != chunkIndex)
+        {
+            if (!m_chunks[targetIndex].isActive)
+            {
+                InsertIntoChunk(object, targetIndex);
+                return;
+            }
+            object->SetChunkIndex(targetIndex);
+        }
+
+        ++m_chunks[targetIndex].activeCount;
+        m_regroupObjects.push_back(object);
+    };
+
+    for (auto object : m_activeObjects)
+    {
+        regroup(object);
+    }
+    for (auto object : m_activatedObjects)
+    {
+        regroup(object);
+    }
+    m_activatedObjects.clear();
+
+    // Counting sort by chunk; each chunk's objects keep the order they were visited in above.
+    uint32_t begin = 0;
+    for (auto chunkIndex : m_activeChunks)
+    {
+        auto& chunk = m_chunks[chunkIndex];
+        chunk.activeBegin = begin;
+        begin += chunk.activeCount;
+        chunk.activeCount = 0;
+    }
+
+    m_activeObjects.resize(m_regroupObjects.size());
+    for (auto object : m_regroupObjects)
+    {
+        auto& chunk = m_chunks[object->GetChunkIndex()];
+        m_activeObjects[chunk.activeBegin + chunk.activeCount++] = object;
+    }
+}
+
+void WorldPartition::ShiftActiveRanges(uint32_t chunkIndex, int32_t offset)
+{
+    auto it = std::upper_bound(m_activeChunks.begin(), m_activeChunks.end(), chunkIndex);
+    for (; it != m_activeChunks.end(); ++it)
+    {
+        auto& chunk = m_chunks[*it];
+        chunk.activeBegin = uint32_t(int64_t(chunk.activeBegin) + offset);
+    }
+}
+
+void WorldPartition::UpdateDormantChunk(uint32_t chunkIndex, float elapsedTime)
+{
+    auto& chunk = m_chunks[chunkIndex];
+    auto& dormant = chunk.dormant;
+    auto count = dormant.objects.size();
+
+    // Objects stay inside their chunk while it is dormant, so membership never changes here.
+    auto minX = (chunkIndex % m_columns) * m_chunkSize;
+    auto minY = (chunkIndex / m_columns) * m_chunkSize;
+    auto maxX = std::nextafter(minX + m_chunkSize, minX);
+    auto maxY = std::nextafter(minY + m_chunkSize, minY);
+
+    m_speeds.resize(count);
+    FastMath::LengthBatch(dormant.velocityX.data(), dormant.velocityY.data(), m_speeds.data(), count);
+
+    auto speedLoss = m_frictionDeceleration * elapsedTime;
+    auto isMoving = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto speed = m_speeds[i];
+        if (speed <= 0.f)
+            continue;
+
+        // Friction alone slows the object, as in GameObject::IntegrateVelocity with no other forces.
+        auto newSpeed = speed - speedLoss;
+        auto scale = newSpeed < 0.1f ? 0.f : newSpeed / speed;
+        auto& vx = dormant.velocityX[i];
+        auto& vy = dormant.velocityY[i];
+        vx *= scale;
+        vy *= scale;
+
+        auto& px = dormant.positionX[i];
+        auto& py = dormant.positionY[i];
+        px += vx * elapsedTime;
+        py += vy * elapsedTime;
+
+        if (px < minX || px > maxX)
+        {
+            px = std::min(std::max(px, minX), maxX);
+            vx = 0.f;
+        }
+        if (py < minY || py > maxY)
+        {
+            py = std::min(std::max(py, minY), maxY);
+            vy = 0.f;
+        }
+
+        isMoving |= (vx != 0.f || vy != 0.f);
+    }
+
+    chunk.isMoving = isMoving;
+}
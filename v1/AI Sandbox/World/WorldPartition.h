@@ -0,0 +1,157 @@
+#pragma once
+
+class GameObject;
+class SnapshotReader;
+class SnapshotWriter;
+
+// Counts from the most recent WorldPartition::Update call.
+struct WorldPartitionStats
+{
+    size_t  chunkCount;
+    size_t  activeChunkCount;
+    size_t  activeObjectCount;
+    size_t  dormantObjectCount;
+    size_t  movingDormantChunkCount;    // dormant chunks whose objects have not yet come to rest
+};
+
+// Divides the world into square chunks, each owning the objects inside it.
+//
+// Chunks within the activation radius of an activation point (the players), or overlapping the activation
+// rectangle (the view), are active: their objects
+// are handed back to the World for the full behavior, integration and collision update. All other chunks
+// are dormant. A dormant chunk pages its objects' kinematic state out to compact arrays and only runs a
+// cheap aggregate update on them every few ticks (friction slows them to rest inside the chunk), so the
+// per-update cost is bounded by the active area rather than the size of the world. State is written back
+// to the objects when the chunk becomes active again.
+//
+// Active objects are kept in one array, grouped by chunk in chunk order, and regrouped every update. Its size
+// is bounded by the population, so objects crowding into chunks never make the partition allocate once the
+// array has grown to the active population.
+class WorldPartition
+{
+public:
+    WorldPartition();
+    ~WorldPartition();
+
+    // Re-create the chunk grid over [0,extent]. Every object already in the partition is re-inserted.
+    void Resize(DirectX::SimpleMath::Vector2 extent, float chunkSize);
+
+    void Insert(GameObject* object);
+    void Remove(GameObject* object);
+
+    // Drop every object, keeping the chunk grid. Paged-out state is discarded, not written back.
+    void Clear();
+
+    // Activate the chunks near the activation points or overlapping [activationMin,activationMax], deactivate
+    // the rest, run the dormant aggregate update and move active objects that changed chunks. activeObjects
+    // receives every object in an active chunk.
+    void Update(const DirectX::SimpleMath::Vector2* activationPoints, size_t activationPointCount,
+        DirectX::SimpleMath::Vector2 activationMin, DirectX::SimpleMath::Vector2 activationMax, float elapsedTime,
+        std::vector<GameObject*>& activeObjects);
+
+    // Write all paged-out state back to the objects (without waking them).
+    void SyncDormantObjects();
+
+    // Snapshot support: which objects each chunk holds and in what order, whether it is active or settling,
+    // and the dormant update phase. Object state is not included: sync dormant objects before saving it.
+    // Restore expects the same chunk grid and every object's state already restored, and re-homes the
+    // objects exactly as they were.
+    void SaveLayout(SnapshotWriter* writer);
+    bool RestoreLayout(SnapshotReader* reader);
+
+    // Every object in an active chunk, grouped by chunk.
+    const std::vector<GameObject*>& GetActiveObjects() const { return m_activeObjects; }
+
+    // Append the objects of the active chunks overlapping [min,max], grouped by chunk in chunk order. Only the
+    // chunks in the rectangle are visited, so the cost follows its area rather than the active population.
+    void GetActiveObjectsIn(DirectX::SimpleMath::Vector2 min, DirectX::SimpleMath::Vector2 max, std::vector<GameObject*>* objects) const;
+
+    // Call func(GameObject*) for every object in an active chunk.
+    template<typename TFunc>
+    void ForEachActiveObject(const TFunc& func) const
+    {
+        for (auto object : m_activeObjects)
+        {
+            func(object);
+        }
+    }
+
+    // Call func(GameObject*, position, velocity) for every object in a dormant chunk, with its paged-out state
+    // (which the object itself may not have yet).
+    template<typename TFunc>
+    void ForEachDormantObject(const TFunc& func) const
+    {
+        for (const auto& chunk : m_chunks)
+        {
+            const auto& dormant = chunk.dormant;
+            for (size_t i = 0; i < dormant.objects.size(); ++i)
+            {
+                func(dormant.objects[i], DirectX::SimpleMath::Vector2(dormant.positionX[i], dormant.positionY[i]),
+                    DirectX::SimpleMath::Vector2(dormant.velocityX[i], dormant.velocityY[i]));
+            }
+        }
+    }
+
+    const WorldPartitionStats& GetStats() const { return m_stats; }
+
+    void SetActivationRadius(float radius) { m_activationRadius = radius; }
+    void SetDormantUpdateInterval(int interval) { m_dormantUpdateInterval = std::max(1, interval); }
+    void SetFrictionDeceleration(float deceleration) { m_frictionDeceleration = deceleration; }
+
+private:
+    // Kinematic state of a dormant chunk's objects, structure-of-arrays.
+    struct DormantObjects
+    {
+        std::vector<GameObject*>    objects;
+        std::vector<float>          positionX;
+        std::vector<float>          positionY;
+        std::vector<float>          velocityX;
+        std::vector<float>          velocityY;
+    };
+
+    struct Chunk
+    {
+        Chunk() : activationStamp(0), activeBegin(0), activeCount(0), isActive(false), isMoving(false) {}
+
+        DormantObjects              dormant; // while dormant
+        uint32_t                    activationStamp;
+        uint32_t                    activeBegin; // while active, the chunk's objects in m_activeObjects
+        uint32_t                    activeCount;
+        bool                        isActive;
+        bool                        isMoving; // dormant, with objects still in motion
+    };
+
+    uint32_t ChunkIndexAt(DirectX::SimpleMath::Vector2 position) const;
+    void MarkActive(int32_t x, int32_t y);
+    void InsertIntoChunk(GameObject* object, uint32_t chunkIndex);
+    void PageOut(GameObject* object, uint32_t chunkIndex); // into the chunk's dormant state, whether or not it is active yet
+    void Activate(uint32_t chunkIndex);
+    void Deactivate(uint32_t chunkIndex);
+    void RegroupActiveObjects();
+    void UpdateDormantChunk(uint32_t chunkIndex, float elapsedTime);
+
+    // Shift the ranges of the active chunks after chunkIndex by one object (inserted or erased).
+    void ShiftActiveRanges(uint32_t chunkIndex, int32_t offset);
+
+    std::vector<Chunk>       m_chunks;
+    float                    m_chunkSize;
+    int32_t                  m_columns;
+    int32_t                  m_rows;
+
+    std::vector<uint32_t>    m_activeChunks; // sorted, so active objects are always visited in the same order
+    std::vector<GameObject*> m_activeObjects; // by chunk, in m_activeChunks order
+    std::vector<GameObject*> m_regroupObjects; // scratch for RegroupActiveObjects
+    std::vector<GameObject*> m_activatedObjects; // paged in this update, to be grouped
+    std::vector<uint32_t>    m_nextActiveChunks;
+    std::vector<uint32_t>    m_movingChunks;
+    uint32_t                 m_activationStamp;
+
+    float                    m_activationRadius;
+    int                      m_dormantUpdateInterval;
+    uint32_t                 m_dormantUpdateCounter;
+    float                    m_frictionDeceleration;
+    std::vector<float>       m_speeds;
+    std::vector<uint32_t>    m_layout; // snapshot scratch
+
+    WorldPartitionStats      m_stats;
+};
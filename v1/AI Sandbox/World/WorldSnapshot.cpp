@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "GameObject.h"
+#include "WorldSnapshot.h"
+
+#include <istream>
+#include <ostream>
+
+namespace
+{
+const uint32_t SnapshotMagic = 0x57534941; // "AISW"
+}
+
+const uint32_t WorldSnapshot::Version;
+const uint32_t SnapshotWriter::NoObject;
+
+WorldSnapshot::WorldSnapshot()
+{
+}
+
+WorldSnapshot::~WorldSnapshot()
+{
+}
+
+bool WorldSnapshot::Write(std::ostream& output) const
+{
+    auto size = uint64_t(m_data.size());
+    output.write(reinterpret_cast<const char*>(&SnapshotMagic), sizeof(SnapshotMagic));
+    output.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+    output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    output.write(reinterpret_cast<const char*>(m_data.data()), std::streamsize(m_data.size()));
+    return bool(output);
+}
+
+bool WorldSnapshot::Read(std::istream& input)
+{
+    uint32_t magic, version;
+    uint64_t size;
+    if (!input.read(reinterpret_cast<char*>(&magic), sizeof(magic)) ||
+        !input.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+        !input.read(reinterpret_cast<char*>(&size), sizeof(size)) ||
+        magic != SnapshotMagic || version != Version)
+        return false;
+
+    m_data.resize(size_t(size));
+    return bool(input.read(reinterpret_cast<char*>(m_data.data()), std::streamsize(size)));
+}
+
+SnapshotWriter::SnapshotWriter(WorldSnapshot* snapshot, const std::vector<uint32_t>* objectIndices) :
+    m_data(&snapshot->m_data),
+    m_objectIndices(objectIndices)
+{
+}
+
+uint32_t SnapshotWriter::GetObjectIndex(GameObject* object) const
+{
+    if (!object || !object->IsValidTarget() || object->GetId() >= m_objectIndices->size())
+        return NoObject;
+
+    return (*m_objectIndices)[object->GetId()];
+}
+
+SnapshotReader::SnapshotReader(const WorldSnapshot& snapshot) :
+    m_data(snapshot.m_data.data()),
+    m_failed(false),
+    m_objects(nullptr),
+    m_offset(0),
+    m_size(snapshot.m_data.size())
+{
+}
+
+bool SnapshotReader::ReadObject(std::shared_ptr<GameObject>* object)
+{
+    uint32_t index;
+    if (!Read(&index))
+        return false;
+
+    if (index == SnapshotWriter::NoObject)
+    {
+        *object = nullptr;
+        return true;
+    }
+
+    if (!m_objects || index >= m_objects->size())
+        return Fail();
+
+    *object = (*m_objects)[index];
+    return true;
+}
+
+GameObject* SnapshotReader::GetObjectAt(uint32_t index) const
+{
+    return m_objects && index < m_objects->size() ? (*m_objects)[index].get() : nullptr;
+}
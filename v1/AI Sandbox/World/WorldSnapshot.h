@@ -0,0 +1,124 @@
+#pragma once
+
+#include <iosfwd>
+
+class GameObject;
+
+// The saved state of a World (see World::SaveSnapshot and World::RestoreSnapshot), as one flat buffer.
+// Kinematic state is stored as arrays that are copied in bulk; behavior state is stored per module, with
+// references to other objects written as indices into the snapshot's object order.
+class WorldSnapshot
+{
+public:
+    static const uint32_t Version = 5;
+
+    WorldSnapshot();
+    ~WorldSnapshot();
+
+    void Clear() { m_data.clear(); }
+    bool IsEmpty() const { return m_data.empty(); }
+    size_t GetSize() const { return m_data.size(); }
+
+    // Stream the snapshot with a small header. Read returns false if the stream does not hold a snapshot of
+    // this version.
+    bool Write(std::ostream& output) const;
+    bool Read(std::istream& input);
+
+private:
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+
+    std::vector<uint8_t> m_data;
+};
+
+// Appends values to a snapshot. Values are written in the machine's byte order.
+class SnapshotWriter
+{
+public:
+    // objectIndices maps object ids to their index in the snapshot's object order.
+    SnapshotWriter(WorldSnapshot* snapshot, const std::vector<uint32_t>* objectIndices);
+
+    template<typename T>
+    void Write(const T& value)
+    {
+        WriteBytes(&value, sizeof(value));
+    }
+
+    // Write count, then the array contents in one copy.
+    template<typename T>
+    void WriteArray(const T* values, size_t count)
+    {
+        Write(uint64_t(count));
+        WriteBytes(values, count * sizeof(T));
+    }
+
+    // Write a reference to another object (null, or outside the world, becomes NoObject).
+    void WriteObject(GameObject* object) { Write(GetObjectIndex(object)); }
+    uint32_t GetObjectIndex(GameObject* object) const;
+
+    void Reserve(size_t bytes) { m_data->reserve(m_data->size() + bytes); }
+
+    static const uint32_t NoObject = UINT32_MAX;
+
+private:
+    void WriteBytes(const void* source, size_t size)
+    {
+        auto bytes = static_cast<const uint8_t*>(source);
+        m_data->insert(m_data->end(), bytes, bytes + size);
+    }
+
+    std::vector<uint8_t>*           m_data;
+    const std::vector<uint32_t>*    m_objectIndices;
+};
+
+// Reads values back in the order they were written. Reading past the end, or an array that does not fit,
+// puts the reader into a failed state in which every further read fails.
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const WorldSnapshot& snapshot);
+
+    template<typename T>
+    bool Read(T* value)
+    {
+        return ReadBytes(value, sizeof(*value));
+    }
+
+    // Read an array written by WriteArray into values, reusing its capacity.
+    template<typename T>
+    bool ReadArray(std::vector<T>* values)
+    {
+        uint64_t count;
+        if (!Read(&count) || count > (m_size - m_offset) / sizeof(T))
+            return Fail();
+
+        values->resize(size_t(count));
+        return ReadBytes(values->data(), size_t(count) * sizeof(T));
+    }
+
+    // Resolve an object reference written by WriteObject, against the restored objects in snapshot order.
+    void SetObjects(const std::vector<std::shared_ptr<GameObject>>* objects) { m_objects = objects; }
+    bool ReadObject(std::shared_ptr<GameObject>* object);
+    GameObject* GetObjectAt(uint32_t index) const; // null if the index is out of range
+
+    bool HasFailed() const { return m_failed; }
+    bool IsAtEnd() const { return m_offset == m_size; }
+
+private:
+    bool ReadBytes(void* destination, size_t size)
+    {
+        if (m_failed || size > m_size - m_offset)
+            return Fail();
+
+        memcpy(destination, m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+    bool Fail() { m_failed = true; return false; }
+
+    const uint8_t*                                      m_data;
+    bool                                                m_failed;
+    const std::vector<std::shared_ptr<GameObject>>*     m_objects;
+    size_t                                              m_offset;
+    size_t                                              m_size;
+};
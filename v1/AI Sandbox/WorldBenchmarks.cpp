@@ -0,0 +1,230 @@
+#include "pch.h"
+#include "FollowBehavior.h"
+#include "HeadlessRunner.h"
+#include "RandomHelper.h"
+#include "RenderSnapshot.h"
+#include "WorldBenchmarks.h"
+
+#include <string>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+const uint32_t Seed = 12345;
+const size_t ChurnAgentCount = 1000;
+const size_t ChurnTeamSize = 10000; // players already in the team the churned agents join
+const size_t FollowAgentCount = 10000;
+const size_t GetPlayerTeamSize = 10000;
+const size_t ModulesPerObject = 8;
+
+// Followers of one player, on team 1, spread uniformly over a disk at the world center.
+std::unique_ptr<World> CreateFollowWorld(size_t agentCount, std::vector<std::shared_ptr<GameObject>>* agents)
+{
+    auto world = std::make_unique<World>();
+    world->CreateTeam();
+    world->CreateTeam();
+
+    auto center = world->GetWorldBoundary() / 2.f;
+    auto player = std::make_shared<GameObject>(center, nullptr, *world->GetArchetypes());
+    world->AddPlayer(player, 0);
+
+    std::mt19937 random(Seed);
+    std::uniform_real_distribution<float> unitDistribution(0.f, 1.f);
+    auto spawnRadius = std::sqrt(float(agentCount)) * 8.f;
+    for (size_t i = 0; i < agentCount; ++i)
+    {
+        auto angle = unitDistribution(random) * XM_2PI;
+        auto distance = std::sqrt(unitDistribution(random)) * spawnRadius;
+        auto agent = std::make_shared<GameObject>(center + Vector2(std::cos(angle), std::sin(angle)) * distance, nullptr, *world->GetArchetypes());
+        agent->AddBehaviorModule(std::make_shared<FollowBehavior>(player));
+        world->AddPlayer(agent, 1);
+        if (agents)
+        {
+            agents->push_back(agent);
+        }
+    }
+
+    return world;
+}
+}
+
+std::vector<Benchmark::Result> RunWorldBenchmarks(size_t maxAgents)
+{
+    std::vector<Benchmark::Result> results;
+    Helper::RandomInit(Seed);
+
+    // Whole updates of the standard headless scenario, with the player moving so chunks wake and sleep.
+    for (size_t agentCount = 1000; agentCount <= maxAgents; agentCount *= 10)
+    {
+        HeadlessRunOptions options;
+        options.agentCount = agentCount;
+        options.playerSpeed = 50.f;
+        options.seed = Seed;
+        options.spawnRadius = std::sqrt(float(agentCount)) * 8.f;
+
+        HeadlessRunner runner(options);
+        auto name = "World::Update/" + std::to_string(agentCount) + " agents";
+        results.push_back(Benchmark::Measure(name.c_str(), agentCount, [&] { runner.Step(); }));
+    }
+
+    // GetPlayer walks the team's list up to the index.
+    {
+        auto world = CreateFollowWorld(GetPlayerTeamSize, nullptr);
+        for (size_t index : { size_t(0), size_t(100), size_t(1000), GetPlayerTeamSize - 1 })
+        {
+            auto name = "World::GetPlayer/index " + std::to_string(index);
+            results.push_back(Benchmark::Measure(name.c_str(), 1, [&] { world->GetPlayer(1, index); }));
+        }
+    }
+
+    // Churn: agents join a populated team, then leave one by one (in a fixed shuffled order) or all at once.
+    {
+        auto world = CreateFollowWorld(ChurnTeamSize, nullptr);
+        world->CreateTeam();
+        for (size_t i = 0; i < ChurnTeamSize; ++i)
+        {
+            world->AddPlayer(std::make_shared<GameObject>(Vector2(100.f, 100.f), nullptr, *world->GetArchetypes()), 2);
+        }
+
+        std::vector<std::shared_ptr<GameObject>> churnAgents;
+        for (size_t i = 0; i < ChurnAgentCount; ++i)
+        {
+            churnAgents.push_back(std::make_shared<GameObject>(Vector2(200.f + float(i), 200.f), nullptr, *world->GetArchetypes()));
+        }
+        auto removeOrder = churnAgents;
+        std::shuffle(removeOrder.begin(), removeOrder.end(), std::mt19937(Seed));
+
+        results.push_back(Benchmark::Measure("World::AddPlayer+RemovePlayer/1000 agents", ChurnAgentCount, [&]
+        {
+            for (const auto& agent : churnAgents)
+            {
+                world->AddPlayer(agent, 2);
+            }
+            for (const auto& agent : removeOrder)
+            {
+                world->RemovePlayer(agent);
+            }
+            world->GetEventBus()->Clear(); // as delivery would, so despawn events do not pile up
+        }));
+
+        world->CreateTeam();
+        results.push_back(Benchmark::Measure("World::AddPlayer+RemoveAllPlayers/1000 agents", ChurnAgentCount, [&]
+        {
+            for (const auto& agent : churnAgents)
+            {
+                world->AddPlayer(agent, 3);
+            }
+            world->RemoveAllPlayers(3);
+            world->GetEventBus()->Clear();
+        }));
+    }
+
+    // Steering alone, without integration (forces accumulate, which does not change the cost).
+    {
+        std::vector<std::shared_ptr<GameObject>> agents;
+        auto world = CreateFollowWorld(FollowAgentCount, &agents);
+        world->Update(1.f / 60.f); // subscribe to events on the first Run
+
+        std::vector<std::pair<BehaviorModule*, GameObject*>> modules;
+        for (const auto& agent : agents)
+        {
+            modules.emplace_back(agent->GetBehaviorModules().begin()->second.get(), agent.get());
+        }
+
+        auto name = "FollowBehavior::Run/" + std::to_string(FollowAgentCount) + " agents";
+        results.push_back(Benchmark::Measure(name.c_str(), FollowAgentCount, [&]
+        {
+            for (const auto& module : modules)
+            {
+                module.first->Run(world.get(), module.second, 1.f / 60.f);
+            }
+        }));
+
+        agents.clear(); // before the world: their modules unsubscribe from its event bus
+    }
+
+    // Debug geometry of every active agent, over the whole world and culled to a screen-sized view.
+    {
+        auto world = CreateFollowWorld(FollowAgentCount, nullptr);
+        world->Update(1.f / 60.f);
+
+        DebugGeometry debugGeometry;
+        auto name = "World::RenderDebugInfo/" + std::to_string(FollowAgentCount) + " agents";
+        results.push_back(Benchmark::Measure(name.c_str(), FollowAgentCount, [&]
+        {
+            debugGeometry.Clear();
+            world->RenderDebugInfo(&debugGeometry);
+        }));
+
+        auto viewSize = Vector2(1920.f, 1080.f);
+        debugGeometry.SetCullBounds(world->GetWorldBoundary() / 2.f - viewSize / 2.f, world->GetWorldBoundary() / 2.f + viewSize / 2.f);
+        auto visibleCount = world->GetVisiblePlayers(debugGeometry.GetCullMin(), debugGeometry.GetCullMax()).size(); // the agents each call records
+        name = "World::RenderDebugInfo/" + std::to_string(FollowAgentCount) + " agents, culled";
+        results.push_back(Benchmark::Measure(name.c_str(), visibleCount, [&]
+        {
+            debugGeometry.Clear();
+            world->RenderDebugInfo(&debugGeometry);
+        }));
+    }
+
+    // The sprite stream of idle agents spread over the whole world, all under the view so every one is drawn.
+    {
+        World world;
+        world.CreateTeam();
+        world.CreateTeam();
+        world.SetView(Vector2::Zero, world.GetWorldBoundary());
+
+        std::mt19937 random(Seed);
+        std::uniform_real_distribution<float> unitDistribution(0.f, 1.f);
+        for (size_t i = 0; i < maxAgents; ++i)
+        {
+            auto position = Vector2(unitDistribution(random), unitDistribution(random)) * world.GetWorldBoundary();
+            world.AddPlayer(std::make_shared<GameObject>(position, nullptr, *world.GetArchetypes()), 1);
+        }
+        world.Update(1.f / 60.f); // activate the chunks
+
+        RenderSnapshot snapshot;
+        auto name = "World::Render/" + std::to_string(maxAgents) + " sprites";
+        results.push_back(Benchmark::Measure(name.c_str(), maxAgents, [&]
+        {
+            snapshot.Clear();
+            world.Render(&snapshot);
+        }));
+
+        // Then through a screen-sized view at the center, with the whole world still active.
+        auto viewSize = Vector2(1920.f, 1080.f);
+        world.SetView(world.GetWorldBoundary() / 2.f - viewSize / 2.f, viewSize);
+        auto visibleCount = world.GetVisiblePlayers(world.GetViewOrigin(), world.GetViewOrigin() + viewSize).size(); // the sprites each call writes
+        name = "World::Render/" + std::to_string(maxAgents) + " sprites, culled";
+        results.push_back(Benchmark::Measure(name.c_str(), visibleCount, [&]
+        {
+            snapshot.Clear();
+            world.Render(&snapshot);
+        }));
+    }
+
+    // Inserting modules at mixed priorities, then clearing them for the next call.
+    {
+        World world;
+        GameObject object(Vector2::Zero, nullptr, *world.GetArchetypes());
+        std::vector<std::shared_ptr<BehaviorModule>> modules;
+        for (size_t i = 0; i < ModulesPerObject; ++i)
+        {
+            modules.push_back(std::make_shared<FollowBehavior>());
+        }
+
+        auto name = "GameObject::AddBehaviorModule/" + std::to_string(ModulesPerObject) + " modules";
+        results.push_back(Benchmark::Measure(name.c_str(), ModulesPerObject, [&]
+        {
+            for (size_t i = 0; i < ModulesPerObject; ++i)
+            {
+                object.AddBehaviorModule(modules[i], char(i % 3));
+            }
+            object.RemoveAllBehaviorModules();
+        }));
+    }
+
+    return results;
+}
@@ -0,0 +1,15 @@
+//
+// WorldBenchmarks.h - microbenchmarks of the World and behavior hot paths
+//
+
+#pragma once
+
+#include <vector>
+
+#include "Benchmark.h"
+
+// Time World::Update at populations from 1k agents up to maxAgents (by factors of 10), World::GetPlayer at
+// several indices, adding and removing players under churn, FollowBehavior::Run and
+// GameObject::AddBehaviorModule. Worlds are built from fixed seeds, so runs are comparable release over
+// release (see Benchmark::WriteJson).
+std::vector<Benchmark::Result> RunWorldBenchmarks(size_t maxAgents = 1000000);